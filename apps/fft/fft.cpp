@@ -547,6 +547,15 @@ ComplexFunc fft2d_c2c(ComplexFunc x,
 
     dft1T.compute_at(dft, outer);
 
+    // Keep the real and imaginary parts of the intermediates together.
+    if (desc.interleave_complex) {
+        for (ComplexFunc f : {xT, x_tiled, dft1T, dft1_tiled}) {
+            if (f.defined()) {
+                f.store_tuple_interleaved();
+            }
+        }
+    }
+
     dft.bound(dft.args()[0], 0, N0);
     dft.bound(dft.args()[1], 0, N1);
 
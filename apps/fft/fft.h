@@ -34,6 +34,11 @@ struct Fft2dDesc {
     // that makes sense.
     bool schedule_input = false;
 
+    // This option stores the real and imaginary parts of the intermediate
+    // complex Funcs of a c2c FFT interleaved in one allocation, rather than
+    // in two separate allocations.
+    bool interleave_complex = false;
+
     // A name to prepend to the name of the Funcs the FFT defines.
     std::string name = "";
 };
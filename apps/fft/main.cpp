@@ -180,6 +180,24 @@ int main(int argc, char **argv) {
            5 * W * H * (log2(W) + log2(H)) / fftw_t,
            fftw_t / halide_t);
 
+    // The same, but with the real and imaginary parts of the
+    // intermediates stored interleaved.
+    Fft2dDesc interleaved_desc = fwd_desc;
+    interleaved_desc.interleave_complex = true;
+    Func bench_c2c_interleaved = fft2d_c2c(c2c_in, W, H, -1, target, interleaved_desc);
+    Realization R_c2c_interleaved = bench_c2c_interleaved.realize(W, H, reps, target);
+    R_c2c_interleaved[0].raw_buffer()->dim[2].stride = 0;
+    R_c2c_interleaved[1].raw_buffer()->dim[2].stride = 0;
+
+    halide_t = benchmark(samples, 1, [&]() { bench_c2c_interleaved.realize(R_c2c_interleaved); }) * 1e6 / reps;
+    printf("%12s %10.3f %10.2f %10.3f %10.2f %10.3g\n",
+           "c2c (AoS)",
+           halide_t,
+           5 * W * H * (log2(W) + log2(H)) / halide_t,
+           fftw_t,
+           5 * W * H * (log2(W) + log2(H)) / fftw_t,
+           fftw_t / halide_t);
+
     Func r2c_in;
     // All reps read from the same input. See notes on c2c_in.
     r2c_in(x, y, rep) = re_in(x, y);
@@ -0,0 +1,31 @@
+# Toolchain for cross-compiling to Linux-riscv64 on a Linux-x86-64 host.
+# Tests run under QEMU user-mode emulation. The emulated core has the
+# vector extension, with a VLEN given by HALIDE_RISCV_VLEN (default 128),
+# so that tests can run code compiled for e.g. riscv-64-linux-rvv.
+
+set(CMAKE_SYSTEM_NAME Linux)
+set(CMAKE_SYSTEM_PROCESSOR riscv64)
+
+if (NOT DEFINED CMAKE_C_COMPILER)
+    set(CMAKE_C_COMPILER riscv64-linux-gnu-gcc)
+endif ()
+if (NOT DEFINED CMAKE_CXX_COMPILER)
+    set(CMAKE_CXX_COMPILER riscv64-linux-gnu-g++)
+endif ()
+
+if (NOT DEFINED HALIDE_RISCV_VLEN)
+    set(HALIDE_RISCV_VLEN 128)
+endif ()
+
+if (NOT DEFINED CMAKE_CROSSCOMPILING_EMULATOR)
+    find_program(QEMU_RISCV64 qemu-riscv64)
+    if (QEMU_RISCV64)
+        set(CMAKE_CROSSCOMPILING_EMULATOR
+            ${QEMU_RISCV64} -cpu rv64,v=true,vlen=${HALIDE_RISCV_VLEN},vext_spec=v1.0 -L /usr/riscv64-linux-gnu)
+    endif ()
+endif ()
+
+set(CMAKE_FIND_ROOT_PATH_MODE_PROGRAM NEVER)
+set(CMAKE_FIND_ROOT_PATH_MODE_LIBRARY ONLY)
+set(CMAKE_FIND_ROOT_PATH_MODE_INCLUDE ONLY)
+set(CMAKE_FIND_ROOT_PATH_MODE_PACKAGE ONLY)
@@ -148,6 +148,13 @@ void define_enums(py::module &m) {
         .value("SVE2", Target::Feature::SVE2)
         .value("ARMDotProd", Target::Feature::ARMDotProd)
         .value("LLVMLargeCodeModel", Target::Feature::LLVMLargeCodeModel)
+        .value("AlignAllocations", Target::Feature::AlignAllocations)
+        .value("Cancellable", Target::Feature::Cancellable)
+        .value("AutoComputeWith", Target::Feature::AutoComputeWith)
+        .value("SpecializeStrides", Target::Feature::SpecializeStrides)
+        .value("ScratchBytesQuery", Target::Feature::ScratchBytesQuery)
+        .value("RVV", Target::Feature::RVV)
+        .value("WasmRelaxedSimd", Target::Feature::WasmRelaxedSimd)
         .value("FeatureEnd", Target::Feature::FeatureEnd);
 
     py::enum_<halide_type_code_t>(m, "TypeCode")
@@ -197,11 +197,14 @@ void define_func(py::module &m) {
 
             .def("async_", &Func::async)
             .def("memoize", &Func::memoize)
+            .def("compute_at_compile_time", &Func::compute_at_compile_time)
             .def("compute_inline", &Func::compute_inline)
             .def("compute_root", &Func::compute_root)
             .def("store_root", &Func::store_root)
 
             .def("store_in", &Func::store_in, py::arg("memory_type"))
+            .def("store_tuple_interleaved", &Func::store_tuple_interleaved)
+            .def("aliases", &Func::aliases, py::arg("input"))
 
             .def("compile_to", &Func::compile_to, py::arg("outputs"), py::arg("arguments"), py::arg("fn_name"), py::arg("target") = get_target_from_environment())
 
@@ -260,6 +263,8 @@ void define_func(py::module &m) {
 
             .def("is_extern", &Func::is_extern)
             .def("extern_function_name", &Func::extern_function_name)
+            .def("extern_footprint", &Func::extern_footprint, py::arg("sites"))
+            .def("vector_extern", &Func::vector_extern, py::arg("scalar_name"), py::arg("vector_name"), py::arg("lanes"), py::arg("arch") = Target::ArchUnknown, py::arg("features") = std::vector<Target::Feature>{})
 
             .def("define_extern", (void (Func::*)(const std::string &, const std::vector<ExternFuncArgument> &, const std::vector<Type> &, const std::vector<Var> &, NameMangling, DeviceAPI)) & Func::define_extern, py::arg("function_name"), py::arg("params"), py::arg("types"), py::arg("arguments"), py::arg("mangling") = NameMangling::Default, py::arg("device_api") = DeviceAPI::Host)
 
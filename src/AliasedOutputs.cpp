@@ -0,0 +1,333 @@
+#include "AliasedOutputs.h"
+#include "FindCalls.h"
+#include "Func.h"
+#include "Function.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "IRVisitor.h"
+#include "Substitute.h"
+
+#include <set>
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace {
+
+// Find the coordinates at which some code reads an input buffer,
+// looking through any inlined Funcs it calls.
+class FindReads : public IRVisitor {
+    using IRVisitor::visit;
+
+    const string &input;
+    const map<string, Function> &env;
+
+    void visit(const Call *op) override {
+        IRVisitor::visit(op);
+        if (op->call_type == Call::Image && op->name == input) {
+            reads.push_back(op->args);
+        } else if (op->call_type == Call::Halide) {
+            auto it = env.find(op->name);
+            if (it != env.end() &&
+                it->second.schedule().compute_level().is_inlined() &&
+                it->second.updates().empty() &&
+                !it->second.has_extern_definition()) {
+                const Function &f = it->second;
+                map<string, Expr> replacements;
+                for (size_t i = 0; i < f.args().size(); i++) {
+                    replacements[f.args()[i]] = op->args[i];
+                }
+                substitute(replacements, f.values()[op->value_index]).accept(this);
+            }
+        }
+    }
+
+public:
+    vector<vector<Expr>> reads;
+
+    FindReads(const string &i, const map<string, Function> &e)
+        : input(i), env(e) {
+    }
+};
+
+// Whether an extern stage is passed the input buffer itself.
+bool extern_reads_input(const Function &f, const string &input) {
+    if (f.has_extern_definition()) {
+        for (const ExternFuncArgument &arg : f.extern_arguments()) {
+            if (arg.is_image_param() && arg.image_param.name() == input) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool reads_input(const Function &f, const string &input, const map<string, Function> &env) {
+    if (extern_reads_input(f, input)) {
+        return true;
+    }
+    FindReads finder(input, env);
+    f.accept(&finder);
+    return !finder.reads.empty();
+}
+
+// Find the root-level Funcs in whose loop nests a Func is computed,
+// and whether any Func on the way there is async.
+void find_roots(const Function &f, const map<string, Function> &env,
+                set<string> &roots, bool &async) {
+    async = async || f.schedule().async();
+    const LoopLevel &level = f.schedule().compute_level();
+    if (level.is_root()) {
+        roots.insert(f.name());
+    } else if (!level.is_inlined()) {
+        find_roots(env.at(level.func()), env, roots, async);
+    } else {
+        // A Func with update definitions that isn't scheduled is
+        // computed innermost in each of its callers.
+        for (const auto &it : env) {
+            if (find_direct_calls(it.second).count(f.name())) {
+                find_roots(it.second, env, roots, async);
+            }
+        }
+    }
+}
+
+// Why a Func that reads the input might still be reading it after
+// the output has started overwriting it, or the empty string if it
+// can't be.
+string late_reader_blocker(const Function &f, const Function &out,
+                           const map<string, Function> &producers,
+                           const map<string, Function> &env) {
+    set<string> roots;
+    bool async = false;
+    find_roots(f, env, roots, async);
+    if (async) {
+        return "Func " + f.name() + " reads the input asynchronously";
+    }
+    for (const string &root : roots) {
+        if (root == out.name()) {
+            return "Func " + f.name() + " reads the input inside its loop nest";
+        } else if (!producers.count(root)) {
+            return "Func " + f.name() + " reads the input, but is not computed before it";
+        }
+    }
+    return "";
+}
+
+// Why the output can't be computed in place over the input, or the
+// empty string if it can.
+string in_place_blocker(const Function &out, const string &input,
+                        const map<string, Function> &env) {
+    if (out.has_extern_definition()) {
+        return "it is an extern stage";
+    }
+    if (!out.updates().empty()) {
+        return "it has update definitions";
+    }
+    const Definition &def = out.definition();
+    if (!def.specializations().empty()) {
+        return "it has specializations";
+    }
+    if (!def.schedule().fuse_level().level.is_inlined()) {
+        return "it is computed with another Func";
+    }
+    for (const Split &s : def.schedule().splits()) {
+        if (s.tail == TailStrategy::ShiftInwards) {
+            return "it uses the ShiftInwards tail strategy";
+        }
+    }
+    for (const Dim &d : def.schedule().dims()) {
+        if (d.device_api != DeviceAPI::None &&
+            d.device_api != DeviceAPI::Host) {
+            return "it runs on a device";
+        }
+    }
+
+    // The output's own reads must be of the point it is writing.
+    FindReads finder(input, env);
+    for (const Expr &v : out.values()) {
+        v.accept(&finder);
+    }
+    for (const vector<Expr> &args : finder.reads) {
+        for (size_t i = 0; i < args.size(); i++) {
+            const Variable *var = args[i].as<Variable>();
+            if (!var || var->name != out.args()[i]) {
+                return "it reads the input at other points than the one it is writing";
+            }
+        }
+    }
+
+    // Everything else that reads the input must be done with it
+    // before the output starts.
+    map<string, Function> producers = find_transitive_calls(out);
+    for (const auto &it : env) {
+        const Function &f = it.second;
+        // Pure inlined Funcs are accounted for in their callers.
+        if (f.same_as(out) ||
+            (f.schedule().compute_level().is_inlined() && f.updates().empty()) ||
+            !reads_input(f, input, env)) {
+            continue;
+        }
+        string blocker = late_reader_blocker(f, out, producers, env);
+        if (!blocker.empty()) {
+            return blocker;
+        }
+    }
+    return "";
+}
+
+// The range of bytes of host memory a buffer spans, from begin up to
+// but not including end, and whether it spans any at all.
+void host_byte_range(const Parameter &p, Expr &begin, Expr &end, Expr &nonempty) {
+    Expr host = reinterpret(Int(64), Variable::make(type_of<void *>(), p.name(), p));
+    Expr lo = make_zero(Int(64)), hi = make_zero(Int(64));
+    nonempty = const_true();
+    for (int i = 0; i < p.dimensions(); i++) {
+        string dim = std::to_string(i);
+        Expr extent = Variable::make(Int(32), p.name() + ".extent." + dim, p);
+        Expr stride = Variable::make(Int(32), p.name() + ".stride." + dim, p);
+        Expr last = cast<int64_t>(stride) * (extent - 1);
+        lo += min(last, 0);
+        hi += max(last, 0);
+        nonempty = nonempty && extent > 0;
+    }
+    begin = host + lo * p.type().bytes();
+    end = host + (hi + 1) * p.type().bytes();
+}
+
+class RedirectReads : public IRMutator {
+    using IRMutator::visit;
+
+    const string &input;
+    const Function &staged;
+
+    Expr visit(const Call *op) override {
+        if (op->call_type == Call::Image && op->name == input) {
+            vector<Expr> args;
+            for (const Expr &a : op->args) {
+                args.push_back(mutate(a));
+            }
+            return Call::make(staged, args, 0);
+        }
+        return IRMutator::visit(op);
+    }
+
+public:
+    RedirectReads(const string &i, const Function &s)
+        : input(i), staged(s) {
+    }
+};
+
+}  // namespace
+
+void prepare_aliased_outputs(const vector<Function> &outputs,
+                             map<string, Function> &env,
+                             const Target &t) {
+    for (const auto &it : env) {
+        const Parameter &input = it.second.schedule().aliased_input();
+        bool is_output = false;
+        for (const Function &out : outputs) {
+            is_output = is_output || out.same_as(it.second);
+        }
+        user_assert(!input.defined() || is_output)
+            << "Func " << it.first << " aliases input " << input.name()
+            << ", but is not an output of the pipeline.\n";
+    }
+
+    for (Function out : outputs) {
+        Parameter input = out.schedule().aliased_input();
+        if (!input.defined()) {
+            continue;
+        }
+
+        string blocker = in_place_blocker(out, input.name(), env);
+        if (blocker.empty()) {
+            debug(2) << "Computing " << out.name() << " in place over " << input.name() << "\n";
+            for (Split &s : out.definition().schedule().splits()) {
+                if (s.tail == TailStrategy::Auto) {
+                    s.tail = TailStrategy::GuardWithIf;
+                }
+            }
+            continue;
+        }
+
+        // Reads in Halide code can be redirected to a copy of the
+        // input, but an extern stage is passed the input buffer
+        // itself, so it must be done with it before the output starts.
+        map<string, Function> producers = find_transitive_calls(out);
+        for (const auto &it : env) {
+            if (extern_reads_input(it.second, input.name())) {
+                string extern_blocker = late_reader_blocker(it.second, out, producers, env);
+                user_assert(extern_blocker.empty())
+                    << "Output " << out.name() << " can't alias input " << input.name()
+                    << " because " << blocker << ", and extern stage " << it.first
+                    << " can't be given a copy of the input instead (" << extern_blocker << ").\n";
+            }
+        }
+
+        user_warning << "Output " << out.name() << " can't be computed in place over input "
+                     << input.name() << " because " << blocker
+                     << ". Making a copy of the input first.\n";
+
+        vector<Var> vars(input.dimensions());
+        vector<Expr> args(vars.begin(), vars.end());
+        Func staged(input.name() + "_staged");
+        staged(vars) = Call::make(input.type(), input.name(), args, Call::Image,
+                                  FunctionPtr(), 0, Buffer<>(), input);
+        staged.compute_root();
+        if (!vars.empty()) {
+            staged.vectorize(vars[0], t.natural_vector_size(input.type()), TailStrategy::GuardWithIf);
+        }
+        Function f = staged.function();
+        f.lock_loop_levels();
+
+        RedirectReads redirect(input.name(), f);
+        for (auto &it : env) {
+            it.second.mutate(&redirect);
+        }
+        env[f.name()] = f;
+        out.schedule().aliased_input() = Parameter();
+    }
+}
+
+Stmt add_aliased_output_checks(const Stmt &s, const vector<Function> &outputs) {
+    Stmt result = s;
+    for (const Function &out : outputs) {
+        const Parameter &input = out.schedule().aliased_input();
+        if (!input.defined()) {
+            continue;
+        }
+        for (const Parameter &output : out.output_buffers()) {
+            // Any overlap at all between the two buffers' memory means
+            // they must be exactly the same buffer, so that each
+            // element is only overwritten by its own result.
+            Expr in_begin, in_end, in_nonempty, out_begin, out_end, out_nonempty;
+            host_byte_range(input, in_begin, in_end, in_nonempty);
+            host_byte_range(output, out_begin, out_end, out_nonempty);
+            Expr overlap = (in_nonempty && out_nonempty &&
+                            out_begin < in_end && in_begin < out_end);
+            Expr same_layout = (reinterpret(UInt(64), Variable::make(type_of<void *>(), output.name(), output)) ==
+                                reinterpret(UInt(64), Variable::make(type_of<void *>(), input.name(), input)));
+            for (int i = 0; i < input.dimensions(); i++) {
+                string dim = std::to_string(i);
+                for (const char *field : {".min.", ".stride."}) {
+                    same_layout = same_layout &&
+                                  (Variable::make(Int(32), output.name() + field + dim, output) ==
+                                   Variable::make(Int(32), input.name() + field + dim, input));
+                }
+            }
+            Expr error = Call::make(Int(32), "halide_error_aliased_buffer_mismatch",
+                                    {output.name(), input.name()}, Call::Extern);
+            result = Block::make(AssertStmt::make(!overlap || same_layout, error), result);
+        }
+    }
+    return result;
+}
+
+}  // namespace Internal
+}  // namespace Halide
@@ -0,0 +1,43 @@
+#ifndef HALIDE_ALIASED_OUTPUTS_H
+#define HALIDE_ALIASED_OUTPUTS_H
+
+/** \file
+ * Defines the lowering passes that let outputs be computed in place
+ * over the inputs they alias.
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Expr.h"
+#include "Target.h"
+
+namespace Halide {
+namespace Internal {
+
+class Function;
+
+/** For each output that aliases an input (see Func::aliases), check
+ * that every read of the input happens before the output overwrites
+ * it: either in a compute_root producer of the output, or in the
+ * output's own definition at the point being written. If so, replace
+ * the output's Auto tail strategies with GuardWithIf, so no point is
+ * recomputed after it has been written. If not, make all the reads go
+ * through a compute_root copy of the input instead, and warn. Extern
+ * stages are passed the input itself, so if one of them would still
+ * be reading it after the output starts, that's an error. Must be
+ * called before the realization order is computed. */
+void prepare_aliased_outputs(const std::vector<Function> &outputs,
+                             std::map<std::string, Function> &env,
+                             const Target &t);
+
+/** Inject a runtime check that each output being computed in place
+ * either doesn't overlap the input it aliases in memory at all, or
+ * has the same host pointer, mins and strides. */
+Stmt add_aliased_output_checks(const Stmt &s, const std::vector<Function> &outputs);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
@@ -0,0 +1,235 @@
+#include "AutoComputeWith.h"
+#include "FindCalls.h"
+#include "Func.h"
+#include "Function.h"
+#include "IREquality.h"
+#include "IRVisitor.h"
+
+#include <set>
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace {
+
+// The innermost loops of Funcs fused together are only shared if the
+// fused body has at most this many loads, as a proxy for how many
+// values it keeps live at once.
+const int max_loads_in_fused_body = 16;
+
+// Find the inputs a Func reads from memory (realized Funcs, images,
+// and buffers), looking through any inlined Funcs it calls, and count
+// how many loads of them it does.
+class FindInputs : public IRVisitor {
+    using IRVisitor::visit;
+
+    const map<string, Function> &env;
+
+    void visit(const Call *op) override {
+        IRVisitor::visit(op);
+        if (op->call_type == Call::Image) {
+            inputs.insert(op->name);
+            loads++;
+        } else if (op->call_type == Call::Halide) {
+            auto it = env.find(op->name);
+            if (it != env.end() &&
+                it->second.schedule().compute_level().is_inlined() &&
+                !it->second.has_extern_definition()) {
+                // Only pure Funcs can be inlined.
+                for (const Expr &e : it->second.values()) {
+                    e.accept(this);
+                }
+            } else {
+                inputs.insert(op->name);
+                loads++;
+            }
+        }
+    }
+
+public:
+    set<string> inputs;
+    int loads = 0;
+
+    FindInputs(const map<string, Function> &e)
+        : env(e) {
+    }
+};
+
+bool same_splits(const vector<Split> &a, const vector<Split> &b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].old_var != b[i].old_var ||
+            a[i].outer != b[i].outer ||
+            a[i].inner != b[i].inner ||
+            !graph_equal(a[i].factor, b[i].factor) ||
+            a[i].exact != b[i].exact ||
+            a[i].tail != b[i].tail ||
+            a[i].split_type != b[i].split_type) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool same_dims(const vector<Dim> &a, const vector<Dim> &b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].var != b[i].var ||
+            a[i].for_type != b[i].for_type ||
+            a[i].device_api != b[i].device_api ||
+            a[i].dim_type != b[i].dim_type ||
+            a[i].grain_size != b[i].grain_size) {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct Candidate {
+    Function func;
+    FindInputs inputs;
+    // Everything this Func depends on, directly or not.
+    map<string, Function> calls;
+};
+
+// A group of Funcs to be fused, and everything they read.
+struct Group {
+    vector<const Candidate *> members;
+    set<string> inputs;
+    int loads = 0;
+};
+
+// Whether a Func could take part in automatic fusion at all.
+bool is_candidate(const Function &f, const set<string> &already_fused) {
+    if (f.has_extern_definition() ||
+        !f.updates().empty() ||
+        !f.definition().specializations().empty() ||
+        f.schedule().compute_level().is_inlined() ||
+        !(f.schedule().store_level() == f.schedule().compute_level()) ||
+        f.schedule().memoized() ||
+        f.schedule().async() ||
+        already_fused.count(f.name())) {
+        return false;
+    }
+    for (const Dim &d : f.definition().schedule().dims()) {
+        if (d.device_api != DeviceAPI::None &&
+            d.device_api != DeviceAPI::Host) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Whether two candidates can share a loop nest.
+bool compatible(const Candidate &a, const Candidate &b) {
+    const Function &f = a.func;
+    const Function &g = b.func;
+    return (f.args() == g.args() &&
+            f.schedule().compute_level() == g.schedule().compute_level() &&
+            same_dims(f.definition().schedule().dims(), g.definition().schedule().dims()) &&
+            same_splits(f.definition().schedule().splits(), g.definition().schedule().splits()) &&
+            !a.calls.count(g.name()) &&
+            !b.calls.count(f.name()));
+}
+
+}  // namespace
+
+void auto_compute_with(map<string, Function> &env, const Target &t) {
+    if (!t.has_feature(Target::AutoComputeWith)) {
+        return;
+    }
+
+    // Leave alone anything the schedule already fuses.
+    set<string> already_fused;
+    for (const auto &it : env) {
+        const Function &f = it.second;
+        vector<const Definition *> defs = {&f.definition()};
+        for (const Definition &u : f.updates()) {
+            defs.push_back(&u);
+        }
+        for (const Definition *d : defs) {
+            const LoopLevel &level = d->schedule().fuse_level().level;
+            if (!level.is_inlined() && !level.is_root()) {
+                already_fused.insert(f.name());
+                already_fused.insert(level.func());
+            }
+        }
+    }
+
+    vector<Candidate> candidates;
+    candidates.reserve(env.size());
+    for (const auto &it : env) {
+        if (is_candidate(it.second, already_fused)) {
+            candidates.push_back({it.second, FindInputs(env), find_transitive_calls(it.second)});
+            for (const Expr &e : it.second.values()) {
+                e.accept(&candidates.back().inputs);
+            }
+        }
+    }
+
+    // Greedily gather candidates into groups that share an input.
+    vector<Group> groups;
+    for (const Candidate &c : candidates) {
+        Group *group = nullptr;
+        for (Group &g : groups) {
+            bool shares_input = false;
+            for (const string &in : c.inputs.inputs) {
+                shares_input = shares_input || g.inputs.count(in);
+            }
+            bool fits = shares_input;
+            for (const Candidate *m : g.members) {
+                fits = fits && compatible(*m, c);
+            }
+            if (fits) {
+                group = &g;
+                break;
+            }
+        }
+        if (!group) {
+            groups.emplace_back();
+            group = &groups.back();
+        }
+        group->members.push_back(&c);
+        group->inputs.insert(c.inputs.inputs.begin(), c.inputs.inputs.end());
+        group->loads += c.inputs.loads;
+    }
+
+    for (const Group &g : groups) {
+        if (g.members.size() < 2) {
+            continue;
+        }
+        const Function &parent = g.members[0]->func;
+        const vector<Dim> &dims = parent.definition().schedule().dims();
+        // The last dim is the __outermost placeholder.
+        internal_assert(!dims.empty());
+        if (dims.size() < 2) {
+            // Zero-dimensional Funcs have no loops to fuse.
+            continue;
+        }
+        size_t level = 0;
+        if (g.loads > max_loads_in_fused_body && dims.size() > 2) {
+            level = 1;
+        }
+        const string &var = dims[level].var;
+
+        for (size_t i = 1; i < g.members.size(); i++) {
+            Function f = g.members[i]->func;
+            debug(2) << "Computing " << f.name() << " with " << parent.name()
+                     << " at " << var << "\n";
+            LoopLevel fuse_at(parent, Var(var), 0);
+            f.definition().schedule().fuse_level() = FuseLoopLevel(fuse_at.lock(), {});
+        }
+    }
+}
+
+}  // namespace Internal
+}  // namespace Halide
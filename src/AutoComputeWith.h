@@ -0,0 +1,35 @@
+#ifndef HALIDE_AUTO_COMPUTE_WITH_H
+#define HALIDE_AUTO_COMPUTE_WITH_H
+
+/** \file
+ * Defines the pass that fuses the loop nests of independent Funcs
+ * that read the same inputs.
+ */
+
+#include <map>
+#include <string>
+
+#include "Target.h"
+
+namespace Halide {
+namespace Internal {
+
+class Function;
+
+/** For Funcs computed at the same loop level that don't depend on
+ * each other but read the same input (e.g. several outputs computed
+ * from one image), schedule all but the first to be computed with the
+ * first, so that the input is streamed through the cache once rather
+ * than once per Func. Only pure Funcs with identical loop nests are
+ * fused. If the fused loop body would contain few loads, the innermost
+ * loops are fused; otherwise the loops one level out are, so that the
+ * bodies stay separate and don't compete for registers, while the
+ * input is still reused from cache. Must be called before the
+ * realization order is computed. Does nothing unless the target has
+ * the AutoComputeWith feature. */
+void auto_compute_with(std::map<std::string, Function> &env, const Target &t);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
@@ -43,7 +43,11 @@ namespace Halide {
  *  recommended for correctness and performance. Some of these are hard
  *  to get right. The versions here are both understood by bounds
  *  inference, and also judiciously use the 'likely' intrinsic to minimize
- *  runtime overhead.
+ *  runtime overhead. Loop partitioning uses those tags to split the loops
+ *  over each dimension into an interior that runs without any clamps or
+ *  selects, and a border. For multi-dimensional boundary conditions the
+ *  border is further split into edges, which only pay for the boundary
+ *  condition in one dimension, and corners.
  *
  */
 namespace BoundaryConditions {
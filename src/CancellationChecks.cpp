@@ -0,0 +1,69 @@
+#include "CancellationChecks.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+
+namespace Halide {
+namespace Internal {
+
+namespace {
+
+class InjectCancellationChecks : public IRMutator {
+    using IRMutator::visit;
+
+    // Whether we have seen a loop since entering the body of the
+    // innermost enclosing loop.
+    bool found_loop = false;
+
+    Stmt check_then(const Stmt &body) {
+        // Codegen recognizes serial loops that start by acquiring
+        // semaphores as tasks, so the check goes after the acquires.
+        if (const Acquire *acquire = body.as<Acquire>()) {
+            return Acquire::make(acquire->semaphore, acquire->count, check_then(acquire->body));
+        }
+        Expr requested = Call::make(Int(32), "halide_cancel_requested", {}, Call::Extern);
+        Expr error = Call::make(Int(32), "halide_error_cancelled", {}, Call::Extern);
+        return Block::make(AssertStmt::make(requested == 0, error), body);
+    }
+
+    Stmt visit(const For *op) override {
+        if (op->device_api != DeviceAPI::None &&
+            op->device_api != DeviceAPI::Host) {
+            // Device code can't call back into the runtime.
+            found_loop = true;
+            return op;
+        }
+
+        found_loop = false;
+        Stmt body = mutate(op->body);
+        const bool is_outer = found_loop;
+        found_loop = true;
+
+        if (is_outer &&
+            (op->for_type == ForType::Serial ||
+             op->for_type == ForType::Parallel)) {
+            body = check_then(body);
+        }
+
+        if (body.same_as(op->body)) {
+            return op;
+        }
+        return For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body, op->grain_size);
+    }
+};
+
+}  // namespace
+
+Stmt inject_cancellation_checks(const Stmt &s, const Target &t) {
+    if (!t.has_feature(Target::Cancellable)) {
+        return s;
+    }
+    if (t.has_feature(Target::NoAsserts)) {
+        user_warning << "Target feature cancellable has no effect with no_asserts, "
+                     << "because cancelled pipelines stop via the assertion failure path.\n";
+        return s;
+    }
+    return InjectCancellationChecks().mutate(s);
+}
+
+}  // namespace Internal
+}  // namespace Halide
@@ -0,0 +1,26 @@
+#ifndef HALIDE_CANCELLATION_CHECKS_H
+#define HALIDE_CANCELLATION_CHECKS_H
+
+/** \file
+ * Defines the lowering pass that lets running pipelines be cancelled.
+ */
+
+#include "Expr.h"
+#include "Target.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Ask halide_cancel_requested whether the pipeline should stop at
+ * the top of every iteration of each serial and parallel host loop
+ * that contains another loop. If it says yes, the pipeline returns
+ * halide_error_code_cancelled via the usual assertion failure path,
+ * which frees any allocations made so far. Innermost loops are not
+ * checked, to keep the cost of checking low. Does nothing unless the
+ * target has the Cancellable feature. */
+Stmt inject_cancellation_checks(const Stmt &s, const Target &t);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
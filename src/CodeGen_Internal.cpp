@@ -187,6 +187,7 @@ llvm::Type *get_vector_type(llvm::Type *t, int n) {
 bool function_takes_user_context(const std::string &name) {
     static const char *user_context_runtime_funcs[] = {
         "halide_buffer_copy",
+        "halide_cancel_requested",
         "halide_copy_to_host",
         "halide_copy_to_device",
         "halide_current_time_ns",
@@ -212,6 +213,8 @@ bool function_takes_user_context(const std::string &name) {
         "halide_profiler_pipeline_start",
         "halide_profiler_pipeline_end",
         "halide_profiler_stack_peak_update",
+        "halide_scratch_alloc",
+        "halide_scratch_pool_create",
         "halide_spawn_thread",
         "halide_device_release",
         "halide_start_clock",
@@ -679,6 +682,12 @@ void get_target_options(const llvm::Module &module, llvm::TargetOptions &options
     options.FloatABIType =
         use_soft_float_abi ? llvm::FloatABI::Soft : llvm::FloatABI::Hard;
     options.RelaxELFRelocations = false;
+
+    // Some targets (e.g. RISC-V) name their ABI explicitly.
+    std::string abi;
+    if (get_md_string(module.getModuleFlag("target-abi"), abi)) {
+        options.MCOptions.ABIName = abi;
+    }
 }
 
 void clone_target_options(const llvm::Module &from, llvm::Module &to) {
@@ -705,6 +714,11 @@ void clone_target_options(const llvm::Module &from, llvm::Module &to) {
     if (get_md_bool(from.getModuleFlag("halide_use_pic"), use_pic)) {
         to.addModuleFlag(llvm::Module::Warning, "halide_use_pic", use_pic ? 1 : 0);
     }
+
+    std::string abi;
+    if (get_md_string(from.getModuleFlag("target-abi"), abi)) {
+        to.addModuleFlag(llvm::Module::Error, "target-abi", llvm::MDString::get(context, abi));
+    }
 }
 
 std::unique_ptr<llvm::TargetMachine> make_target_machine(const llvm::Module &module) {
@@ -742,6 +756,17 @@ void set_function_attributes_for_target(llvm::Function *fn, const Target &t) {
     // Turn off approximate reciprocals for division. It's too
     // inaccurate even for us.
     fn->addFnAttr("reciprocal-estimates", "none");
+
+#if LLVM_VERSION >= 130
+    if (t.arch == Target::RISCV && t.has_feature(Target::RVV)) {
+        // Tell LLVM the minimum VLEN, in units of the 64 bits that
+        // vscale counts, so that it can lower fixed-length vectors to
+        // RVV registers. The code may run on a core with a wider
+        // VLEN, so leave the maximum unbounded (0).
+        const int min_vscale = (t.vector_bits ? t.vector_bits : 128) / 64;
+        fn->addFnAttr(llvm::Attribute::getWithVScaleRangeArgs(fn->getContext(), min_vscale, 0));
+    }
+#endif
 }
 
 void embed_bitcode(llvm::Module *M, const string &halide_command) {
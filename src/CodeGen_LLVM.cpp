@@ -21,6 +21,7 @@
 #include "Deinterleave.h"
 #include "EmulateFloat16Math.h"
 #include "ExprUsesVar.h"
+#include "ExternVectorVariants.h"
 #include "FindIntrinsics.h"
 #include "IREquality.h"
 #include "IROperator.h"
@@ -546,6 +547,7 @@ void CodeGen_LLVM::init_codegen(const std::string &name, bool any_strict_float)
 
 std::unique_ptr<llvm::Module> CodeGen_LLVM::compile(const Module &input) {
     init_codegen(input.name(), input.any_strict_float());
+    vector_externs = input.vector_externs();
 
     internal_assert(module && context && builder)
         << "The CodeGen_LLVM subclass should have made an initial module before calling CodeGen_LLVM::compile\n";
@@ -1849,6 +1851,26 @@ Value *CodeGen_LLVM::codegen_buffer_pointer(Value *base_address, Halide::Type ty
             Value *off = codegen(make_const(Int(8 * d.getPointerSize()), *offset));
             return builder->CreateInBoundsGEP(base, off);
         }
+        // Peel off the 32-bit offset from the hoisted 64-bit base of
+        // an index made by narrow_large_buffer_indices too, so the
+        // offset math in the loop stays 32-bit. Other indices are
+        // left to LLVM as before.
+        const Cast *offset = add->b.as<Cast>();
+        const Variable *large_base = add->a.as<Variable>();
+        if (target.has_feature(Target::LargeBuffers) &&
+            large_base && large_base->type == Int(64) &&
+            offset && offset->type == Int(64) && offset->value.type() == Int(32)) {
+            // The hoisted base includes the negated mins of the
+            // buffer, so the intermediate pointer may be outside the
+            // allocation. An inbounds GEP to it, or from it, would be
+            // poison, so use plain GEPs for both steps.
+            llvm::Type *elem_type = llvm_type_of(upgrade_type_for_storage(type));
+            unsigned address_space = base_address->getType()->getPointerAddressSpace();
+            Value *base = builder->CreatePointerCast(base_address, elem_type->getPointerTo(address_space));
+            base = builder->CreateGEP(elem_type, base, codegen(add->a));
+            Value *off = builder->CreateIntCast(codegen(offset->value), i64_t, true);
+            return builder->CreateGEP(elem_type, base, off);
+        }
     }
 
     return codegen_buffer_pointer(base_address, type, codegen(index));
@@ -3383,6 +3405,27 @@ void CodeGen_LLVM::visit(const Call *op) {
             llvm::Function *vec_fn = vec.first;
             int w = vec.second;
 
+            // Otherwise check for a vector variant declared by the
+            // user with Func::vector_extern.
+            if (!vec_fn && op->call_type == Call::PureExtern) {
+                pair<string, int> variant = find_vector_extern(vector_externs, name, op->type.lanes(), get_target());
+                if (!variant.first.empty()) {
+                    w = variant.second;
+                    vec_fn = module->getFunction(variant.first);
+                    if (!vec_fn) {
+                        vector<llvm::Type *> arg_types(args.size());
+                        for (size_t i = 0; i < args.size(); i++) {
+                            arg_types[i] = get_vector_type(args[i]->getType()->getScalarType(), w);
+                        }
+                        FunctionType *func_t =
+                            FunctionType::get(get_vector_type(result_type->getScalarType(), w), arg_types, false);
+                        vec_fn = llvm::Function::Create(func_t, llvm::Function::ExternalLinkage,
+                                                        variant.first, module.get());
+                        vec_fn->setCallingConv(CallingConv::C);
+                    }
+                }
+            }
+
             if (vec_fn) {
                 value = call_intrin(llvm_type_of(op->type), w,
                                     get_llvm_function_name(vec_fn), args);
@@ -3963,7 +4006,21 @@ void CodeGen_LLVM::get_parallel_tasks(const Stmt &s, vector<ParallelTask> &resul
         result.push_back(t);
     } else if (loop && loop->for_type == ForType::Parallel) {
         add_suffix(prefix, ".par_for." + loop->name);
-        result.push_back(ParallelTask{loop->body, {}, loop->name, loop->min, loop->extent, const_false(), task_debug_name(prefix)});
+        if (loop->grain_size > 1) {
+            // Hand the task system chunks of grain_size iterations,
+            // so that however few iterations it claims at once, they
+            // are never fewer than that.
+            string chunk_name = loop->name + ".grain";
+            Expr chunk = Variable::make(Int(32), chunk_name);
+            Expr grain = loop->grain_size;
+            Expr chunk_min = loop->min + chunk * grain;
+            Expr chunk_extent = Min::make(grain, loop->extent - chunk * grain);
+            Expr num_chunks = (loop->extent + grain - 1) / grain;
+            Stmt body = For::make(loop->name, chunk_min, chunk_extent, ForType::Serial, loop->device_api, loop->body);
+            result.push_back(ParallelTask{body, {}, chunk_name, 0, num_chunks, const_false(), task_debug_name(prefix)});
+        } else {
+            result.push_back(ParallelTask{loop->body, {}, loop->name, loop->min, loop->extent, const_false(), task_debug_name(prefix)});
+        }
     } else if (loop &&
                loop->for_type == ForType::Serial &&
                acquire &&
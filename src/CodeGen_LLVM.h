@@ -548,6 +548,10 @@ private:
     /** Turn off all unsafe math flags in scopes while this is set. */
     bool strict_float;
 
+    /** The vector variants of pure extern functions declared by the
+     * Funcs of the module being compiled. */
+    std::vector<VectorExternVariant> vector_externs;
+
     /** Use the LLVM large code model when this is set. */
     bool llvm_large_code_model;
 
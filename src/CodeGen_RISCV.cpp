@@ -6,6 +6,7 @@ namespace Halide {
 namespace Internal {
 
 using std::string;
+using std::vector;
 
 using namespace llvm;
 
@@ -14,6 +15,46 @@ CodeGen_RISCV::CodeGen_RISCV(const Target &t)
 #if !defined(WITH_RISCV)
     user_error << "llvm build not configured with RISCV target enabled.\n";
 #endif
+#if LLVM_VERSION < 130
+    user_assert(!target.has_feature(Target::RVV))
+        << "RISC-V vector extension support requires LLVM 13 or later.\n";
+#endif
+}
+
+void CodeGen_RISCV::init_module() {
+    CodeGen_Posix::init_module();
+
+    if (target.has_feature(Target::RVV)) {
+        // The V extension needs the "d" extension enabled in mattrs(),
+        // so use the hard-float calling convention that Linux
+        // distributions use with it.
+        string abi = target.bits == 32 ? "ilp32d" : "lp64d";
+        module->addModuleFlag(llvm::Module::Error, "target-abi", MDString::get(*context, abi));
+    }
+}
+
+void CodeGen_RISCV::begin_func(LinkageType linkage, const string &simple_name,
+                               const string &extern_name, const vector<LoweredArgument> &args) {
+    CodeGen_Posix::begin_func(linkage, simple_name, extern_name, args);
+
+    if (linkage == LinkageType::Internal ||
+        !target.has_feature(Target::RVV) ||
+        target.vector_bits <= 128) {
+        return;
+    }
+
+    // LLVM may assume VLEN is at least target.vector_bits, which
+    // halide_can_use_target_features can't check, so check it on entry
+    // by reading VLEN in bytes from the vlenb CSR.
+    llvm::Type *xlen_t = target.bits == 64 ? i64_t : i32_t;
+    FunctionType *read_vlenb_t = FunctionType::get(xlen_t, false);
+    Value *vlenb = builder->CreateCall(read_vlenb_t, InlineAsm::get(read_vlenb_t, "csrr $0, vlenb", "=r", true));
+    Value *wide_enough = builder->CreateICmpUGE(vlenb, ConstantInt::get(xlen_t, target.vector_bits / 8));
+    Expr error = Call::make(Int(32), "halide_error_requirement_failed",
+                            {Expr("VLEN >= " + std::to_string(target.vector_bits)),
+                             Expr("The vector registers of this core are narrower than the vector_bits of the target.")},
+                            Call::Extern);
+    create_assertion(wide_enough, error);
 }
 
 string CodeGen_RISCV::mcpu() const {
@@ -21,7 +62,24 @@ string CodeGen_RISCV::mcpu() const {
 }
 
 string CodeGen_RISCV::mattrs() const {
-    return "";
+    if (!target.has_feature(Target::RVV)) {
+        return "";
+    }
+
+    // The V extension requires the general purpose "G" extensions
+    // (integer multiply/divide, atomics, single and double precision
+    // float). Cores with it also have compressed instructions.
+    string arch_flags = "+m,+a,+f,+d,+c";
+#if LLVM_VERSION >= 140
+    arch_flags += ",+v";
+    // The minimum VLEN. From LLVM 15, this is what lets the backend
+    // put fixed-length vectors in RVV registers. Before that, it only
+    // does so given -riscv-v-vector-bits-min=<VLEN> in HL_LLVM_ARGS.
+    arch_flags += ",+zvl" + std::to_string(native_vector_bits()) + "b";
+#else
+    arch_flags += ",+experimental-v";
+#endif
+    return arch_flags;
 }
 
 bool CodeGen_RISCV::use_soft_float_abi() const {
@@ -29,6 +87,10 @@ bool CodeGen_RISCV::use_soft_float_abi() const {
 }
 
 int CodeGen_RISCV::native_vector_bits() const {
+    if (target.has_feature(Target::RVV) && target.vector_bits != 0) {
+        return target.vector_bits;
+    }
+    // The minimum VLEN required by the V extension.
     return 128;
 }
 
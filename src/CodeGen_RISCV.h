@@ -10,16 +10,26 @@
 namespace Halide {
 namespace Internal {
 
-/** A code generator that emits mips code from a given Halide stmt. */
+/** A code generator that emits RISC-V code from a given Halide stmt. */
 class CodeGen_RISCV : public CodeGen_Posix {
 public:
-    /** Create a mips code generator. Processor features can be
-     * enabled using the appropriate flags in the target struct. */
+    /** Create a RISC-V code generator. Processor features can be
+     * enabled using the appropriate flags in the target struct. The
+     * vector extension is enabled by Target::RVV, and the width of a
+     * vector register (VLEN) is given by Target::vector_bits. Without
+     * RVV, no extensions are enabled and LLVM's default ABI is used.
+     * Vectorized loops use fixed-length vectors of VLEN bits; a tail
+     * guarded with TailStrategy::GuardWithIf becomes one vector
+     * iteration with its out-of-range lanes masked off. */
     CodeGen_RISCV(const Target &);
 
 protected:
     using CodeGen_Posix::visit;
 
+    void init_module() override;
+    void begin_func(LinkageType linkage, const std::string &simple_name,
+                    const std::string &extern_name, const std::vector<LoweredArgument> &args) override;
+
     std::string mcpu() const override;
     std::string mattrs() const override;
     bool use_soft_float_abi() const override;
@@ -1,9 +1,11 @@
 #include "CodeGen_WebAssembly.h"
 
+#include "Bounds.h"
 #include "ConciseCasts.h"
 #include "IRMatch.h"
 #include "IROperator.h"
 #include "LLVM_Headers.h"
+#include "Simplify.h"
 #include "Util.h"
 
 #include <sstream>
@@ -54,6 +56,28 @@ const WasmIntrinsic intrinsic_defs[] = {
     {"llvm.wasm.avgr.unsigned.v16i8", UInt(8, 16), "rounding_halving_add", {UInt(8, 16), UInt(8, 16)}, Target::WasmSimd128},
     {"llvm.wasm.avgr.unsigned.v8i16", UInt(16, 8), "rounding_halving_add", {UInt(16, 8), UInt(16, 8)}, Target::WasmSimd128},
 
+#if LLVM_VERSION >= 120
+    {"llvm.wasm.dot", Int(32, 4), "dot_product", {Int(16, 8), Int(16, 8)}, Target::WasmSimd128},
+#endif
+
+    // Relaxed SIMD. These may be fused or not, and may round
+    // differently, depending on the engine.
+#if LLVM_VERSION >= 160
+    {"llvm.wasm.relaxed.madd.v4f32", Float(32, 4), "relaxed_madd", {Float(32, 4), Float(32, 4), Float(32, 4)}, Target::WasmRelaxedSimd},
+    {"llvm.wasm.relaxed.madd.v2f64", Float(64, 2), "relaxed_madd", {Float(64, 2), Float(64, 2), Float(64, 2)}, Target::WasmRelaxedSimd},
+    {"llvm.wasm.relaxed.nmadd.v4f32", Float(32, 4), "relaxed_nmadd", {Float(32, 4), Float(32, 4), Float(32, 4)}, Target::WasmRelaxedSimd},
+    {"llvm.wasm.relaxed.nmadd.v2f64", Float(64, 2), "relaxed_nmadd", {Float(64, 2), Float(64, 2), Float(64, 2)}, Target::WasmRelaxedSimd},
+    // The second operand must be in [0, 127] for the result to be
+    // the same on every engine.
+    {"llvm.wasm.relaxed.dot.i8x16.i7x16.signed", Int(16, 8), "relaxed_dot_product", {Int(8, 16), Int(8, 16)}, Target::WasmRelaxedSimd},
+    {"llvm.wasm.relaxed.dot.i8x16.i7x16.add.signed", Int(32, 4), "relaxed_dot_product", {Int(8, 16), Int(8, 16), Int(32, 4)}, Target::WasmRelaxedSimd},
+#elif LLVM_VERSION >= 140
+    {"llvm.wasm.fma.v4f32", Float(32, 4), "relaxed_madd", {Float(32, 4), Float(32, 4), Float(32, 4)}, Target::WasmRelaxedSimd},
+    {"llvm.wasm.fma.v2f64", Float(64, 2), "relaxed_madd", {Float(64, 2), Float(64, 2), Float(64, 2)}, Target::WasmRelaxedSimd},
+    {"llvm.wasm.fms.v4f32", Float(32, 4), "relaxed_nmadd", {Float(32, 4), Float(32, 4), Float(32, 4)}, Target::WasmRelaxedSimd},
+    {"llvm.wasm.fms.v2f64", Float(64, 2), "relaxed_nmadd", {Float(64, 2), Float(64, 2), Float(64, 2)}, Target::WasmRelaxedSimd},
+#endif
+
     // TODO: LLVM should support this directly, but doesn't yet.
     // To make this work, we need to be able to call the intrinsics with two vecs.
     // @abadams sez: "The way I've had to do this in the past is with force-inlined implementations
@@ -65,6 +89,12 @@ const WasmIntrinsic intrinsic_defs[] = {
 };
 // clang-format on
 
+// Is an integer vector known to be in [0, 127]?
+bool fits_in_7_bits(const Expr &e) {
+    Interval i = bounds_of_expr_in_scope(e, Scope<Interval>::empty_scope(), FuncValueBounds(), true);
+    return i.is_bounded() && can_prove(i.min >= 0 && i.max <= 127);
+}
+
 }  // namespace
 
 void CodeGen_WebAssembly::init_module() {
@@ -89,6 +119,130 @@ void CodeGen_WebAssembly::init_module() {
     }
 }
 
+void CodeGen_WebAssembly::codegen_vector_reduce(const VectorReduce *op, const Expr &init) {
+    if (op->op != VectorReduce::Add || !target.has_feature(Target::WasmSimd128)) {
+        CodeGen_Posix::codegen_vector_reduce(op, init);
+        return;
+    }
+    const int factor = op->value.type().lanes() / op->type.lanes();
+
+    struct Pattern {
+        int factor;
+        Expr pattern;
+        const char *intrin;
+        Type narrow_type;
+        Target::Feature required_feature;
+    };
+    // clang-format off
+    static const Pattern patterns[] = {
+        {4, i32(widening_mul(wild_i8x_, wild_i8x_)), "relaxed_dot_product", Int(8), Target::WasmRelaxedSimd},
+        {4, i32(widening_mul(wild_i8x_, wild_u8x_)), "relaxed_dot_product", Int(8), Target::WasmRelaxedSimd},
+        {4, i32(widening_mul(wild_u8x_, wild_i8x_)), "relaxed_dot_product", Int(8), Target::WasmRelaxedSimd},
+        {2, i16(widening_mul(wild_i8x_, wild_i8x_)), "relaxed_dot_product", Int(8), Target::WasmRelaxedSimd},
+        {2, i16(widening_mul(wild_i8x_, wild_u8x_)), "relaxed_dot_product", Int(8), Target::WasmRelaxedSimd},
+        {2, i16(widening_mul(wild_u8x_, wild_i8x_)), "relaxed_dot_product", Int(8), Target::WasmRelaxedSimd},
+        {2, i32(widening_mul(wild_i16x_, wild_i16x_)), "dot_product", Int(16), Target::WasmSimd128},
+        {2, i32(widening_mul(wild_i8x_, wild_i8x_)), "dot_product", Int(16), Target::WasmSimd128},
+        {2, i32(widening_mul(wild_i8x_, wild_u8x_)), "dot_product", Int(16), Target::WasmSimd128},
+        {2, i32(widening_mul(wild_u8x_, wild_i8x_)), "dot_product", Int(16), Target::WasmSimd128},
+        {2, i32(widening_mul(wild_u8x_, wild_u8x_)), "dot_product", Int(16), Target::WasmSimd128},
+    };
+    // clang-format on
+
+    std::vector<Expr> matches;
+    for (const Pattern &p : patterns) {
+        if (p.factor != factor || !target.has_feature(p.required_feature)) {
+            continue;
+        }
+        if (expr_match(p.pattern, op->value, matches)) {
+            Expr a = matches[0];
+            Expr b = matches[1];
+            if (p.narrow_type.bits() == 8) {
+                // The relaxed dot products treat the second operand
+                // as either signed or unsigned, depending on the
+                // engine, so it must be known to fit in 7 bits.
+                if (!fits_in_7_bits(b)) {
+                    std::swap(a, b);
+                }
+                if (!fits_in_7_bits(b)) {
+                    continue;
+                }
+                b = cast(p.narrow_type.with_lanes(b.type().lanes()), b);
+            }
+            a = lossless_cast(p.narrow_type.with_lanes(a.type().lanes()), a);
+            b = lossless_cast(p.narrow_type.with_lanes(b.type().lanes()), b);
+            if (!a.defined() || !b.defined()) {
+                continue;
+            }
+
+            if (factor == 4) {
+                // The accumulating form takes the initial value as
+                // its last argument.
+                Expr i = init;
+                if (!i.defined()) {
+                    i = make_zero(op->type);
+                }
+                value = call_overloaded_intrin(op->type, p.intrin, {a, b, i});
+                if (value) {
+                    return;
+                }
+                continue;
+            }
+
+            value = call_overloaded_intrin(op->type, p.intrin, {a, b});
+            if (value) {
+                if (init.defined()) {
+                    Value *x = value;
+                    Value *y = codegen(init);
+                    value = builder->CreateAdd(x, y);
+                }
+                return;
+            }
+        }
+    }
+
+    CodeGen_Posix::codegen_vector_reduce(op, init);
+}
+
+bool CodeGen_WebAssembly::use_relaxed_madd(const Type &t) const {
+    // Relaxed madd rounds once or twice depending on the engine, so
+    // only use it where we're allowed to contract a multiply and an
+    // add. Inside strict_float this is turned off.
+    return target.has_feature(Target::WasmRelaxedSimd) &&
+           builder->getFastMathFlags().allowContract() &&
+           t.is_float() && t.is_vector() && t.bits() >= 32;
+}
+
+void CodeGen_WebAssembly::visit(const Add *op) {
+    if (use_relaxed_madd(op->type)) {
+        const Mul *mul = op->a.as<Mul>();
+        Expr c = op->b;
+        if (!mul) {
+            mul = op->b.as<Mul>();
+            c = op->a;
+        }
+        if (mul) {
+            value = call_overloaded_intrin(op->type, "relaxed_madd", {mul->a, mul->b, c});
+            if (value) {
+                return;
+            }
+        }
+    }
+    CodeGen_Posix::visit(op);
+}
+
+void CodeGen_WebAssembly::visit(const Sub *op) {
+    if (use_relaxed_madd(op->type)) {
+        if (const Mul *mul = op->b.as<Mul>()) {
+            value = call_overloaded_intrin(op->type, "relaxed_nmadd", {mul->a, mul->b, op->a});
+            if (value) {
+                return;
+            }
+        }
+    }
+    CodeGen_Posix::visit(op);
+}
+
 string CodeGen_WebAssembly::mcpu() const {
     return "";
 }
@@ -113,15 +267,24 @@ string CodeGen_WebAssembly::mattrs() const {
     }
 
     if (target.has_feature(Target::WasmThreads)) {
-        s << sep << ",+atomics";
+        // Shared memory requires bulk memory for passive segments.
+        s << sep << "+atomics,+mutable-globals";
         sep = ",";
     }
 
-    if (target.has_feature(Target::WasmBulkMemory)) {
+    if (target.has_feature(Target::WasmBulkMemory) ||
+        target.has_feature(Target::WasmThreads)) {
         s << sep << "+bulk-memory";
         sep = ",";
     }
 
+    if (target.has_feature(Target::WasmRelaxedSimd)) {
+        user_assert(LLVM_VERSION >= 140) << "wasm_relaxed_simd requires LLVM 14+.";
+        user_assert(target.has_feature(Target::WasmSimd128)) << "wasm_relaxed_simd requires wasm_simd128.";
+        s << sep << "+relaxed-simd";
+        sep = ",";
+    }
+
     user_assert(target.os == Target::WebAssemblyRuntime)
         << "wasmrt is the only supported 'os' for WebAssembly at this time.";
 
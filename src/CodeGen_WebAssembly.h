@@ -22,6 +22,13 @@ protected:
 
     void init_module() override;
 
+    void visit(const Add *) override;
+    void visit(const Sub *) override;
+    void codegen_vector_reduce(const VectorReduce *, const Expr &) override;
+
+    /** Should a float multiply-add of this type use relaxed madd? */
+    bool use_relaxed_madd(const Type &t) const;
+
     std::string mcpu() const override;
     std::string mattrs() const override;
     bool use_soft_float_abi() const override;
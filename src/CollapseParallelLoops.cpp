@@ -0,0 +1,205 @@
+#include "CollapseParallelLoops.h"
+#include "Bounds.h"
+#include "ExprUsesVar.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "Scope.h"
+#include "Simplify.h"
+#include "Substitute.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::pair;
+using std::string;
+using std::vector;
+
+namespace {
+
+// The number of rows of the outer loop in each band of the collapsed
+// loop. The thread pool claims runs of consecutive iterations, so with
+// bands of this height a claim of k^2 iterations covers a block of
+// roughly band_rows by k^2 / band_rows tiles.
+const int band_rows = 8;
+
+bool is_host_parallel(const For *op) {
+    return (op->for_type == ForType::Parallel &&
+            op->grain_size == 0 &&
+            (op->device_api == DeviceAPI::None ||
+             op->device_api == DeviceAPI::Host));
+}
+
+class CollapseParallelLoops : public IRMutator {
+    using IRMutator::visit;
+
+    // Bounds of the enclosing lets and loop variables.
+    Scope<Interval> scope;
+
+    Stmt visit(const LetStmt *op) override {
+        ScopedBinding<Interval> bind(scope, op->name, bounds_of_expr_in_scope(op->value, scope));
+        return IRMutator::visit(op);
+    }
+
+    Stmt visit_loop(const For *op) {
+        Interval min_bounds = bounds_of_expr_in_scope(op->min, scope);
+        Interval max_bounds = bounds_of_expr_in_scope(op->min + op->extent - 1, scope);
+        ScopedBinding<Interval> bind(scope, op->name, Interval(min_bounds.min, max_bounds.max));
+        return IRMutator::visit(op);
+    }
+
+    Stmt visit(const For *op) override {
+        if (!is_host_parallel(op)) {
+            return visit_loop(op);
+        }
+
+        // Find the chain of directly nested parallel loops starting
+        // here, and peel off the lets between them. Those that depend
+        // on an enclosing loop variable of the chain have to go inside
+        // the collapsed loop; the rest can be lifted out of it.
+        vector<const For *> loops = {op};
+        vector<pair<string, Expr>> inner_lets, outer_lets;
+        Scope<> varying;
+        varying.push(op->name);
+        while (true) {
+            vector<pair<string, Expr>> new_inner_lets, new_outer_lets;
+            Stmt body = loops.back()->body;
+            const LetStmt *let = body.as<LetStmt>();
+            while (let) {
+                if (expr_uses_vars(let->value, varying)) {
+                    varying.push(let->name);
+                    new_inner_lets.emplace_back(let->name, let->value);
+                } else {
+                    new_outer_lets.emplace_back(let->name, let->value);
+                }
+                body = let->body;
+                let = body.as<LetStmt>();
+            }
+
+            const For *inner = body.as<For>();
+            if (!inner ||
+                !is_host_parallel(inner) ||
+                expr_uses_vars(inner->min, varying) ||
+                expr_uses_vars(inner->extent, varying)) {
+                break;
+            }
+            loops.push_back(inner);
+            varying.push(inner->name);
+            inner_lets.insert(inner_lets.end(), new_inner_lets.begin(), new_inner_lets.end());
+            outer_lets.insert(outer_lets.end(), new_outer_lets.begin(), new_outer_lets.end());
+        }
+
+        if (loops.size() == 1) {
+            return visit_loop(op);
+        }
+
+        // The number of iterations of the loops inside each loop of
+        // the chain.
+        const int n = (int)loops.size();
+        vector<Expr> extents(n), inner_size(n);
+        for (int i = 0; i < n; i++) {
+            extents[i] = max(loops[i]->extent, 0);
+        }
+        inner_size[n - 1] = 1;
+        for (int i = n - 2; i >= 0; i--) {
+            inner_size[i] = extents[i + 1] * inner_size[i + 1];
+        }
+
+        // The collapsed loop counts in 32 bits, so it's only usable if
+        // the whole loop and a band of each level of it fit. Only
+        // collapse the loops if that can be proven from upper bounds
+        // on their extents. The check is done in 64 bits, saturating
+        // the running product so that it can't overflow either.
+        bool fits = true;
+        {
+            vector<ScopedBinding<Interval>> lifted;
+            for (const auto &let : outer_lets) {
+                lifted.emplace_back(scope, let.first, bounds_of_expr_in_scope(let.second, scope));
+            }
+            Expr max_iters = cast<int64_t>(Int(32).max());
+            Expr size64 = make_const(Int(64), 1);
+            for (int i = n - 1; i >= 0 && fits; i--) {
+                Interval bounds = bounds_of_expr_in_scope(extents[i], scope);
+                if (!bounds.has_upper_bound()) {
+                    fits = false;
+                    break;
+                }
+                Expr extent = cast<int64_t>(bounds.max);
+                fits = can_prove(size64 * max(extent, band_rows) <= max_iters);
+                size64 = simplify(min(size64 * extent, max_iters + 1));
+            }
+        }
+        if (!fits) {
+            debug(3) << "Not collapsing the parallel loops starting at " << op->name
+                     << ", because their iterations can't be proven to fit in 32 bits\n";
+            return visit_loop(op);
+        }
+
+        const For *innermost = loops.back();
+        Stmt innermost_body;
+        {
+            // The loop variables are bound as in the nest being replaced.
+            vector<ScopedBinding<Interval>> bindings;
+            for (const auto &let : outer_lets) {
+                bindings.emplace_back(scope, let.first, bounds_of_expr_in_scope(let.second, scope));
+            }
+            for (const For *loop : loops) {
+                Interval min_bounds = bounds_of_expr_in_scope(loop->min, scope);
+                Interval max_bounds = bounds_of_expr_in_scope(loop->min + loop->extent - 1, scope);
+                bindings.emplace_back(scope, loop->name, Interval(min_bounds.min, max_bounds.max));
+            }
+            for (const auto &let : inner_lets) {
+                bindings.emplace_back(scope, let.first, bounds_of_expr_in_scope(let.second, scope));
+            }
+            innermost_body = mutate(innermost->body);
+        }
+
+        debug(3) << "Collapsing " << loops.size() << " parallel loops starting at " << op->name << "\n";
+
+        // Walk bands of band_rows rows of the outermost loop in turn,
+        // and within a band, go column by column through the loops
+        // inside it, which are collapsed the same way. The last band
+        // may be short.
+        string name = op->name + ".collapsed";
+        Stmt new_body = innermost_body;
+        for (auto it = inner_lets.rbegin(); it != inner_lets.rend(); it++) {
+            new_body = LetStmt::make(it->first, it->second, new_body);
+        }
+        vector<pair<string, Expr>> index_lets;
+        for (int i = 0; i < n; i++) {
+            string prefix = loops[i]->name + ".collapsed";
+            Expr t = Variable::make(Int(32), prefix);
+            if (i == n - 1) {
+                index_lets.emplace_back(loops[i]->name, loops[i]->min + t);
+                break;
+            }
+            Expr band = Variable::make(Int(32), prefix + ".band");
+            Expr idx = Variable::make(Int(32), prefix + ".idx");
+            Expr rows = Variable::make(Int(32), prefix + ".rows");
+            Expr band_size = inner_size[i] * band_rows;
+            index_lets.emplace_back(prefix + ".band", t / band_size);
+            index_lets.emplace_back(prefix + ".idx", t - band * band_size);
+            index_lets.emplace_back(prefix + ".rows", min(extents[i] - band * band_rows, band_rows));
+            index_lets.emplace_back(loops[i]->name, loops[i]->min + band * band_rows + idx % rows);
+            index_lets.emplace_back(loops[i + 1]->name + ".collapsed", idx / rows);
+        }
+        for (auto it = index_lets.rbegin(); it != index_lets.rend(); it++) {
+            new_body = LetStmt::make(it->first, it->second, new_body);
+        }
+
+        Stmt collapsed = For::make(name, 0, extents[0] * inner_size[0], ForType::Parallel,
+                                   op->device_api, new_body);
+        for (auto it = outer_lets.rbegin(); it != outer_lets.rend(); it++) {
+            collapsed = LetStmt::make(it->first, it->second, collapsed);
+        }
+        return collapsed;
+    }
+};
+
+}  // namespace
+
+Stmt collapse_parallel_loops(const Stmt &s) {
+    return CollapseParallelLoops().mutate(s);
+}
+
+}  // namespace Internal
+}  // namespace Halide
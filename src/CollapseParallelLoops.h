@@ -0,0 +1,31 @@
+#ifndef HALIDE_COLLAPSE_PARALLEL_LOOPS_H
+#define HALIDE_COLLAPSE_PARALLEL_LOOPS_H
+
+/** \file
+ * Defines the lowering pass that turns directly nested parallel loops
+ * into a single 2-D parallel loop.
+ */
+
+#include "Expr.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Replace chains of parallel host loops where each inner loop is the
+ * whole body of the one outside it (give or take some lets), and has
+ * bounds that don't depend on the outer loops, with a single parallel
+ * loop over all of them. The iterations of the new loop visit bands of a few
+ * rows of the outer loop at a time, column by column, so a chunk of
+ * consecutive iterations claimed by one thread covers a compact block
+ * of the 2-D space rather than a long thin strip of it. For the tile
+ * indices of a stencil this means neighboring tiles, which share
+ * their halos, mostly run on the same core. Loops with an explicit
+ * grain size are left alone. Loops are only collapsed when bounds
+ * on their extents prove that the iterations can be counted in 32
+ * bits, so nests with unbounded extents are left alone too. */
+Stmt collapse_parallel_loops(const Stmt &s);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
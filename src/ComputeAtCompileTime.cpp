@@ -0,0 +1,207 @@
+#include "ComputeAtCompileTime.h"
+#include "FindCalls.h"
+#include "Func.h"
+#include "Function.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "IRVisitor.h"
+#include "Simplify.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace {
+
+// Find the first runtime parameter, scalar or buffer, that some IR
+// refers to.
+class FindParameter : public IRGraphVisitor {
+    using IRGraphVisitor::visit;
+
+    void visit(const Variable *op) override {
+        if (op->param.defined() && name.empty()) {
+            name = op->param.name();
+        }
+    }
+
+    void visit(const Call *op) override {
+        IRGraphVisitor::visit(op);
+        if (op->param.defined() && name.empty()) {
+            name = op->param.name();
+        }
+    }
+
+public:
+    string name;
+};
+
+void check_no_parameters(const Function &f) {
+    for (const auto &it : find_transitive_calls(f)) {
+        const Function &g = it.second;
+        FindParameter finder;
+        g.accept(&finder);
+        string param = finder.name;
+        if (g.has_extern_definition()) {
+            for (const ExternFuncArgument &arg : g.extern_arguments()) {
+                if (arg.is_image_param() && param.empty()) {
+                    param = arg.image_param.name();
+                }
+            }
+        }
+        if (!param.empty()) {
+            string culprit = (g.name() == f.name()) ? "it" : ("Func " + g.name() + ", which it calls,");
+            user_error << "Func " << f.name() << " can't be computed at compile time, because "
+                       << culprit << " depends on the runtime parameter " << param << ".\n";
+        }
+    }
+}
+
+// Realize a Function over the region given by its bounds.
+vector<Buffer<>> evaluate(Function f) {
+    vector<int> mins, extents;
+    for (const string &arg : f.args()) {
+        const Bound *bound = nullptr;
+        for (const Bound &b : f.schedule().bounds()) {
+            if (b.var == arg) {
+                bound = &b;
+            }
+        }
+        const int64_t *min = nullptr, *extent = nullptr;
+        Expr min_expr, extent_expr;
+        if (bound && bound->min.defined() && bound->extent.defined()) {
+            min_expr = simplify(bound->min);
+            extent_expr = simplify(bound->extent);
+            min = as_const_int(min_expr);
+            extent = as_const_int(extent_expr);
+        }
+        user_assert(min && extent)
+            << "Func " << f.name() << " can't be computed at compile time, because "
+            << "dimension " << arg << " does not have a constant bound. "
+            << "Use Func::bound to give it one.\n";
+        mins.push_back((int)*min);
+        extents.push_back((int)*extent);
+    }
+
+    debug(1) << "Computing " << f.name() << " at compile time\n";
+
+    vector<Buffer<>> buffers;
+    for (size_t i = 0; i < f.output_types().size(); i++) {
+        string name = f.name();
+        if (f.outputs() > 1) {
+            name += "_" + std::to_string(i);
+        }
+        Buffer<> b(f.output_types()[i], extents, name);
+        b.set_min(mins);
+        buffers.push_back(b);
+    }
+
+    // This copy of the Function is about to be dropped from the
+    // pipeline, so clear the flag on it rather than making another
+    // copy. Otherwise, lowering it on its own would try to compute it
+    // at compile time again.
+    f.schedule().compute_at_compile_time() = false;
+    Realization r(buffers);
+    Func(f).realize(r, get_host_target());
+    return buffers;
+}
+
+// Replace calls to a Function with loads from the Buffers holding
+// its values.
+class ReplaceCalls : public IRMutator {
+    using IRMutator::visit;
+
+    const string &name;
+    const vector<Buffer<>> &buffers;
+
+    Expr visit(const Call *op) override {
+        if (op->call_type == Call::Halide && op->name == name) {
+            vector<Expr> args;
+            for (const Expr &arg : op->args) {
+                args.push_back(mutate(arg));
+            }
+            return Call::make(buffers[op->value_index], args);
+        }
+        return IRMutator::visit(op);
+    }
+
+public:
+    ReplaceCalls(const string &name, const vector<Buffer<>> &buffers)
+        : name(name), buffers(buffers) {
+    }
+};
+
+}  // namespace
+
+void compute_at_compile_time(const vector<Function> &outputs,
+                             map<string, Function> &env) {
+    vector<string> pending;
+    for (const auto &it : env) {
+        if (it.second.schedule().compute_at_compile_time()) {
+            pending.push_back(it.first);
+        }
+    }
+    if (pending.empty()) {
+        return;
+    }
+
+    for (const Function &f : outputs) {
+        user_assert(!f.schedule().compute_at_compile_time())
+            << "Func " << f.name() << " can't be computed at compile time, "
+            << "because it is an output of the pipeline.\n";
+    }
+
+    while (!pending.empty()) {
+        // Evaluate Functions before the ones that call them, so that
+        // those get evaluated in terms of the constant results.
+        size_t next = 0;
+        for (; next < pending.size(); next++) {
+            map<string, Function> calls = find_transitive_calls(env.at(pending[next]));
+            bool ready = true;
+            for (const string &other : pending) {
+                ready &= (other == pending[next] || !calls.count(other));
+            }
+            if (ready) {
+                break;
+            }
+        }
+        internal_assert(next < pending.size());
+        Function f = env.at(pending[next]);
+        pending.erase(pending.begin() + next);
+
+        check_no_parameters(f);
+        vector<Buffer<>> buffers = evaluate(f);
+
+        ReplaceCalls replacer(f.name(), buffers);
+        for (auto &it : env) {
+            if (it.first == f.name()) {
+                continue;
+            }
+            Function &g = it.second;
+            g.mutate(&replacer);
+            if (g.has_extern_definition()) {
+                vector<ExternFuncArgument> args;
+                for (const ExternFuncArgument &arg : g.extern_arguments()) {
+                    if (arg.is_func() && Function(arg.func).name() == f.name()) {
+                        args.insert(args.end(), buffers.begin(), buffers.end());
+                    } else {
+                        args.push_back(arg);
+                    }
+                }
+                g.extern_arguments() = args;
+            }
+        }
+    }
+
+    // Drop the evaluated Functions, and anything only they called.
+    map<string, Function> new_env;
+    for (const Function &f : outputs) {
+        populate_environment(f, new_env);
+    }
+    env.swap(new_env);
+}
+
+}  // namespace Internal
+}  // namespace Halide
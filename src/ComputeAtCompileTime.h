@@ -0,0 +1,31 @@
+#ifndef HALIDE_COMPUTE_AT_COMPILE_TIME_H
+#define HALIDE_COMPUTE_AT_COMPILE_TIME_H
+
+/** \file
+ * Defines the lowering pass that evaluates Funcs scheduled with
+ * Func::compute_at_compile_time.
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Halide {
+namespace Internal {
+
+class Function;
+
+/** Evaluate each Function in env that is scheduled to be computed at
+ * compile time, by JIT-compiling it for the host over the constant
+ * region given by its bounds. Replace all calls to it with loads from
+ * the resulting Buffer, which then gets embedded in the compiled
+ * pipeline as a constant, and remove it from env. Must be called
+ * after wrappers have been substituted in and before the realization
+ * order is computed. */
+void compute_at_compile_time(const std::vector<Function> &outputs,
+                             std::map<std::string, Function> &env);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
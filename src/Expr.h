@@ -360,7 +360,10 @@ enum class MemoryType {
     /** Register memory. The allocation should be promoted into the
      * register file. All stores must be at constant coordinates. May
      * be spilled to the stack at the discretion of the register
-     * allocator. */
+     * allocator. On the CPU, Halide itself replaces the allocation
+     * with a value per store if all loads and stores are at constant
+     * coordinates in straight-line (e.g. fully unrolled) code, and
+     * warns if it can't. */
     Register,
 
     /** Allocation is stored in GPU shared memory. Also known as
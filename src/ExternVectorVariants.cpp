@@ -0,0 +1,67 @@
+#include "ExternVectorVariants.h"
+#include "Error.h"
+#include "Function.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::string;
+using std::vector;
+
+vector<VectorExternVariant> gather_vector_externs(const map<string, Function> &env) {
+    vector<VectorExternVariant> result;
+    for (const auto &it : env) {
+        for (const VectorExternVariant &v : it.second.schedule().vector_externs()) {
+            bool duplicate = false;
+            for (const VectorExternVariant &other : result) {
+                if (other.vector_name != v.vector_name) {
+                    continue;
+                }
+                user_assert(other.scalar_name == v.scalar_name && other.lanes == v.lanes)
+                    << "Vector variant " << v.vector_name << " is declared as "
+                    << other.lanes << " lanes of " << other.scalar_name << " and as "
+                    << v.lanes << " lanes of " << v.scalar_name
+                    << " in the same pipeline.\n";
+                duplicate = true;
+            }
+            if (!duplicate) {
+                result.push_back(v);
+            }
+        }
+    }
+    return result;
+}
+
+std::pair<string, int> find_vector_extern(const vector<VectorExternVariant> &variants,
+                                          const string &scalar_name,
+                                          int lanes,
+                                          const Target &target) {
+    // Prefer the widest variant that fits, otherwise the narrowest
+    // one that doesn't.
+    const VectorExternVariant *best = nullptr;
+    for (const VectorExternVariant &v : variants) {
+        if (v.scalar_name != scalar_name ||
+            (v.arch != Target::ArchUnknown && v.arch != target.arch) ||
+            !target.features_all_of(v.features)) {
+            continue;
+        }
+        if (!best) {
+            best = &v;
+        } else if (best->lanes > lanes) {
+            if (v.lanes < best->lanes) {
+                best = &v;
+            }
+        } else if (v.lanes <= lanes && v.lanes > best->lanes) {
+            best = &v;
+        }
+    }
+
+    if (!best) {
+        return {string(), 0};
+    }
+    return {best->vector_name, best->lanes};
+}
+
+}  // namespace Internal
+}  // namespace Halide
@@ -0,0 +1,49 @@
+#ifndef HALIDE_EXTERN_VECTOR_VARIANTS_H
+#define HALIDE_EXTERN_VECTOR_VARIANTS_H
+
+/** \file
+ * Defines the vector variants of pure extern C functions that Funcs
+ * can declare with Func::vector_extern, so that vectorized calls to
+ * them don't get scalarized.
+ */
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Target.h"
+
+namespace Halide {
+namespace Internal {
+
+class Function;
+
+/** An extern "C" function that computes lanes lanes of the pure
+ * extern function scalar_name at once, for use when compiling for
+ * the given architecture (ArchUnknown means any) and a target with
+ * all of the given features. */
+struct VectorExternVariant {
+    std::string scalar_name, vector_name;
+    int lanes = 0;
+    Target::Arch arch = Target::ArchUnknown;
+    std::vector<Target::Feature> features;
+};
+
+/** Gather the vector variants declared by all the Functions in a
+ * pipeline. */
+std::vector<VectorExternVariant> gather_vector_externs(const std::map<std::string, Function> &env);
+
+/** The name and width of the best of the given vector variants of
+ * the extern function scalar_name to use for a call with the given
+ * number of lanes on the given target. Returns an empty name and
+ * zero lanes if there is none. */
+std::pair<std::string, int> find_vector_extern(const std::vector<VectorExternVariant> &variants,
+                                               const std::string &scalar_name,
+                                               int lanes,
+                                               const Target &target);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
@@ -203,6 +203,86 @@ const std::string &Func::extern_function_name() const {
     return func.extern_function_name();
 }
 
+namespace {
+
+// Find any Vars in an extern footprint that aren't pure Vars of the
+// extern stage.
+class FindNonPureVars : public IRGraphVisitor {
+    using IRGraphVisitor::visit;
+
+    void visit(const Variable *var) override {
+        if (!var->param.defined() && !var->image.defined() &&
+            std::find(args.begin(), args.end(), var->name) == args.end()) {
+            offending_var = var->name;
+        }
+    }
+
+    const vector<string> &args;
+
+public:
+    string offending_var;
+
+    FindNonPureVars(const vector<string> &args)
+        : args(args) {
+    }
+};
+
+}  // namespace
+
+Func &Func::extern_footprint(const std::vector<Expr> &sites) {
+    user_assert(is_extern())
+        << "Can't set the extern footprint of Func " << name()
+        << " because it does not have an extern definition.\n";
+    user_assert(!sites.empty())
+        << "The extern footprint of Func " << name() << " may not be empty.\n";
+
+    // The inputs of the extern stage, and whether the footprint says
+    // which of their sites are read.
+    map<string, bool> inputs;
+    for (const ExternFuncArgument &arg : func.extern_arguments()) {
+        if (arg.is_func()) {
+            inputs[Function(arg.func).name()] = false;
+        } else if (arg.is_buffer()) {
+            inputs[arg.buffer.name()] = false;
+        } else if (arg.is_image_param()) {
+            inputs[arg.image_param.name()] = false;
+        }
+    }
+
+    FindNonPureVars check(func.args());
+    for (const Expr &site : sites) {
+        user_assert(site.defined())
+            << "Undefined Expr in the extern footprint of Func " << name() << ".\n";
+        const Call *call = site.as<Call>();
+        user_assert(call &&
+                    (call->call_type == Call::Halide || call->call_type == Call::Image) &&
+                    inputs.count(call->name))
+            << "The extern footprint " << site << " of Func " << name()
+            << " is not a call to one of the inputs of its extern definition.\n";
+        inputs[call->name] = true;
+        site.accept(&check);
+        user_assert(check.offending_var.empty())
+            << "The extern footprint " << site << " of Func " << name()
+            << " depends on " << check.offending_var
+            << ", which is not one of its pure Vars.\n";
+    }
+    for (const auto &it : inputs) {
+        user_assert(it.second)
+            << "The extern footprint of Func " << name()
+            << " does not include any sites of its input " << it.first << ".\n";
+    }
+
+    // Bounds inference uses the proxy Expr in place of asking the
+    // extern stage for its footprint.
+    Expr proxy = sites[0];
+    if (sites.size() > 1) {
+        proxy = Call::make(Int(32), Call::bundle, sites, Call::PureIntrinsic);
+    }
+    func.extern_definition_proxy_expr() = proxy;
+    invalidate_cache();
+    return *this;
+}
+
 int Func::dimensions() const {
     if (!defined()) {
         return 0;
@@ -1467,6 +1547,20 @@ Stage &Stage::parallel(const VarOrRVar &var, const Expr &factor, TailStrategy ta
     return *this;
 }
 
+Stage &Stage::parallel_grain(const VarOrRVar &var, int grain_size) {
+    user_assert(grain_size >= 0)
+        << "In schedule for " << name()
+        << ", grain size for " << var.name()
+        << " must be non-negative. Got " << grain_size << "\n";
+    set_dim_type(var, ForType::Parallel);
+    for (Dim &dim : definition.schedule().dims()) {
+        if (var_name_match(dim.var, var.name())) {
+            dim.grain_size = grain_size;
+        }
+    }
+    return *this;
+}
+
 Stage &Stage::vectorize(const VarOrRVar &var, const Expr &factor, TailStrategy tail) {
     if (var.is_rvar) {
         RVar tmp;
@@ -2106,12 +2200,85 @@ Func &Func::memoize(const EvictionKey &eviction_key) {
     return *this;
 }
 
+Func &Func::compute_at_compile_time() {
+    invalidate_cache();
+    user_assert(defined())
+        << "Can't compute Func " << name()
+        << " at compile time because it has not yet been defined.\n";
+    func.schedule().compute_at_compile_time() = true;
+    return *this;
+}
+
+Func &Func::vector_extern(const string &scalar_name,
+                          const string &vector_name,
+                          int lanes,
+                          Target::Arch arch,
+                          const vector<Target::Feature> &features) {
+    invalidate_cache();
+    user_assert(lanes > 1)
+        << "Vector variant " << vector_name << " of extern function " << scalar_name
+        << " must have more than one lane\n";
+    user_assert(scalar_name != vector_name)
+        << "Vector variant of extern function " << scalar_name << " must have a different name\n";
+
+    VectorExternVariant variant{scalar_name, vector_name, lanes, arch, features};
+    for (VectorExternVariant &v : func.schedule().vector_externs()) {
+        if (v.vector_name == vector_name) {
+            v = variant;
+            return *this;
+        }
+    }
+    func.schedule().vector_externs().push_back(variant);
+    return *this;
+}
+
 Func &Func::store_in(MemoryType t) {
     invalidate_cache();
     func.schedule().memory_type() = t;
     return *this;
 }
 
+Func &Func::store_tuple_interleaved() {
+    invalidate_cache();
+    user_assert(defined())
+        << "Can't call store_tuple_interleaved on Func " << name()
+        << " because it has not yet been defined.\n";
+    const vector<Type> &types = func.output_types();
+    user_assert(types.size() > 1)
+        << "Can't store the tuple elements of Func " << name()
+        << " interleaved, because it is not Tuple-valued.\n";
+    for (const Type &t : types) {
+        user_assert(t == types[0])
+            << "Can't store the tuple elements of Func " << name()
+            << " interleaved, because they have different types: "
+            << types[0] << " and " << t << "\n";
+    }
+    func.schedule().interleave_tuple() = true;
+    return *this;
+}
+
+Func &Func::aliases(const ImageParam &input) {
+    invalidate_cache();
+    user_assert(defined())
+        << "Can't call aliases on Func " << name()
+        << " because it has not yet been defined.\n";
+    user_assert(input.defined())
+        << "Func " << name() << " can't alias an undefined ImageParam.\n";
+    user_assert(outputs() == 1)
+        << "Func " << name() << " can't alias input " << input.name()
+        << " because it is Tuple-valued.\n";
+    user_assert(output_types()[0] == input.type())
+        << "Func " << name() << " can't alias input " << input.name()
+        << " because they have different types: "
+        << output_types()[0] << " and " << input.type() << "\n";
+    user_assert(dimensions() == input.dimensions())
+        << "Func " << name() << " can't alias input " << input.name()
+        << " because they have different dimensionalities: "
+        << dimensions() << " and " << input.dimensions() << "\n";
+    func.schedule().aliased_input() = input.parameter();
+    return *this;
+}
+
 Func &Func::async() {
     invalidate_cache();
     func.schedule().async() = true;
@@ -2158,6 +2325,12 @@ Func &Func::parallel(const VarOrRVar &var, const Expr &factor, TailStrategy tail
     return *this;
 }
 
+Func &Func::parallel_grain(const VarOrRVar &var, int grain_size) {
+    invalidate_cache();
+    Stage(func, func.definition(), 0).parallel_grain(var, grain_size);
+    return *this;
+}
+
 Func &Func::vectorize(const VarOrRVar &var, const Expr &factor, TailStrategy tail) {
     invalidate_cache();
     Stage(func, func.definition(), 0).vectorize(var, factor, tail);
@@ -348,6 +348,7 @@ public:
     Stage &vectorize(const VarOrRVar &var);
     Stage &unroll(const VarOrRVar &var);
     Stage &parallel(const VarOrRVar &var, const Expr &task_size, TailStrategy tail = TailStrategy::Auto);
+    Stage &parallel_grain(const VarOrRVar &var, int grain_size);
     Stage &vectorize(const VarOrRVar &var, const Expr &factor, TailStrategy tail = TailStrategy::Auto);
     Stage &unroll(const VarOrRVar &var, const Expr &factor, TailStrategy tail = TailStrategy::Auto);
     Stage &tile(const VarOrRVar &x, const VarOrRVar &y,
@@ -1270,6 +1271,31 @@ public:
      * definition. */
     const std::string &extern_function_name() const;
 
+    /** Declare which sites of its inputs an extern stage reads in
+     * order to compute a site of its output, as calls to the input
+     * Funcs (or Buffers or ImageParams) in terms of the pure Vars
+     * given to define_extern. For example, an extern stage that
+     * blurs in x could declare:
+     *
+     \code
+     Func blurred;
+     blurred.define_extern("blur_x", {input}, Float(32), {x, y});
+     blurred.extern_footprint({input(x - 1, y), input(x + 1, y)});
+     \endcode
+     *
+     * Halide then infers the region of each input required for a
+     * given output region itself, and never calls the extern stage
+     * in bounds query mode, so the extern stage does not have to
+     * implement the bounds query protocol. This is what lets
+     * extern stages that only know how to compute the region asked
+     * of them (e.g. a third-party codec) be tiled with split or tile,
+     * computed at the tiles of a consumer, and run in parallel,
+     * with Halide calling them once per tile with the output cropped
+     * to that tile. The footprint may be conservative, but must
+     * cover every site the extern stage reads, and must include at
+     * least one site of each of its inputs. */
+    Func &extern_footprint(const std::vector<Expr> &sites);
+
     /** The dimensionality (number of arguments) of this
      * function. Zero if the function is not yet defined. */
     int dimensions() const;
@@ -1474,7 +1500,18 @@ public:
     /** Mark a dimension to be traversed serially. This is the default. */
     Func &serial(const VarOrRVar &var);
 
-    /** Mark a dimension to be traversed in parallel */
+    /** Mark a dimension to be traversed in parallel. The thread pool
+     * hands out iterations in chunks that start at a single
+     * iteration, grow quickly, and shrink again as the loop drains,
+     * so cheap iterations don't all pay for a trip through the work
+     * queue.
+     *
+     * If two parallel dimensions end up directly nested in the loop
+     * nest, e.g. both tile indices after a call to tile, they are run
+     * as a single 2-D parallel loop. Each thread then works on compact
+     * blocks of neighboring tiles, which share most of their inputs,
+     * rather than on whole rows of tiles as it would with
+     * tile().fuse().parallel(). */
     Func &parallel(const VarOrRVar &var);
 
     /** Split a dimension by the given task_size, and the parallelize the
@@ -1485,6 +1522,15 @@ public:
      * manually. */
     Func &parallel(const VarOrRVar &var, const Expr &task_size, TailStrategy tail = TailStrategy::Auto);
 
+    /** Mark a dimension to be traversed in parallel, and tell the
+     * thread pool to never claim fewer than grain_size iterations at
+     * once (except for whatever is left at the end of the loop).
+     * Claims still shrink as the loop drains, down to grain_size, so
+     * unlike parallel(var, task_size) the load stays balanced when the
+     * cost of an iteration varies. A grain_size of zero restores the
+     * default adaptive behavior. */
+    Func &parallel_grain(const VarOrRVar &var, int grain_size);
+
     /** Mark a dimension to be computed all-at-once as a single
      * vector. The dimension should have constant extent -
      * e.g. because it is the inner dimension following a split by a
@@ -2211,6 +2257,47 @@ public:
      */
     Func &memoize(const EvictionKey &eviction_key = EvictionKey());
 
+    /** Evaluate this Func once, while the pipeline is being compiled,
+     * and embed the result in the compiled pipeline as a constant
+     * buffer, in the same way as a Buffer used directly in a
+     * definition. Calls to this Func become loads from that
+     * buffer. This is useful for lookup tables over small constant
+     * domains (gamma curves, filter coefficients, etc), which would
+     * otherwise be recomputed on every run of the pipeline.
+     *
+     * Every pure dimension of the Func must have a constant bound
+     * set with Func::bound, which defines the region evaluated. The
+     * Func, and everything it calls, must not depend on any Param or
+     * ImageParam, and it may not be an output of the pipeline. It is
+     * evaluated by JIT-compiling it for the host, so if the pipeline
+     * is being cross-compiled, floating-point results are those of
+     * the host. */
+    Func &compute_at_compile_time();
+
+    /** Declare that the extern "C" function vector_name computes
+     * lanes lanes of the pure extern function scalar_name at once, in
+     * the style of "#pragma omp declare simd". The vector variant
+     * takes each argument as a vector of lanes elements of the scalar
+     * argument's type, and returns a vector of lanes elements of the
+     * scalar return type, using the platform's C calling convention
+     * for vector types (e.g. __m128 or float32x4_t for four floats).
+     *
+     * When a call to scalar_name in the pipeline this Func belongs to
+     * is vectorized, Halide calls the widest declared variant that is
+     * no wider than the vector, splitting it into pieces as needed,
+     * instead of extracting each lane and calling the scalar function
+     * once per lane. A variant is only used when compiling for the
+     * given architecture (ArchUnknown means any) and a target with
+     * all of the given features, so several variants for different
+     * instruction sets can be declared for the same function. Only
+     * affects calls of type Call::PureExtern, e.g. those made with
+     * HalidePureExtern_N, on targets that codegen through LLVM. */
+    Func &vector_extern(const std::string &scalar_name,
+                        const std::string &vector_name,
+                        int lanes,
+                        Target::Arch arch = Target::ArchUnknown,
+                        const std::vector<Target::Feature> &features = {});
+
     /** Produce this Func asynchronously in a separate
      * thread. Consumers will be run by the task system when the
      * production is complete. If this Func's store level is different
@@ -2375,6 +2462,42 @@ public:
      * on MemoryType for more detail. */
     Func &store_in(MemoryType memory_type);
 
+    /** Store the elements of this Tuple-valued Func interleaved in a
+     * single allocation (array-of-structs), instead of in a separate
+     * allocation per element (struct-of-arrays), which is the
+     * default. This is a good idea when the elements are always
+     * produced and consumed together, e.g. the real and imaginary
+     * parts of a complex number, or the channels of an RGBA pixel,
+     * because it halves (or better) the number of streams through
+     * memory, and lets vectorized loops use interleaving loads and
+     * stores. All the elements must have the same type.
+     *
+     * Has no effect if this Func is an output of the pipeline, or if
+     * its realization is accessed through a buffer (e.g. by an
+     * extern stage, or when copying it to a GPU). */
+    Func &store_tuple_interleaved();
+
+    /** Declare that the output buffer of this Func may be the same
+     * memory as the given input buffer, so that the pipeline can be
+     * run in place (e.g. by passing the same halide_buffer_t for
+     * both). The Func must be an output of the pipeline, with the
+     * same type and dimensionality as the input.
+     *
+     * If every read of the input happens either in a compute_root
+     * producer of this Func, or in the definition of this Func (or
+     * Funcs inlined into it) at exactly the coordinates being
+     * written, the output is written directly over the input, and
+     * Auto tail strategies are replaced with GuardWithIf so that no
+     * point is read after it has been overwritten. Otherwise (e.g. for
+     * a stencil, or an explicit ShiftInwards tail strategy, which
+     * recomputes points), a staging copy of the input is made first,
+     * with a warning. Extern stages are passed the input itself, so
+     * it's an error if one of them reads it after the output has
+     * started. If the two buffers overlap in memory at all, the
+     * pipeline checks at runtime that they have the same host
+     * pointer, mins and strides. */
+    Func &aliases(const ImageParam &input);
+
     /** Trace all loads from this Func by emitting calls to
      * halide_trace. If the Func is inlined, this has no
      * effect. */
@@ -325,12 +325,13 @@ Stmt ProducerConsumer::make_consume(const std::string &name, Stmt body) {
     return ProducerConsumer::make(name, false, std::move(body));
 }
 
-Stmt For::make(const std::string &name, Expr min, Expr extent, ForType for_type, DeviceAPI device_api, Stmt body) {
+Stmt For::make(const std::string &name, Expr min, Expr extent, ForType for_type, DeviceAPI device_api, Stmt body, int grain_size) {
     internal_assert(min.defined()) << "For of undefined\n";
     internal_assert(extent.defined()) << "For of undefined\n";
     internal_assert(min.type() == Int(32)) << "For with non-integer min\n";
     internal_assert(extent.type() == Int(32)) << "For with non-integer extent\n";
     internal_assert(body.defined()) << "For of undefined\n";
+    internal_assert(grain_size >= 0) << "For with negative grain size\n";
 
     For *node = new For;
     node->name = name;
@@ -339,6 +340,7 @@ Stmt For::make(const std::string &name, Expr min, Expr extent, ForType for_type,
     node->for_type = for_type;
     node->device_api = device_api;
     node->body = std::move(body);
+    node->grain_size = grain_size;
     return node;
 }
 
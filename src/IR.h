@@ -726,7 +726,12 @@ struct For : public StmtNode<For> {
     DeviceAPI device_api;
     Stmt body;
 
-    static Stmt make(const std::string &name, Expr min, Expr extent, ForType for_type, DeviceAPI device_api, Stmt body);
+    /** For parallel loops, the smallest number of iterations the
+     * thread pool should claim at once. Zero means the thread pool
+     * sizes the claims itself. Ignored for other loop types. */
+    int grain_size;
+
+    static Stmt make(const std::string &name, Expr min, Expr extent, ForType for_type, DeviceAPI device_api, Stmt body, int grain_size = 0);
 
     bool is_unordered_parallel() const {
         return Halide::Internal::is_unordered_parallel(for_type);
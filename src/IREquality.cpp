@@ -475,6 +475,7 @@ void IRComparer::visit(const For *op) {
 
     compare_names(s->name, op->name);
     compare_scalar(s->for_type, op->for_type);
+    compare_scalar(s->grain_size, op->grain_size);
     compare_expr(s->min, op->min);
     compare_expr(s->extent, op->extent);
     compare_stmt(s->body, op->body);
@@ -1,5 +1,8 @@
+#include <algorithm>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <utility>
 
 #include "IREquality.h"
@@ -475,6 +478,73 @@ bool equal_helper(const BaseExprNode &a, const BaseExprNode &b) noexcept {
     return false;
 }
 
+namespace {
+
+// All the rules registered for profiling. Reports on them at exit.
+struct RewriteRuleRegistry {
+    std::mutex mutex;
+    vector<std::unique_ptr<RewriteRuleStats>> rules;
+
+    ~RewriteRuleRegistry() {
+        if (!rules.empty()) {
+            print_rewrite_rule_stats(std::cerr);
+        }
+    }
+};
+
+RewriteRuleRegistry &rewrite_rule_registry() {
+    static RewriteRuleRegistry registry;
+    return registry;
+}
+
+}  // namespace
+
+RewriteRuleStats *register_rewrite_rule(const std::string &rule) {
+    RewriteRuleRegistry &registry = rewrite_rule_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.rules.emplace_back(new RewriteRuleStats);
+    registry.rules.back()->rule = rule;
+    return registry.rules.back().get();
+}
+
+void print_rewrite_rule_stats(std::ostream &s) {
+    RewriteRuleRegistry &registry = rewrite_rule_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    vector<const RewriteRuleStats *> sorted;
+    uint64_t attempts = 0, early_rejects = 0, matches = 0, nanoseconds = 0;
+    for (const auto &r : registry.rules) {
+        sorted.push_back(r.get());
+        attempts += r->attempts;
+        early_rejects += r->early_rejects;
+        matches += r->matches;
+        nanoseconds += r->nanoseconds;
+    }
+    if (sorted.empty()) {
+        return;
+    }
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const RewriteRuleStats *a, const RewriteRuleStats *b) {
+                         return a->nanoseconds.load() > b->nanoseconds.load();
+                     });
+    s << "Rewrite rule profile: "
+      << sorted.size() << " rules, "
+      << attempts << " attempts, "
+      << early_rejects << " rejected early, "
+      << matches << " matches, "
+      << nanoseconds / 1000000 << " ms\n"
+      << "attempts early_rejects matches microseconds rule\n";
+    for (const RewriteRuleStats *r : sorted) {
+        if (r->attempts.load() == 0) {
+            continue;
+        }
+        s << r->attempts << " "
+          << r->early_rejects << " "
+          << r->matches << " "
+          << r->nanoseconds.load() / 1000 << " "
+          << r->rule << "\n";
+    }
+}
+
 }  // namespace IRMatcher
 }  // namespace Internal
 }  // namespace Halide
@@ -5,9 +5,13 @@
  * Defines a method to match a fragment of IR against a pattern containing wildcards
  */
 
+#include <atomic>
+#include <chrono>
 #include <map>
 #include <random>
 #include <set>
+#include <sstream>
+#include <string>
 #include <vector>
 
 #include "IR.h"
@@ -2326,6 +2330,187 @@ std::ostream &operator<<(std::ostream &s, const IsScalar<A> &op) {
     return s;
 }
 
+// The set of IR node types that the root of a pattern could possibly
+// match, as a bitmask indexed by IRNodeType. This differs from the
+// [min_node_type, max_node_type] range above, which exists for
+// canonicalization: e.g. constant wildcards also match broadcasts of
+// constants. Patterns not listed here are assumed to match anything.
+constexpr uint32_t node_type_bit(IRNodeType t) {
+    return (uint32_t)1 << (int)t;
+}
+
+template<typename T>
+struct pattern_node_types {
+    constexpr static uint32_t mask = ~(uint32_t)0;
+};
+
+template<int i>
+struct pattern_node_types<WildConstInt<i>> {
+    constexpr static uint32_t mask = node_type_bit(IRNodeType::IntImm) | node_type_bit(IRNodeType::Broadcast);
+};
+
+template<int i>
+struct pattern_node_types<WildConstUInt<i>> {
+    constexpr static uint32_t mask = node_type_bit(IRNodeType::UIntImm) | node_type_bit(IRNodeType::Broadcast);
+};
+
+template<int i>
+struct pattern_node_types<WildConstFloat<i>> {
+    constexpr static uint32_t mask = node_type_bit(IRNodeType::FloatImm) | node_type_bit(IRNodeType::Broadcast);
+};
+
+template<int i>
+struct pattern_node_types<WildConst<i>> {
+    constexpr static uint32_t mask = (node_type_bit(IRNodeType::IntImm) |
+                                      node_type_bit(IRNodeType::UIntImm) |
+                                      node_type_bit(IRNodeType::FloatImm) |
+                                      node_type_bit(IRNodeType::Broadcast));
+};
+
+template<>
+struct pattern_node_types<IntLiteral> {
+    constexpr static uint32_t mask = (node_type_bit(IRNodeType::IntImm) |
+                                      node_type_bit(IRNodeType::UIntImm) |
+                                      node_type_bit(IRNodeType::FloatImm) |
+                                      node_type_bit(IRNodeType::Broadcast));
+};
+
+template<typename Op, typename A, typename B>
+struct pattern_node_types<BinOp<Op, A, B>> {
+    constexpr static uint32_t mask = node_type_bit(Op::_node_type);
+};
+
+template<typename Op, typename A, typename B>
+struct pattern_node_types<CmpOp<Op, A, B>> {
+    constexpr static uint32_t mask = node_type_bit(Op::_node_type);
+};
+
+template<typename... Args>
+struct pattern_node_types<Intrin<Args...>> {
+    constexpr static uint32_t mask = node_type_bit(IRNodeType::Call);
+};
+
+template<typename A>
+struct pattern_node_types<NotOp<A>> {
+    constexpr static uint32_t mask = node_type_bit(IRNodeType::Not);
+};
+
+template<typename C, typename T, typename F>
+struct pattern_node_types<SelectOp<C, T, F>> {
+    constexpr static uint32_t mask = node_type_bit(IRNodeType::Select);
+};
+
+template<typename A, typename B>
+struct pattern_node_types<BroadcastOp<A, B>> {
+    constexpr static uint32_t mask = node_type_bit(IRNodeType::Broadcast);
+};
+
+template<typename A, typename B, typename C>
+struct pattern_node_types<RampOp<A, B, C>> {
+    constexpr static uint32_t mask = node_type_bit(IRNodeType::Ramp);
+};
+
+template<typename A, typename B, VectorReduce::Operator reduce_op>
+struct pattern_node_types<VectorReduceOp<A, B, reduce_op>> {
+    constexpr static uint32_t mask = node_type_bit(IRNodeType::VectorReduce);
+};
+
+template<typename A>
+struct pattern_node_types<NegateOp<A>> {
+    constexpr static uint32_t mask = node_type_bit(IRNodeType::Sub);
+};
+
+template<typename A>
+struct pattern_node_types<CastOp<A>> {
+    constexpr static uint32_t mask = node_type_bit(IRNodeType::Cast);
+};
+
+template<>
+struct pattern_node_types<Overflow> {
+    constexpr static uint32_t mask = node_type_bit(IRNodeType::Call);
+};
+
+template<typename Pattern>
+HALIDE_ALWAYS_INLINE bool may_match_node(const BaseExprNode &e) noexcept {
+    return (pattern_node_types<Pattern>::mask & node_type_bit(e.node_type)) != 0;
+}
+
+// A cheap test of whether the LHS of a rule could possibly match an
+// instance, by looking only at the node types of the instance and its
+// immediate operands. Rewriters for the common instances (a binary
+// operator, comparison, or select of concrete Exprs, or a single
+// Expr) use this to skip most rules with a couple of bit tests,
+// before walking any deeper into the pattern. Returns true if it
+// can't tell.
+template<typename Before, typename Instance>
+HALIDE_ALWAYS_INLINE bool may_match(const Before &, const Instance &) noexcept {
+    return true;
+}
+
+template<typename Before>
+HALIDE_ALWAYS_INLINE bool may_match(const Before &, const SpecificExpr &instance) noexcept {
+    return may_match_node<Before>(*instance.expr.get());
+}
+
+template<typename Op, typename A, typename B, typename Op2>
+HALIDE_ALWAYS_INLINE bool may_match(const BinOp<Op, A, B> &, const BinOp<Op2, SpecificExpr, SpecificExpr> &instance) noexcept {
+    return (std::is_same<Op, Op2>::value &&
+            may_match_node<A>(*instance.a.expr.get()) &&
+            may_match_node<B>(*instance.b.expr.get()));
+}
+
+template<typename Op, typename A, typename B, typename Op2>
+HALIDE_ALWAYS_INLINE bool may_match(const CmpOp<Op, A, B> &, const CmpOp<Op2, SpecificExpr, SpecificExpr> &instance) noexcept {
+    return (std::is_same<Op, Op2>::value &&
+            may_match_node<A>(*instance.a.expr.get()) &&
+            may_match_node<B>(*instance.b.expr.get()));
+}
+
+template<typename C, typename T, typename F>
+HALIDE_ALWAYS_INLINE bool may_match(const SelectOp<C, T, F> &, const SelectOp<SpecificExpr, SpecificExpr, SpecificExpr> &instance) noexcept {
+    return (may_match_node<C>(*instance.c.expr.get()) &&
+            may_match_node<T>(*instance.t.expr.get()) &&
+            may_match_node<F>(*instance.f.expr.get()));
+}
+
+/** Counters for a single rewrite rule, gathered when the compiler is
+ * built with HALIDE_PROFILE_REWRITE_RULES. Rules whose patterns
+ * differ only in literal constants or intrinsic ops share a set of
+ * counters, and are named after the first one that fired. */
+struct RewriteRuleStats {
+    std::string rule;
+    // The number of times the rule was tried, the number of those
+    // that were rejected by may_match without walking the pattern,
+    // and the number that matched.
+    std::atomic<uint64_t> attempts{0}, early_rejects{0}, matches{0};
+    // Total time spent trying the rule.
+    std::atomic<uint64_t> nanoseconds{0};
+};
+
+/** Register a rule to be profiled. The result lives until exit, at
+ * which point all the registered rules are reported to stderr, sorted
+ * by time spent. */
+RewriteRuleStats *register_rewrite_rule(const std::string &rule);
+
+/** Print the per-rule counters gathered so far, sorted by time
+ * spent. Prints nothing unless the compiler was built with
+ * HALIDE_PROFILE_REWRITE_RULES. */
+void print_rewrite_rule_stats(std::ostream &s);
+
+template<typename Before, typename After, typename Predicate>
+HALIDE_NEVER_INLINE std::string describe_rule(const Before &before, const After &after, const Predicate &pred) {
+    std::ostringstream s;
+    s << before << " -> " << after << " if " << pred;
+    return s.str();
+}
+
+template<typename Before, typename After>
+HALIDE_NEVER_INLINE std::string describe_rule(const Before &before, const After &after, bool) {
+    std::ostringstream s;
+    s << before << " -> " << after;
+    return s.str();
+}
+
 // Verify properties of each rewrite rule. Currently just fuzz tests them.
 template<typename Before,
          typename After,
@@ -2489,6 +2674,15 @@ HALIDE_ALWAYS_INLINE bool evaluate_predicate(Pattern p, MatcherState &state) {
 // correctness_simplify with this on.
 #define HALIDE_FUZZ_TEST_RULES 0
 
+// Set to true (e.g. with -DHALIDE_PROFILE_REWRITE_RULES=1) to count
+// how many times each rewrite rule is tried and how many times it
+// matches, and how long is spent trying it. The counts are printed to
+// stderr at exit. Useful for finding which rules are worth reordering
+// or guarding. Note that the timing adds overhead to every rule.
+#ifndef HALIDE_PROFILE_REWRITE_RULES
+#define HALIDE_PROFILE_REWRITE_RULES 0
+#endif
+
 template<typename Instance>
 struct Rewriter {
     Instance instance;
@@ -2507,6 +2701,28 @@ struct Rewriter {
         result = after.make(state, output_type);
     }
 
+    // Try to match the LHS of a rule, and then its predicate.
+    template<typename Before, typename After, typename Predicate>
+    HALIDE_ALWAYS_INLINE bool match_rule(const Before &before, const After &after, const Predicate &pred) {
+#if HALIDE_PROFILE_REWRITE_RULES
+        static RewriteRuleStats *stats = register_rewrite_rule(describe_rule(before, after, pred));
+        auto start = std::chrono::steady_clock::now();
+        stats->attempts++;
+        bool possible = may_match(before, instance);
+        bool matched = (possible &&
+                        before.template match<0>(unwrap(instance), state) &&
+                        evaluate_predicate(pred, state));
+        stats->early_rejects += !possible;
+        stats->matches += matched;
+        stats->nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        return matched;
+#else
+        return (may_match(before, instance) &&
+                before.template match<0>(unwrap(instance), state) &&
+                evaluate_predicate(pred, state));
+#endif
+    }
+
     template<typename Before,
              typename After,
              typename = typename enable_if_pattern<Before>::type,
@@ -2518,7 +2734,7 @@ struct Rewriter {
 #if HALIDE_FUZZ_TEST_RULES
         fuzz_test_rule(before, after, true, wildcard_type, output_type);
 #endif
-        if (before.template match<0>(unwrap(instance), state)) {
+        if (match_rule(before, after, true)) {
 #if HALIDE_DEBUG_MATCHED_RULES
             debug(0) << instance << " -> " << result << " via " << before << " -> " << after << "\n";
 #endif
@@ -2536,7 +2752,7 @@ struct Rewriter {
              typename = typename enable_if_pattern<Before>::type>
     HALIDE_ALWAYS_INLINE bool operator()(Before before, const Expr &after) noexcept {
         static_assert(Before::canonical, "LHS of rewrite rule should be in canonical form");
-        if (before.template match<0>(unwrap(instance), state)) {
+        if (match_rule(before, after, true)) {
             result = after;
 #if HALIDE_DEBUG_MATCHED_RULES
             debug(0) << instance << " -> " << result << " via " << before << " -> " << after << "\n";
@@ -2557,7 +2773,7 @@ struct Rewriter {
 #if HALIDE_FUZZ_TEST_RULES
         fuzz_test_rule(before, IntLiteral(after), true, wildcard_type, output_type);
 #endif
-        if (before.template match<0>(unwrap(instance), state)) {
+        if (match_rule(before, after, true)) {
             result = make_const(output_type, after);
 #if HALIDE_DEBUG_MATCHED_RULES
             debug(0) << instance << " -> " << result << " via " << before << " -> " << after << "\n";
@@ -2587,8 +2803,7 @@ struct Rewriter {
 #if HALIDE_FUZZ_TEST_RULES
         fuzz_test_rule(before, after, pred, wildcard_type, output_type);
 #endif
-        if (before.template match<0>(unwrap(instance), state) &&
-            evaluate_predicate(pred, state)) {
+        if (match_rule(before, after, pred)) {
 #if HALIDE_DEBUG_MATCHED_RULES
             debug(0) << instance << " -> " << result << " via " << before << " -> " << after << " when " << pred << "\n";
 #endif
@@ -2610,8 +2825,7 @@ struct Rewriter {
         static_assert(Predicate::foldable, "Predicates must consist only of operations that can constant-fold");
         static_assert(Before::canonical, "LHS of rewrite rule should be in canonical form");
 
-        if (before.template match<0>(unwrap(instance), state) &&
-            evaluate_predicate(pred, state)) {
+        if (match_rule(before, after, pred)) {
             result = after;
 #if HALIDE_DEBUG_MATCHED_RULES
             debug(0) << instance << " -> " << result << " via " << before << " -> " << after << " when " << pred << "\n";
@@ -2635,8 +2849,7 @@ struct Rewriter {
 #if HALIDE_FUZZ_TEST_RULES
         fuzz_test_rule(before, IntLiteral(after), pred, wildcard_type, output_type);
 #endif
-        if (before.template match<0>(unwrap(instance), state) &&
-            evaluate_predicate(pred, state)) {
+        if (match_rule(before, after, pred)) {
             result = make_const(output_type, after);
 #if HALIDE_DEBUG_MATCHED_RULES
             debug(0) << instance << " -> " << result << " via " << before << " -> " << after << " when " << pred << "\n";
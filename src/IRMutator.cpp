@@ -214,7 +214,7 @@ Stmt IRMutator::visit(const For *op) {
         return op;
     }
     return For::make(op->name, std::move(min), std::move(extent),
-                     op->for_type, op->device_api, std::move(body));
+                     op->for_type, op->device_api, std::move(body), op->grain_size);
 }
 
 Stmt IRMutator::visit(const Store *op) {
@@ -726,7 +726,11 @@ void IRPrinter::visit(const For *op) {
     print_no_parens(op->min);
     stream << ", ";
     print_no_parens(op->extent);
-    stream << ") {\n";
+    stream << ")";
+    if (op->grain_size > 0) {
+        stream << " grain_size(" << op->grain_size << ")";
+    }
+    stream << " {\n";
 
     indent++;
     print(op->body);
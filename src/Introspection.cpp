@@ -8,7 +8,9 @@
 #include "Util.h"
 
 #include <cstdio>
+#include <deque>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <string>
 
@@ -17,6 +19,12 @@
 
 #include <regex>
 
+#ifdef __APPLE__
+#include <mach-o/dyld.h>
+#else
+#include <link.h>
+#endif
+
 using std::map;
 using std::pair;
 using std::vector;
@@ -40,6 +48,27 @@ void get_program_name(char *name, int32_t size) {
 }
 #endif
 
+// The offset the dynamic loader applied to the addresses in the main
+// binary. This is our first guess at the offset between the addresses
+// in the debug info and the actual code, which tells us which
+// compilation unit to parse to calibrate it properly.
+uint64_t get_load_bias() {
+#ifdef __APPLE__
+    return (uint64_t)_dyld_get_image_vmaddr_slide(0);
+#else
+    struct Callback {
+        static int first_object(struct dl_phdr_info *info, size_t, void *data) {
+            // The first object reported is the main program.
+            *(uint64_t *)data = (uint64_t)info->dlpi_addr;
+            return 1;
+        }
+    };
+    uint64_t bias = 0;
+    dl_iterate_phdr(Callback::first_object, &bias);
+    return bias;
+#endif
+}
+
 namespace {
 
 template<typename T>
@@ -178,7 +207,45 @@ class DebugSections {
 
         TypeInfo() = default;
     };
-    vector<TypeInfo> types;
+    // A deque, so that pointers to types stay valid as more
+    // compilation units get parsed.
+    std::deque<TypeInfo> types;
+    std::map<uint64_t, TypeInfo *> type_map;
+
+    // The binary and its debug sections. The binary is memory-mapped
+    // and kept open, so that only the parts of the debug info we
+    // actually parse get paged in.
+    llvm::object::OwningBinary<llvm::object::ObjectFile> object_file;
+    llvm::StringRef debug_info, debug_abbrev, debug_str, debug_line, debug_ranges;
+    uint8_t bytes_in_address = 8;
+
+    // The compilation units in debug_info, and where their line
+    // number programs are in debug_line. Units are parsed on demand.
+    struct CompilationUnit {
+        uint64_t info_offset = 0, line_offset = 0;
+        bool has_line_program = false, parsed = false;
+    };
+    vector<CompilationUnit> compilation_units;
+    bool parsed_all_units = false;
+
+    // A range of code addresses, as they appear in the debug info,
+    // covered by a compilation unit. Sorted by pc_begin.
+    struct UnitRange {
+        uint64_t pc_begin, pc_end;
+        size_t unit;
+        bool operator<(const UnitRange &other) const {
+            return pc_begin < other.pc_begin;
+        }
+    };
+    vector<UnitRange> unit_ranges;
+
+    // The range of addresses of data sections, as they appear in the
+    // debug info. Global variables can only live in here.
+    uint64_t data_begin = 0, data_end = 0;
+
+    // The offset between addresses in the debug info and addresses in
+    // the running program. Zero until we're calibrated.
+    int64_t pc_adjust = 0;
 
 public:
     bool working;
@@ -200,7 +267,7 @@ public:
 
         debug(5) << "Loading " << binary_path << "\n";
 
-        load_and_parse_object_file(binary_path);
+        load_object_file(binary_path);
     }
 
     int count_trailing_zeros(int64_t x) {
@@ -212,13 +279,11 @@ public:
         return 64;
     }
 
-    void calibrate_pc_offset(void (*fn)()) {
-        // Calibrate for the offset between the instruction pointers
-        // in the debug info and the instruction pointers in the
-        // actual file.
+    // Look for the offset marker among the functions parsed so far. If
+    // we're already calibrated, there should be one at the expected
+    // address. Otherwise, find the adjustment that makes one match.
+    bool find_offset_marker(uint64_t pc_real, int64_t *adjust) {
         bool found = false;
-        uint64_t pc_real = (uint64_t)fn;
-        int64_t pc_adjust = 0;
         for (size_t i = 0; i < functions.size(); i++) {
             if (functions[i].name == "HalideIntrospectionCanary::offset_marker" &&
                 functions[i].pc_begin) {
@@ -228,7 +293,7 @@ public:
                 if (calibrated) {
                     // If we're already calibrated, we should find a function with a matching pc
                     if (pc_debug == pc_real) {
-                        return;
+                        return true;
                     }
                 } else {
                     int64_t pc_adj = pc_real - pc_debug;
@@ -240,13 +305,33 @@ public:
 
                     // If we find multiple matches, pick the one with more trailing zeros
                     if (!found ||
-                        count_trailing_zeros(pc_adj) > count_trailing_zeros(pc_adjust)) {
-                        pc_adjust = pc_adj;
+                        count_trailing_zeros(pc_adj) > count_trailing_zeros(*adjust)) {
+                        *adjust = pc_adj;
                         found = true;
                     }
                 }
             }
         }
+        return found;
+    }
+
+    void calibrate_pc_offset(void (*fn)()) {
+        // Calibrate for the offset between the instruction pointers
+        // in the debug info and the instruction pointers in the
+        // actual file.
+        uint64_t pc_real = (uint64_t)fn;
+
+        // Parse the compilation unit containing the marker. Until
+        // we're calibrated, guess where it is using the load bias of
+        // the binary. If that doesn't find it, parse everything.
+        parse_units_at(pc_real - (calibrated ? pc_adjust : get_load_bias()));
+        int64_t adjust = 0;
+        bool found = find_offset_marker(pc_real, &adjust);
+        if (!found && !parsed_all_units) {
+            debug(5) << "Offset marker not found at the expected address. Parsing all compilation units.\n";
+            parse_all_units();
+            found = find_offset_marker(pc_real, &adjust);
+        }
 
         if (!found) {
             if (!calibrated) {
@@ -258,33 +343,53 @@ public:
             return;
         }
 
-        debug(5) << "Program counter adjustment between debug info and actual code: " << pc_adjust << "\n";
+        if (calibrated) {
+            return;
+        }
+
+        debug(5) << "Program counter adjustment between debug info and actual code: " << adjust << "\n";
 
-        for (size_t i = 0; i < functions.size(); i++) {
+        shift_pcs(0, 0, 0, adjust);
+        pc_adjust = adjust;
+        calibrated = true;
+    }
+
+    // Move the functions, global variables, and source lines from the
+    // given indices onwards by the given offset.
+    void shift_pcs(size_t first_function, size_t first_global, size_t first_line, int64_t adjust) {
+        for (size_t i = first_function; i < functions.size(); i++) {
             FunctionInfo &f = functions[i];
-            f.pc_begin += pc_adjust;
-            f.pc_end += pc_adjust;
+            f.pc_begin += adjust;
+            f.pc_end += adjust;
             for (size_t j = 0; j < f.variables.size(); j++) {
                 LocalVariable &v = f.variables[j];
                 for (size_t k = 0; k < v.live_ranges.size(); k++) {
-                    v.live_ranges[k].pc_begin += pc_adjust;
-                    v.live_ranges[k].pc_end += pc_adjust;
+                    v.live_ranges[k].pc_begin += adjust;
+                    v.live_ranges[k].pc_end += adjust;
                 }
             }
         }
 
-        for (size_t i = 0; i < source_lines.size(); i++) {
-            source_lines[i].pc += pc_adjust;
+        for (size_t i = first_line; i < source_lines.size(); i++) {
+            source_lines[i].pc += adjust;
         }
 
-        for (size_t i = 0; i < global_variables.size(); i++) {
-            global_variables[i].addr += pc_adjust;
+        for (size_t i = first_global; i < global_variables.size(); i++) {
+            global_variables[i].addr += adjust;
         }
-
-        calibrated = true;
     }
 
     int find_global_variable(const void *global_pointer) {
+        // Globals could be in any compilation unit, so we have to parse
+        // them all, but first check the address could be a global at all.
+        uint64_t debug_address = (uint64_t)global_pointer - pc_adjust;
+        if (data_begin < data_end &&
+            (debug_address < data_begin || debug_address >= data_end)) {
+            debug(5) << "Not considering " << global_pointer << " as a global because it's outside the data sections\n";
+            return -1;
+        }
+        parse_all_units();
+
         if (global_variables.empty()) {
             debug(5) << "Considering possible global at " << global_pointer << " but global_variables is empty\n";
             return -1;
@@ -734,11 +839,6 @@ public:
     std::string get_source_location() {
         debug(5) << "Finding source location\n";
 
-        if (source_lines.empty()) {
-            debug(5) << "Bailing out because we have no source lines\n";
-            return "";
-        }
-
         const int max_stack_frames = 256;
 
         // Get the backtrace
@@ -792,6 +892,11 @@ public:
                 continue;
             }
 
+            if (source_lines.empty()) {
+                debug(5) << "Skipping function because we have no source lines\n";
+                continue;
+            }
+
             // Binary search into source_lines
             size_t hi = source_lines.size();
             size_t lo = 0;
@@ -821,6 +926,8 @@ public:
     }
 
     void dump() {
+        parse_all_units();
+
         // Dump all the types
         for (size_t i = 0; i < types.size(); i++) {
             printf("Class %s of size %llu @ %llx: \n",
@@ -914,7 +1021,7 @@ public:
     }
 
 private:
-    void load_and_parse_object_file(const std::string &binary) {
+    void load_object_file(const std::string &binary) {
         llvm::object::ObjectFile *obj = nullptr;
 
         // Open the object file in question.
@@ -927,21 +1034,20 @@ private:
             return;
         }
 
-        obj = maybe_obj.get().getBinary();
+        object_file = std::move(maybe_obj.get());
+        obj = object_file.getBinary();
 
         if (obj) {
             working = true;
-            parse_object_file(obj);
+            index_object_file(obj);
         } else {
             debug(1) << "Could not load object file: " << binary << "\n";
             working = false;
         }
     }
 
-    void parse_object_file(llvm::object::ObjectFile *obj) {
+    void index_object_file(llvm::object::ObjectFile *obj) {
         // Look for the debug_info, debug_abbrev, debug_line, and debug_str sections
-        llvm::StringRef debug_info, debug_abbrev, debug_str, debug_line, debug_ranges;
-
 #ifdef __APPLE__
         std::string prefix = "__";
 #else
@@ -955,6 +1061,16 @@ private:
             llvm::StringRef name = expected_name.get();
             debug(2) << "Section: " << name.str() << "\n";
             // ignore errors, just leave strings empty
+            if ((iter->isData() || iter->isBSS()) && iter->getSize()) {
+                uint64_t begin = iter->getAddress(), end = begin + iter->getSize();
+                if (data_begin == data_end) {
+                    data_begin = begin;
+                    data_end = end;
+                } else {
+                    data_begin = std::min(data_begin, begin);
+                    data_end = std::max(data_end, end);
+                }
+            }
             auto e = iter->getContents();
             if (e) {
                 if (name == prefix + "debug_info") {
@@ -981,19 +1097,181 @@ private:
             return;
         }
 
-        {
-            // Parse the debug_info section to populate the functions and local variables
-            llvm::DataExtractor extractor(debug_info, true, obj->getBytesInAddress());
-            llvm::DataExtractor debug_abbrev_extractor(debug_abbrev, true, obj->getBytesInAddress());
-            parse_debug_info(extractor, debug_abbrev_extractor, debug_str, debug_ranges);
+        bytes_in_address = obj->getBytesInAddress();
+        index_compilation_units();
+    }
+
+    // Find the compilation units in debug_info and the ranges of
+    // addresses each one covers. Only the unit headers and the
+    // compile_unit entries at their roots are read.
+    void index_compilation_units() {
+        llvm::DataExtractor e(debug_info, true, bytes_in_address);
+        llvm::DataExtractor debug_abbrev_extractor(debug_abbrev, true, bytes_in_address);
+
+        const unsigned attr_stmt_list = 0x10;
+        const unsigned attr_low_pc = 0x11;
+        const unsigned attr_high_pc = 0x12;
+        const unsigned attr_ranges = 0x55;
+
+        llvm_offset_t off = 0;
+        while (off < debug_info.size()) {
+            uint64_t start_of_unit_header = off;
+
+            // Parse compilation unit header
+            bool dwarf_64;
+            uint64_t unit_length = e.getU32(&off);
+            if (unit_length == 0xffffffff) {
+                dwarf_64 = true;
+                unit_length = e.getU64(&off);
+            } else {
+                dwarf_64 = false;
+            }
+
+            if (!unit_length) {
+                break;
+            }
+
+            uint64_t end_of_unit = off + unit_length;
+
+            uint16_t dwarf_version = e.getU16(&off);
+
+            uint64_t debug_abbrev_offset = 0;
+            if (dwarf_64) {
+                debug_abbrev_offset = e.getU64(&off);
+            } else {
+                debug_abbrev_offset = e.getU32(&off);
+            }
+            parse_debug_abbrev(debug_abbrev_extractor, debug_abbrev_offset);
+
+            uint8_t address_size = e.getU8(&off);
+
+            CompilationUnit unit;
+            unit.info_offset = start_of_unit_header;
+            size_t unit_index = compilation_units.size();
+
+            // The first entry describes the compilation unit itself
+            uint64_t abbrev_code = e.getULEB128(&off);
+            if (abbrev_code > 0 && abbrev_code <= entry_formats.size()) {
+                const EntryFormat &fmt = entry_formats[abbrev_code - 1];
+                uint64_t low_pc = 0, high_pc = 0, ranges = 0;
+                bool has_high_pc = false, has_ranges = false, high_pc_is_size = false;
+                for (size_t i = 0; i < fmt.fields.size(); i++) {
+                    uint64_t val = 0;
+                    const uint8_t *payload = nullptr;
+                    read_attribute(e, &off, fmt.fields[i].form, dwarf_64, dwarf_version,
+                                   address_size, start_of_unit_header, val, payload);
+                    unsigned attr = fmt.fields[i].name;
+                    if (attr == attr_low_pc) {
+                        low_pc = val;
+                    } else if (attr == attr_high_pc) {
+                        high_pc = val;
+                        has_high_pc = true;
+                        high_pc_is_size = (fmt.fields[i].form != 0x1);
+                    } else if (attr == attr_ranges) {
+                        ranges = val;
+                        has_ranges = true;
+                    } else if (attr == attr_stmt_list) {
+                        unit.line_offset = val;
+                        unit.has_line_program = true;
+                    }
+                }
+
+                if (has_high_pc) {
+                    uint64_t pc_end = high_pc_is_size ? low_pc + high_pc : high_pc;
+                    if (low_pc < pc_end) {
+                        unit_ranges.push_back({low_pc, pc_end, unit_index});
+                    }
+                } else if (has_ranges && ranges < debug_ranges.size()) {
+                    // Pairs of offsets from the base address, terminated
+                    // by a pair of zeros. A pair starting with the max
+                    // address instead sets a new base address.
+                    llvm::DataExtractor r(debug_ranges, true, address_size);
+                    const uint64_t max_address = (address_size == 4) ? 0xffffffffULL : ~0ULL;
+                    uint64_t base = low_pc;
+                    llvm_offset_t r_off = ranges;
+                    while (r_off + 2 * address_size <= debug_ranges.size()) {
+                        uint64_t begin = r.getAddress(&r_off);
+                        uint64_t end = r.getAddress(&r_off);
+                        if (!begin && !end) {
+                            break;
+                        } else if (begin == max_address) {
+                            base = end;
+                        } else if (begin < end) {
+                            unit_ranges.push_back({base + begin, base + end, unit_index});
+                        }
+                    }
+                }
+            }
+
+            compilation_units.push_back(unit);
+            off = end_of_unit;
         }
 
-        {
-            llvm::DataExtractor e(debug_line, true, obj->getBytesInAddress());
-            parse_debug_line(e);
+        std::sort(unit_ranges.begin(), unit_ranges.end());
+
+        debug(2) << "Indexed " << compilation_units.size() << " compilation units covering "
+                 << unit_ranges.size() << " address ranges\n";
+    }
+
+    // Make sure the compilation unit covering the given code address,
+    // as it appears in the debug info, has been parsed.
+    void parse_units_at(uint64_t address) {
+        if (parsed_all_units) {
+            return;
+        }
+        if (unit_ranges.empty()) {
+            // There's no index to go by.
+            parse_all_units();
+            return;
+        }
+        UnitRange key = {address, address, 0};
+        auto it = std::upper_bound(unit_ranges.begin(), unit_ranges.end(), key);
+        if (it == unit_ranges.begin()) {
+            return;
+        }
+        --it;
+        if (address < it->pc_end) {
+            parse_units({it->unit});
         }
     }
 
+    void parse_all_units() {
+        if (parsed_all_units) {
+            return;
+        }
+        vector<size_t> units;
+        for (size_t i = 0; i < compilation_units.size(); i++) {
+            units.push_back(i);
+        }
+        parse_units(units);
+        parsed_all_units = true;
+    }
+
+    void parse_units(const vector<size_t> &units) {
+        vector<uint64_t> info_offsets, line_offsets;
+        for (size_t i : units) {
+            CompilationUnit &unit = compilation_units[i];
+            if (unit.parsed) {
+                continue;
+            }
+            unit.parsed = true;
+            info_offsets.push_back(unit.info_offset);
+            if (unit.has_line_program && unit.line_offset < debug_line.size()) {
+                line_offsets.push_back(unit.line_offset);
+            }
+        }
+
+        if (info_offsets.empty()) {
+            return;
+        }
+
+        debug(5) << "Parsing " << info_offsets.size() << " compilation units\n";
+
+        // Parse the debug_info section to populate the functions and local variables
+        parse_debug_info(info_offsets);
+        parse_debug_line(line_offsets);
+    }
+
     void parse_debug_ranges(const llvm::DataExtractor &e) {
     }
 
@@ -1028,20 +1306,206 @@ private:
         }
     }
 
-    void parse_debug_info(const llvm::DataExtractor &e,
-                          const llvm::DataExtractor &debug_abbrev,
-                          llvm::StringRef debug_str,
-                          llvm::StringRef debug_ranges) {
-        // Offset into the section
-        llvm_offset_t off = 0;
+    // Read the value of an attribute of the given form. It's either a
+    // constant, returned in val, or a variable length payload, in
+    // which case val is its size (or zero for a null-terminated
+    // string).
+    void read_attribute(const llvm::DataExtractor &e, llvm_offset_t *off_ptr, uint64_t form,
+                        bool dwarf_64, uint16_t dwarf_version, uint8_t address_size,
+                        uint64_t start_of_unit_header, uint64_t &val, const uint8_t *&payload) {
+        llvm_offset_t &off = *off_ptr;
+        switch (form) {
+        case 1:  // addr (4 or 8 bytes)
+        {
+            if (address_size == 4) {
+                val = e.getU32(&off);
+            } else {
+                val = e.getU64(&off);
+            }
+            break;
+        }
+        case 2:  // There is no case 2
+        {
+            internal_error << "What's form 2?";
+            break;
+        }
+        case 3:  // block2 (2 byte length followed by payload)
+        {
+            val = e.getU16(&off);
+            payload = (const uint8_t *)(debug_info.data() + off);
+            off += val;
+            break;
+        }
+        case 4:  // block4 (4 byte length followed by payload)
+        {
+            val = e.getU32(&off);
+            payload = (const uint8_t *)(debug_info.data() + off);
+            off += val;
+            break;
+        }
+        case 5:  // data2 (2 bytes)
+        {
+            val = e.getU16(&off);
+            break;
+        }
+        case 6:  // data4 (4 bytes)
+        {
+            val = e.getU32(&off);
+            break;
+        }
+        case 7:  // data8 (8 bytes)
+        {
+            val = e.getU64(&off);
+            break;
+        }
+        case 8:  // string (null terminated sequence of bytes)
+        {
+            val = 0;
+            payload = (const uint8_t *)(debug_info.data() + off);
+            while (e.getU8(&off)) {
+            }
+            break;
+        }
+        case 9:  // block (uleb128 length followed by payload)
+        {
+            val = e.getULEB128(&off);
+            payload = (const uint8_t *)(debug_info.data() + off);
+            off += val;
+            break;
+        }
+        case 10:  // block1 (1 byte length followed by payload)
+        {
+            val = e.getU8(&off);
+            payload = (const uint8_t *)(debug_info.data() + off);
+            off += val;
+            break;
+        }
+        case 11:  // data1 (1 byte)
+        {
+            val = e.getU8(&off);
+            break;
+        }
+        case 12:  // flag (1 byte)
+        {
+            val = e.getU8(&off);
+            break;
+        }
+        case 13:  // sdata (sleb128 constant)
+        {
+            val = (uint64_t)e.getSLEB128(&off);
+            break;
+        }
+        case 14:  // strp (offset into debug_str section. 4 bytes in dwarf 32, 8 in dwarf 64)
+        {
+            uint64_t offset;
+            if (dwarf_64) {
+                offset = e.getU64(&off);
+            } else {
+                offset = e.getU32(&off);
+            }
+            val = 0;
+            payload = (const uint8_t *)(debug_str.data() + offset);
+            break;
+        }
+        case 15:  // udata (uleb128 constant)
+        {
+            val = e.getULEB128(&off);
+            break;
+        }
+        case 16:  // ref_addr (offset from beginning of debug_info. 4 bytes in dwarf 32, 8 in dwarf 64)
+        {
+            if ((dwarf_version <= 2 && address_size == 8) ||
+                (dwarf_version > 2 && dwarf_64)) {
+                val = e.getU64(&off);
+            } else {
+                val = e.getU32(&off);
+            }
+            break;
+        }
+        case 17:  // ref1 (1 byte offset from the first byte of the compilation unit header)
+        {
+            val = e.getU8(&off) + start_of_unit_header;
+            break;
+        }
+        case 18:  // ref2 (2 byte version of the same)
+        {
+            val = e.getU16(&off) + start_of_unit_header;
+            break;
+        }
+        case 19:  // ref4 (4 byte version of the same)
+        {
+            val = e.getU32(&off) + start_of_unit_header;
+            break;
+        }
+        case 20:  // ref8 (8 byte version of the same)
+        {
+            val = e.getU64(&off) + start_of_unit_header;
+            break;
+        }
+        case 21:  // ref_udata (uleb128 version of the same)
+        {
+            val = e.getULEB128(&off) + start_of_unit_header;
+            break;
+        }
+        case 22:  // indirect
+        {
+            internal_error << "Can't handle indirect form";
+            break;
+        }
+        case 23:  // sec_offset
+        {
+            if (dwarf_64) {
+                val = e.getU64(&off);
+            } else {
+                val = e.getU32(&off);
+            }
+            break;
+        }
+        case 24:  // exprloc
+        {
+            // Length
+            val = e.getULEB128(&off);
+            // Payload (contains a DWARF expression to evaluate (ugh))
+            payload = (const uint8_t *)(debug_info.data() + off);
+            off += val;
+            break;
+        }
+        case 25:  // flag_present
+        {
+            val = 0;
+            // Just the existence of this field is information apparently? There's no data.
+            break;
+        }
+        case 32:  // ref_sig8
+        {
+            // 64-bit type signature for a reference in its own type unit
+            val = e.getU64(&off);
+            break;
+        }
+        default:
+            internal_error << "Unknown form";
+            break;
+        }
+    }
+
+    // Parse the compilation units at the given offsets into debug_info.
+    void parse_debug_info(const vector<uint64_t> &unit_offsets) {
+        llvm::DataExtractor e(debug_info, true, bytes_in_address);
+        llvm::DataExtractor debug_abbrev_extractor(debug_abbrev, true, bytes_in_address);
 
-        llvm::StringRef debug_info = e.getData();
+        // Everything from these indices onwards is new.
+        size_t first_function = functions.size();
+        size_t first_global = global_variables.size();
+        size_t first_type = types.size();
 
         // A constant to use indicating that we don't know the stack
         // offset of a variable.
         const int no_location = 0x80000000;
 
-        while (1) {
+        for (uint64_t unit_offset : unit_offsets) {
+            // Offset into the section
+            llvm_offset_t off = unit_offset;
+
             uint64_t start_of_unit_header = off;
 
             // Parse compilation unit header
@@ -1070,7 +1534,7 @@ private:
             } else {
                 debug_abbrev_offset = e.getU32(&off);
             }
-            parse_debug_abbrev(debug_abbrev, debug_abbrev_offset);
+            parse_debug_abbrev(debug_abbrev_extractor, debug_abbrev_offset);
 
             uint8_t address_size = e.getU8(&off);
 
@@ -1191,178 +1655,8 @@ private:
                     // payload size. If val is zero the payload is a
                     // null-terminated string.
 
-                    switch (fmt.fields[i].form) {
-                    case 1:  // addr (4 or 8 bytes)
-                    {
-                        if (address_size == 4) {
-                            val = e.getU32(&off);
-                        } else {
-                            val = e.getU64(&off);
-                        }
-                        break;
-                    }
-                    case 2:  // There is no case 2
-                    {
-                        internal_error << "What's form 2?";
-                        break;
-                    }
-                    case 3:  // block2 (2 byte length followed by payload)
-                    {
-                        val = e.getU16(&off);
-                        payload = (const uint8_t *)(debug_info.data() + off);
-                        off += val;
-                        break;
-                    }
-                    case 4:  // block4 (4 byte length followed by payload)
-                    {
-                        val = e.getU32(&off);
-                        payload = (const uint8_t *)(debug_info.data() + off);
-                        off += val;
-                        break;
-                    }
-                    case 5:  // data2 (2 bytes)
-                    {
-                        val = e.getU16(&off);
-                        break;
-                    }
-                    case 6:  // data4 (4 bytes)
-                    {
-                        val = e.getU32(&off);
-                        break;
-                    }
-                    case 7:  // data8 (8 bytes)
-                    {
-                        val = e.getU64(&off);
-                        break;
-                    }
-                    case 8:  // string (null terminated sequence of bytes)
-                    {
-                        val = 0;
-                        payload = (const uint8_t *)(debug_info.data() + off);
-                        while (e.getU8(&off)) {
-                        }
-                        break;
-                    }
-                    case 9:  // block (uleb128 length followed by payload)
-                    {
-                        val = e.getULEB128(&off);
-                        payload = (const uint8_t *)(debug_info.data() + off);
-                        off += val;
-                        break;
-                    }
-                    case 10:  // block1 (1 byte length followed by payload)
-                    {
-                        val = e.getU8(&off);
-                        payload = (const uint8_t *)(debug_info.data() + off);
-                        off += val;
-                        break;
-                    }
-                    case 11:  // data1 (1 byte)
-                    {
-                        val = e.getU8(&off);
-                        break;
-                    }
-                    case 12:  // flag (1 byte)
-                    {
-                        val = e.getU8(&off);
-                        break;
-                    }
-                    case 13:  // sdata (sleb128 constant)
-                    {
-                        val = (uint64_t)e.getSLEB128(&off);
-                        break;
-                    }
-                    case 14:  // strp (offset into debug_str section. 4 bytes in dwarf 32, 8 in dwarf 64)
-                    {
-                        uint64_t offset;
-                        if (dwarf_64) {
-                            offset = e.getU64(&off);
-                        } else {
-                            offset = e.getU32(&off);
-                        }
-                        val = 0;
-                        payload = (const uint8_t *)(debug_str.data() + offset);
-                        break;
-                    }
-                    case 15:  // udata (uleb128 constant)
-                    {
-                        val = e.getULEB128(&off);
-                        break;
-                    }
-                    case 16:  // ref_addr (offset from beginning of debug_info. 4 bytes in dwarf 32, 8 in dwarf 64)
-                    {
-                        if ((dwarf_version <= 2 && address_size == 8) ||
-                            (dwarf_version > 2 && dwarf_64)) {
-                            val = e.getU64(&off);
-                        } else {
-                            val = e.getU32(&off);
-                        }
-                        break;
-                    }
-                    case 17:  // ref1 (1 byte offset from the first byte of the compilation unit header)
-                    {
-                        val = e.getU8(&off) + start_of_unit_header;
-                        break;
-                    }
-                    case 18:  // ref2 (2 byte version of the same)
-                    {
-                        val = e.getU16(&off) + start_of_unit_header;
-                        break;
-                    }
-                    case 19:  // ref4 (4 byte version of the same)
-                    {
-                        val = e.getU32(&off) + start_of_unit_header;
-                        break;
-                    }
-                    case 20:  // ref8 (8 byte version of the same)
-                    {
-                        val = e.getU64(&off) + start_of_unit_header;
-                        break;
-                    }
-                    case 21:  // ref_udata (uleb128 version of the same)
-                    {
-                        val = e.getULEB128(&off) + start_of_unit_header;
-                        break;
-                    }
-                    case 22:  // indirect
-                    {
-                        internal_error << "Can't handle indirect form";
-                        break;
-                    }
-                    case 23:  // sec_offset
-                    {
-                        if (dwarf_64) {
-                            val = e.getU64(&off);
-                        } else {
-                            val = e.getU32(&off);
-                        }
-                        break;
-                    }
-                    case 24:  // exprloc
-                    {
-                        // Length
-                        val = e.getULEB128(&off);
-                        // Payload (contains a DWARF expression to evaluate (ugh))
-                        payload = (const uint8_t *)(debug_info.data() + off);
-                        off += val;
-                        break;
-                    }
-                    case 25:  // flag_present
-                    {
-                        val = 0;
-                        // Just the existence of this field is information apparently? There's no data.
-                        break;
-                    }
-                    case 32:  // ref_sig8
-                    {
-                        // 64-bit type signature for a reference in its own type unit
-                        val = e.getU64(&off);
-                        break;
-                    }
-                    default:
-                        internal_error << "Unknown form";
-                        break;
-                    }
+                    read_attribute(e, &off, fmt.fields[i].form, dwarf_64, dwarf_version,
+                                   address_size, start_of_unit_header, val, payload);
 
                     if (fmt.tag == tag_function) {
                         if (attr == attr_name) {
@@ -1636,11 +1930,11 @@ private:
         // Connect function definitions to their declarations
         {
             std::map<uint64_t, FunctionInfo *> func_map;
-            for (size_t i = 0; i < functions.size(); i++) {
+            for (size_t i = first_function; i < functions.size(); i++) {
                 func_map[functions[i].def_loc] = &functions[i];
             }
 
-            for (size_t i = 0; i < functions.size(); i++) {
+            for (size_t i = first_function; i < functions.size(); i++) {
                 if (functions[i].spec_loc) {
                     FunctionInfo *spec = func_map[functions[i].spec_loc];
                     if (spec) {
@@ -1653,13 +1947,13 @@ private:
         // Connect inlined variable instances to their origins
         {
             std::map<uint64_t, LocalVariable *> var_map;
-            for (size_t i = 0; i < functions.size(); i++) {
+            for (size_t i = first_function; i < functions.size(); i++) {
                 for (size_t j = 0; j < functions[i].variables.size(); j++) {
                     var_map[functions[i].variables[j].def_loc] = &(functions[i].variables[j]);
                 }
             }
 
-            for (size_t i = 0; i < functions.size(); i++) {
+            for (size_t i = first_function; i < functions.size(); i++) {
                 for (size_t j = 0; j < functions[i].variables.size(); j++) {
                     LocalVariable &v = functions[i].variables[j];
                     uint64_t loc = v.origin_loc;
@@ -1680,7 +1974,7 @@ private:
         // Connect global variable instances to their prototypes
         {
             std::map<uint64_t, GlobalVariable *> var_map;
-            for (size_t i = 0; i < global_variables.size(); i++) {
+            for (size_t i = first_global; i < global_variables.size(); i++) {
                 GlobalVariable &var = global_variables[i];
                 debug(5) << "var " << var.name << " is at " << var.def_loc << "\n";
                 if (var.spec_loc || var.name.empty()) {
@@ -1690,7 +1984,7 @@ private:
                 var_map[var.def_loc] = &var;
             }
 
-            for (size_t i = 0; i < global_variables.size(); i++) {
+            for (size_t i = first_global; i < global_variables.size(); i++) {
                 GlobalVariable &var = global_variables[i];
                 if (var.name.empty() && var.spec_loc) {
                     GlobalVariable *spec = var_map[var.spec_loc];
@@ -1707,24 +2001,23 @@ private:
 
         // Hook up the type pointers
         {
-            std::map<uint64_t, TypeInfo *> type_map;
-            for (size_t i = 0; i < types.size(); i++) {
+            for (size_t i = first_type; i < types.size(); i++) {
                 type_map[types[i].def_loc] = &types[i];
             }
 
-            for (size_t i = 0; i < functions.size(); i++) {
+            for (size_t i = first_function; i < functions.size(); i++) {
                 for (size_t j = 0; j < functions[i].variables.size(); j++) {
                     functions[i].variables[j].type =
                         type_map[functions[i].variables[j].type_def_loc];
                 }
             }
 
-            for (size_t i = 0; i < global_variables.size(); i++) {
+            for (size_t i = first_global; i < global_variables.size(); i++) {
                 global_variables[i].type =
                     type_map[global_variables[i].type_def_loc];
             }
 
-            for (size_t i = 0; i < types.size(); i++) {
+            for (size_t i = first_type; i < types.size(); i++) {
                 for (size_t j = 0; j < types[i].members.size(); j++) {
                     types[i].members[j].type =
                         type_map[types[i].members[j].type_def_loc];
@@ -1732,7 +2025,7 @@ private:
             }
         }
 
-        for (size_t i = 0; i < types.size(); i++) {
+        for (size_t i = first_type; i < types.size(); i++) {
             // Set the names of the pointer types
             vector<std::string> suffix;
             TypeInfo *t = &types[i];
@@ -1775,7 +2068,7 @@ private:
         }
 
         // Fix up the sizes of typedefs where we know the underlying type
-        for (size_t i = 0; i < types.size(); i++) {
+        for (size_t i = first_type; i < types.size(); i++) {
             TypeInfo *t = &types[i];
             if (types[i].type == TypeInfo::Typedef &&
                 !t->members.empty() &&
@@ -1785,7 +2078,7 @@ private:
         }
 
         // Unpack class members into the local variables list.
-        for (size_t i = 0; i < functions.size(); i++) {
+        for (size_t i = first_function; i < functions.size(); i++) {
             vector<LocalVariable> new_vars = functions[i].variables;
             for (size_t j = 0; j < new_vars.size(); j++) {
                 // If new_vars[j] is a class type, unpack its members
@@ -1829,7 +2122,7 @@ private:
         }
 
         // Unpack class members of global variables
-        for (size_t i = 0; i < global_variables.size(); i++) {
+        for (size_t i = first_global; i < global_variables.size(); i++) {
             GlobalVariable v = global_variables[i];
             if (v.type && v.addr &&
                 (v.type->type == TypeInfo::Struct ||
@@ -1859,8 +2152,8 @@ private:
         // and variables for which we don't know the stack offset,
         // name, or type.
         {
-            vector<FunctionInfo> trimmed;
-            for (size_t i = 0; i < functions.size(); i++) {
+            vector<FunctionInfo> trimmed(functions.begin(), functions.begin() + first_function);
+            for (size_t i = first_function; i < functions.size(); i++) {
                 FunctionInfo &f = functions[i];
                 if (!f.pc_begin ||
                     !f.pc_end ||
@@ -1887,8 +2180,8 @@ private:
 
         // Drop globals for which we don't know the address or name
         {
-            vector<GlobalVariable> trimmed;
-            for (size_t i = 0; i < global_variables.size(); i++) {
+            vector<GlobalVariable> trimmed(global_variables.begin(), global_variables.begin() + first_global);
+            for (size_t i = first_global; i < global_variables.size(); i++) {
                 GlobalVariable &v = global_variables[i];
                 if (!v.name.empty() && v.addr) {
                     trimmed.push_back(v);
@@ -1898,6 +2191,10 @@ private:
             std::swap(global_variables, trimmed);
         }
 
+        // Move the new entries into the address space of the running
+        // program, if we've already calibrated it.
+        shift_pcs(first_function, first_global, source_lines.size(), pc_adjust);
+
         // Sort the functions list by program counter
         std::sort(functions.begin(), functions.end());
 
@@ -1905,17 +2202,22 @@ private:
         std::sort(global_variables.begin(), global_variables.end());
     }
 
-    void parse_debug_line(const llvm::DataExtractor &e) {
-        llvm_offset_t off = 0;
+    // Parse the line number programs at the given offsets into debug_line.
+    void parse_debug_line(const vector<uint64_t> &unit_offsets) {
+        llvm::DataExtractor e(debug_line, true, bytes_in_address);
+
+        // Source lines from this index onwards are new.
+        size_t first_line = source_lines.size();
+
+        // For each compilation unit
+        for (uint64_t unit_offset : unit_offsets) {
+            llvm_offset_t off = unit_offset;
 
-        // For every compilation unit
-        while (1) {
             // Parse the header
             uint32_t unit_length = e.getU32(&off);
 
             if (unit_length == 0) {
-                // No more units
-                break;
+                continue;
             }
 
             llvm_offset_t unit_end = off + unit_length;
@@ -2153,6 +2455,8 @@ private:
             }
         }
 
+        shift_pcs(functions.size(), global_variables.size(), first_line, pc_adjust);
+
         // Sort the sequences and functions by low PC to make searching into it faster.
         std::sort(source_lines.begin(), source_lines.end());
     }
@@ -2160,6 +2464,7 @@ private:
     FunctionInfo *find_containing_function(void *addr) {
         uint64_t address = (uint64_t)addr;
         debug(5) << "Searching for function containing address " << addr << "\n";
+        parse_units_at(address - pc_adjust);
         size_t hi = functions.size();
         size_t lo = 0;
         while (hi > lo) {
@@ -2224,9 +2529,14 @@ private:
 
 DebugSections *debug_sections = nullptr;
 
+// Compilation units are parsed lazily as queries come in, so all
+// access to the debug sections must hold this lock.
+std::mutex debug_sections_mutex;
+
 }  // namespace
 
 bool dump_stack_frame() {
+    std::lock_guard<std::mutex> lock(debug_sections_mutex);
     if (!debug_sections || !debug_sections->working) {
         return false;
     }
@@ -2235,6 +2545,7 @@ bool dump_stack_frame() {
 }
 
 std::string get_variable_name(const void *var, const std::string &expected_type) {
+    std::lock_guard<std::mutex> lock(debug_sections_mutex);
     if (!debug_sections ||
         !debug_sections->working) {
         return "";
@@ -2253,6 +2564,7 @@ std::string get_variable_name(const void *var, const std::string &expected_type)
 }
 
 std::string get_source_location() {
+    std::lock_guard<std::mutex> lock(debug_sections_mutex);
     if (!debug_sections ||
         !debug_sections->working) {
         return "";
@@ -2261,6 +2573,7 @@ std::string get_source_location() {
 }
 
 void register_heap_object(const void *obj, size_t size, const void *helper) {
+    std::lock_guard<std::mutex> lock(debug_sections_mutex);
     if (!debug_sections ||
         !debug_sections->working ||
         !helper) {
@@ -2270,6 +2583,7 @@ void register_heap_object(const void *obj, size_t size, const void *helper) {
 }
 
 void deregister_heap_object(const void *obj, size_t size) {
+    std::lock_guard<std::mutex> lock(debug_sections_mutex);
     if (!debug_sections ||
         !debug_sections->working) {
         return;
@@ -2301,27 +2615,48 @@ void test_compilation_unit(bool (*test)(bool (*)(const void *, const std::string
         return;
     }
 
+    // Introspection can be turned off entirely, in which case the
+    // debug info is never loaded.
+    if (get_env_variable("HL_DISABLE_INTROSPECTION") == "1") {
+        return;
+    }
+
     debug(5) << "Testing compilation unit with offset_marker at " << reinterpret_bits<void *>(calib) << "\n";
 
-    if (!debug_sections) {
-        char path[2048];
-        get_program_name(path, sizeof(path));
-        debug_sections = new DebugSections(path);
-    }
+    {
+        std::lock_guard<std::mutex> lock(debug_sections_mutex);
+
+        if (!debug_sections) {
+            char path[2048];
+            get_program_name(path, sizeof(path));
+            debug_sections = new DebugSections(path);
+        }
+
+        if (!saves_frame_pointer(reinterpret_bits<void *>(&test_compilation_unit)) ||
+            !saves_frame_pointer(reinterpret_bits<void *>(test))) {
+            // Make sure libHalide and the test compilation unit both save the frame pointer
+            debug_sections->working = false;
+            debug(5) << "Failed because frame pointer not saved\n";
+            return;
+        }
+
+        if (!debug_sections->working) {
+            return;
+        }
 
-    if (!saves_frame_pointer(reinterpret_bits<void *>(&test_compilation_unit)) ||
-        !saves_frame_pointer(reinterpret_bits<void *>(test))) {
-        // Make sure libHalide and the test compilation unit both save the frame pointer
-        debug_sections->working = false;
-        debug(5) << "Failed because frame pointer not saved\n";
-    } else if (debug_sections->working) {
         debug_sections->calibrate_pc_offset(calib);
         if (!debug_sections->working) {
             debug(5) << "Failed because offset calibration failed\n";
             return;
         }
+    }
 
-        debug_sections->working = (*test)(test_a);
+    {
+        // The test itself queries the debug sections, so it must run
+        // without holding the lock.
+        bool working = (*test)(test_a);
+        std::lock_guard<std::mutex> lock(debug_sections_mutex);
+        debug_sections->working = working;
         if (!debug_sections->working) {
             debug(5) << "Failed because test routine failed\n";
             return;
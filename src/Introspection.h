@@ -9,7 +9,9 @@
  *
  * Defines methods for introspecting in C++. Relies on DWARF debugging
  * metadata, so the compilation unit that uses this must be compiled
- * with -g.
+ * with -g. The debug info is parsed lazily, one compilation unit at a
+ * time. Set the environment variable HL_DISABLE_INTROSPECTION=1 to
+ * skip loading it altogether.
  */
 
 namespace Halide {
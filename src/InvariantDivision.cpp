@@ -0,0 +1,328 @@
+#include "InvariantDivision.h"
+#include "ExprUsesVar.h"
+#include "IREquality.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "Scope.h"
+#include "Util.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::string;
+using std::vector;
+
+namespace {
+
+// A divisor found inside a loop, and the prefix of the names of the
+// lets that hold its precomputed multiplier and shifts.
+struct InvariantDivisor {
+    Expr value;
+    string name;
+};
+
+// The state for the innermost loop being mutated.
+struct LoopState {
+    // Names defined in the loop body (including the loop
+    // variable). Divisors that depend on these aren't invariant.
+    Scope<> varying;
+
+    // The divisors found so far, to be precomputed just outside the
+    // loop.
+    vector<InvariantDivisor> divisors;
+
+    // Whether the loop runs enough times to make replacing scalar
+    // divisions worthwhile. Vector divisions are always worth it.
+    bool scalars_worthwhile = false;
+
+    // The number of conditionals inside the loop body that enclose
+    // the code being mutated. Loads under these can't be hoisted out
+    // of the loop, because the condition may be what makes them safe.
+    int guards = 0;
+
+    // Whether any of the divisors load from memory. The precomputation
+    // then has to be guarded by the loop running at all.
+    bool divisors_load = false;
+};
+
+class ContainsLoad : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const Load *op) override {
+        result = true;
+    }
+
+public:
+    bool result = false;
+};
+
+bool contains_load(const Expr &e) {
+    ContainsLoad c;
+    e.accept(&c);
+    return c.result;
+}
+
+// The lets to precompute for a divisor d, using the round-up method
+// from Granlund and Montgomery, "Division by Invariant Integers using
+// Multiplication", figure 4.1. For an N-bit unsigned numerator n and
+// divisor d > 0, with l = ceil(log2(d)):
+//
+// m = floor(2^N * (2^l - d) / d) + 1
+// t = mulhi(m, n)
+// n / d = (t + ((n - t) >> min(l, 1))) >> max(l - 1, 0)
+//
+// The multiplier always fits in N bits, and the intermediate values
+// never overflow, so this works for every d in [1, 2^N). Signed
+// division is done on the magnitudes, and a zero divisor is mapped to
+// one and the result masked off afterwards.
+Stmt precompute_divisor(const InvariantDivisor &d, Stmt body) {
+    Type t = d.value.type();
+    Type u = t.with_code(Type::UInt);
+    const int bits = t.bits();
+    const Type wide = UInt(64);
+
+    Expr abs_d = t.is_int() ? abs(d.value) : d.value;
+    Expr nonzero_d = max(abs_d, make_one(u));
+    Expr wide_d = cast(wide, nonzero_d);
+    Expr one = make_one(wide);
+
+    // ceil(log2(d)). Or-ing in a one avoids asking for the leading
+    // zeros of zero, which is not defined on all backends.
+    Expr log2_d = select(nonzero_d == make_one(u), make_zero(wide),
+                         make_const(wide, bits) -
+                             cast(wide, count_leading_zeros((nonzero_d - make_one(u)) | make_one(u))));
+
+    Expr multiplier = cast(u, ((((one << log2_d) - wide_d) << make_const(wide, bits)) / wide_d) + one);
+    Expr shift_1 = cast(u, min(log2_d, one));
+    Expr shift_2 = cast(u, max(log2_d, one) - one);
+    Expr mask = select(d.value == make_zero(t), make_zero(u), ~make_zero(u));
+    Expr sign = t.is_int() ? cast(u, d.value >> make_const(UInt(bits), bits - 1)) : make_zero(u);
+
+    body = LetStmt::make(d.name + ".sign", sign, body);
+    body = LetStmt::make(d.name + ".mask", mask, body);
+    body = LetStmt::make(d.name + ".shift_2", shift_2, body);
+    body = LetStmt::make(d.name + ".shift_1", shift_1, body);
+    body = LetStmt::make(d.name + ".multiplier", multiplier, body);
+    body = LetStmt::make(d.name + ".abs", cast(u, abs_d), body);
+    return body;
+}
+
+class LowerLoopInvariantDivision : public IRMutator {
+    using IRMutator::visit;
+
+    LoopState *loop = nullptr;
+    bool in_device_code = false;
+
+    Stmt visit(const For *op) override {
+        if (in_device_code ||
+            (op->device_api != DeviceAPI::None &&
+             op->device_api != DeviceAPI::Host)) {
+            ScopedValue<bool> old_in_device_code(in_device_code, true);
+            return IRMutator::visit(op);
+        }
+
+        Expr min = mutate(op->min);
+        Expr extent = mutate(op->extent);
+
+        LoopState state;
+        state.varying.push(op->name);
+        const int64_t *const_extent = as_const_int(extent);
+        state.scalars_worthwhile = !const_extent || *const_extent >= 16;
+
+        Stmt body;
+        {
+            ScopedValue<LoopState *> old_loop(loop, &state);
+            body = mutate(op->body);
+        }
+
+        Stmt stmt;
+        if (min.same_as(op->min) &&
+            extent.same_as(op->extent) &&
+            body.same_as(op->body)) {
+            stmt = op;
+        } else {
+            stmt = For::make(op->name, min, extent, op->for_type, op->device_api, body, op->grain_size);
+        }
+
+        for (auto it = state.divisors.rbegin(); it != state.divisors.rend(); it++) {
+            stmt = precompute_divisor(*it, stmt);
+        }
+        if (state.divisors_load && !is_positive_const(extent)) {
+            // Only load the divisors where the loop body would have.
+            stmt = IfThenElse::make(extent > 0, stmt);
+        }
+        return stmt;
+    }
+
+    Stmt visit(const IfThenElse *op) override {
+        if (!loop) {
+            return IRMutator::visit(op);
+        }
+        Expr condition = mutate(op->condition);
+        Stmt then_case, else_case;
+        {
+            ScopedValue<int> old_guards(loop->guards, loop->guards + 1);
+            then_case = mutate(op->then_case);
+            else_case = mutate(op->else_case);
+        }
+        if (condition.same_as(op->condition) &&
+            then_case.same_as(op->then_case) &&
+            else_case.same_as(op->else_case)) {
+            return op;
+        }
+        return IfThenElse::make(condition, then_case, else_case);
+    }
+
+    Expr visit(const Call *op) override {
+        if (!loop || !op->is_intrinsic(Call::if_then_else)) {
+            return IRMutator::visit(op);
+        }
+        vector<Expr> args(op->args.size());
+        args[0] = mutate(op->args[0]);
+        {
+            ScopedValue<int> old_guards(loop->guards, loop->guards + 1);
+            for (size_t i = 1; i < op->args.size(); i++) {
+                args[i] = mutate(op->args[i]);
+            }
+        }
+        return Call::make(op->type, op->name, args, op->call_type,
+                          op->func, op->value_index, op->image, op->param);
+    }
+
+    template<typename LetOrLetStmt, typename StmtOrExpr>
+    StmtOrExpr visit_let(const LetOrLetStmt *op) {
+        Expr value = mutate(op->value);
+        StmtOrExpr body;
+        {
+            ScopedBinding<> bind(loop != nullptr, loop ? loop->varying : dummy_scope, op->name);
+            body = mutate(op->body);
+        }
+        if (value.same_as(op->value) && body.same_as(op->body)) {
+            return op;
+        }
+        return LetOrLetStmt::make(op->name, value, body);
+    }
+
+    Scope<> dummy_scope;
+
+    Stmt visit(const LetStmt *op) override {
+        return visit_let<LetStmt, Stmt>(op);
+    }
+
+    Expr visit(const Let *op) override {
+        return visit_let<Let, Expr>(op);
+    }
+
+    // If the divisor is worth replacing, returns the prefix of the
+    // names of the precomputed lets. Otherwise returns an empty
+    // string.
+    string find_invariant_divisor(const Expr &b) {
+        Type t = b.type();
+        if (!loop ||
+            !(t.is_int() || t.is_uint()) ||
+            !(t.bits() == 8 || t.bits() == 16 || t.bits() == 32) ||
+            is_const(b) ||
+            (t.is_scalar() && !loop->scalars_worthwhile)) {
+            return string();
+        }
+
+        Expr value = b;
+        if (const Broadcast *broadcast = b.as<Broadcast>()) {
+            value = broadcast->value;
+        }
+        if (value.type().is_vector() ||
+            !is_pure(value) ||
+            expr_uses_vars(value, loop->varying)) {
+            return string();
+        }
+        for (const InvariantDivisor &d : loop->divisors) {
+            if (equal(d.value, value)) {
+                return d.name;
+            }
+        }
+
+        const bool loads = contains_load(value);
+        if (loads && loop->guards > 0) {
+            // Hoisting the load would move it out from under the
+            // condition that protects it.
+            return string();
+        }
+        InvariantDivisor d{value, unique_name("divisor")};
+        loop->divisors.push_back(d);
+        loop->divisors_load |= loads;
+        return d.name;
+    }
+
+    Expr visit(const Div *op) override {
+        Expr a = mutate(op->a);
+        Expr b = mutate(op->b);
+        string name = find_invariant_divisor(b);
+        if (name.empty()) {
+            return Div::make(a, b);
+        }
+        return divide_or_mod(a, name, false);
+    }
+
+    Expr visit(const Mod *op) override {
+        Expr a = mutate(op->a);
+        Expr b = mutate(op->b);
+        string name = find_invariant_divisor(b);
+        if (name.empty()) {
+            return Mod::make(a, b);
+        }
+        return divide_or_mod(a, name, true);
+    }
+
+    Expr divide_or_mod(const Expr &a, const string &name, bool mod) {
+        Type t = a.type();
+        Type u = t.with_code(Type::UInt);
+        const int bits = t.bits();
+
+        auto precomputed = [&](const char *suffix) {
+            Expr v = Variable::make(u.element_of(), name + suffix);
+            return t.is_vector() ? Broadcast::make(v, t.lanes()) : v;
+        };
+
+        Expr abs_d = precomputed(".abs");
+        Expr mask = precomputed(".mask");
+
+        // Work on the magnitude of the numerator. For negative
+        // numerators, flipping the bits gives -a - 1, which makes
+        // the rounding come out Euclidean.
+        Expr n = cast(u, a);
+        Expr num_sign;
+        if (t.is_int()) {
+            num_sign = cast(u, a >> make_const(UInt(bits), bits - 1));
+            n = n ^ num_sign;
+        }
+
+        Expr high = Call::make(u, Call::mulhi_shr,
+                               {n, precomputed(".multiplier"), make_zero(UInt(bits))},
+                               Call::PureIntrinsic);
+        Expr q = (high + ((n - high) >> precomputed(".shift_1"))) >> precomputed(".shift_2");
+
+        Expr result;
+        if (mod) {
+            result = n - q * abs_d;
+            if (t.is_int()) {
+                result = (result ^ num_sign) + (abs_d & num_sign);
+            }
+        } else {
+            result = q;
+            if (t.is_int()) {
+                Expr sign = precomputed(".sign");
+                result = (result ^ (num_sign ^ sign)) - sign;
+            }
+        }
+        return cast(t, result & mask);
+    }
+};
+
+}  // namespace
+
+Stmt lower_loop_invariant_division(const Stmt &s) {
+    return LowerLoopInvariantDivision().mutate(s);
+}
+
+}  // namespace Internal
+}  // namespace Halide
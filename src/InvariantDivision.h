@@ -0,0 +1,28 @@
+#ifndef HALIDE_INVARIANT_DIVISION_H
+#define HALIDE_INVARIANT_DIVISION_H
+
+/** \file
+ * Defines the lowering pass that turns division and modulo by
+ * runtime-valued, loop-invariant divisors into multiplies and shifts.
+ */
+
+#include "Expr.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Find integer divisions and mods inside loops whose divisor is not
+ * a constant, but is invariant within the innermost enclosing loop
+ * (e.g. a Param). Precompute a multiplier and a pair of shifts for
+ * the divisor just outside that loop, and replace the division with a
+ * multiply-keep-high-half and shifts, which vectorize on all of our
+ * CPU targets, unlike native division. Handles signed and unsigned
+ * types of 8, 16, and 32 bits, and preserves Halide's Euclidean
+ * semantics, including division by zero. Loops that run on a device
+ * other than the host are left alone. */
+Stmt lower_loop_invariant_division(const Stmt &s);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
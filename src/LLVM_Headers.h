@@ -78,6 +78,7 @@
 #include <llvm/IR/DataLayout.h>
 #include <llvm/IR/Function.h>
 #include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/InlineAsm.h>
 #include <llvm/IR/Intrinsics.h>
 #ifdef WITH_HEXAGON
 #include <llvm/IR/IntrinsicsHexagon.h>
@@ -3,6 +3,10 @@
 #include "LLVM_Headers.h"
 #include "Target.h"
 
+#include <functional>
+#include <map>
+#include <mutex>
+
 namespace Halide {
 
 using std::string;
@@ -81,6 +85,7 @@ DECLARE_CPP_INITMOD(android_io)
 DECLARE_CPP_INITMOD(halide_buffer_t)
 DECLARE_CPP_INITMOD(cache)
 DECLARE_CPP_INITMOD(can_use_target)
+DECLARE_CPP_INITMOD(cancellation)
 DECLARE_CPP_INITMOD(cuda)
 DECLARE_CPP_INITMOD(destructors)
 DECLARE_CPP_INITMOD(device_interface)
@@ -135,6 +140,7 @@ DECLARE_CPP_INITMOD(qurt_threads)
 DECLARE_CPP_INITMOD(qurt_threads_tsan)
 DECLARE_CPP_INITMOD(qurt_yield)
 DECLARE_CPP_INITMOD(runtime_api)
+DECLARE_CPP_INITMOD(scratch_pool)
 DECLARE_CPP_INITMOD(ssp)
 DECLARE_CPP_INITMOD(to_string)
 DECLARE_CPP_INITMOD(trace_helper)
@@ -749,8 +755,53 @@ std::unique_ptr<llvm::Module> link_with_wasm_jit_runtime(llvm::LLVMContext *c, c
     return std::move(modules[0]);
 }
 
-/** Create an llvm module containing the support code for a given target. */
-std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVMContext *c, bool for_shared_jit_runtime, bool just_gpu) {
+namespace {
+
+// Parsing and linking the runtime modules takes a large fraction of the
+// time spent compiling a small pipeline, and the result only depends
+// on the target. Keep each linked module around as bitcode, and parse
+// that into the context of each later compilation instead. Entries are
+// never removed, so they can be read without holding the lock.
+struct CachedRuntimeModule {
+    std::string name;
+    llvm::SmallVector<char, 0> bitcode;
+};
+
+std::mutex runtime_module_cache_mutex;
+std::map<std::string, CachedRuntimeModule> runtime_module_cache;
+
+std::unique_ptr<llvm::Module> get_cached_runtime_module(const std::string &key, llvm::LLVMContext *c,
+                                                        const std::function<std::unique_ptr<llvm::Module>()> &make) {
+    const CachedRuntimeModule *cached = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(runtime_module_cache_mutex);
+        auto it = runtime_module_cache.find(key);
+        if (it != runtime_module_cache.end()) {
+            cached = &it->second;
+        }
+    }
+    if (cached) {
+        debug(2) << "Using cached runtime module for " << key << "\n";
+        llvm::StringRef buf(cached->bitcode.data(), cached->bitcode.size());
+        return parse_bitcode_file(buf, c, cached->name.c_str());
+    }
+
+    std::unique_ptr<llvm::Module> m = make();
+
+    CachedRuntimeModule entry;
+    entry.name = m->getModuleIdentifier();
+    {
+        llvm::raw_svector_ostream os(entry.bitcode);
+        llvm::WriteBitcodeToFile(*m, os);
+    }
+    {
+        std::lock_guard<std::mutex> lock(runtime_module_cache_mutex);
+        runtime_module_cache.emplace(key, std::move(entry));
+    }
+    return m;
+}
+
+std::unique_ptr<llvm::Module> link_initial_module_for_target(Target t, llvm::LLVMContext *c, bool for_shared_jit_runtime, bool just_gpu) {
     enum InitialModuleType {
         ModuleAOT,
         ModuleAOTNoRuntime,
@@ -970,6 +1021,8 @@ std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVM
             modules.push_back(get_initmod_metadata(c, bits_64, debug));
             modules.push_back(get_initmod_float16_t(c, bits_64, debug));
             modules.push_back(get_initmod_errors(c, bits_64, debug));
+            modules.push_back(get_initmod_cancellation(c, bits_64, debug));
+            modules.push_back(get_initmod_scratch_pool(c, bits_64, debug));
 
             // Some environments don't support the atomics the profiler requires.
             if (t.arch != Target::MIPS && t.os != Target::NoOS && t.os != Target::QuRT) {
@@ -1164,8 +1217,26 @@ std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVM
     return std::move(modules[0]);
 }
 
+}  // namespace
+
+/** Create an llvm module containing the support code for a given target. */
+std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVMContext *c, bool for_shared_jit_runtime, bool just_gpu) {
+    std::string key = t.to_string();
+    if (for_shared_jit_runtime) {
+        key += "/shared_jit_runtime";
+    }
+    if (just_gpu) {
+        key += "/just_gpu";
+    }
+    return get_cached_runtime_module(key, c, [&]() {
+        return link_initial_module_for_target(t, c, for_shared_jit_runtime, just_gpu);
+    });
+}
+
 #ifdef WITH_NVPTX
-std::unique_ptr<llvm::Module> get_initial_module_for_ptx_device(Target target, llvm::LLVMContext *c) {
+namespace {
+
+std::unique_ptr<llvm::Module> link_initial_module_for_ptx_device(Target target, llvm::LLVMContext *c) {
     std::vector<std::unique_ptr<llvm::Module>> modules;
     modules.push_back(get_initmod_ptx_dev_ll(c));
 
@@ -1217,6 +1288,14 @@ std::unique_ptr<llvm::Module> get_initial_module_for_ptx_device(Target target, l
 
     return std::move(modules[0]);
 }
+
+}  // namespace
+
+std::unique_ptr<llvm::Module> get_initial_module_for_ptx_device(Target target, llvm::LLVMContext *c) {
+    return get_cached_runtime_module(target.to_string() + "/ptx_device", c, [&]() {
+        return link_initial_module_for_ptx_device(target, c);
+    });
+}
 #endif
 
 void add_bitcode_to_module(llvm::LLVMContext *context, llvm::Module &module,
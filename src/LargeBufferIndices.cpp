@@ -0,0 +1,375 @@
+#include "LargeBufferIndices.h"
+#include "Bounds.h"
+#include "ExprUsesVar.h"
+#include "IREquality.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "IRVisitor.h"
+#include "Scope.h"
+#include "Simplify.h"
+#include "Substitute.h"
+#include "Util.h"
+
+#include <limits>
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::pair;
+using std::string;
+using std::vector;
+
+namespace {
+
+class ContainsLoop : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const For *op) override {
+        result = true;
+    }
+
+public:
+    bool result = false;
+};
+
+bool contains_loop(const Stmt &s) {
+    ContainsLoop c;
+    s.accept(&c);
+    return c.result;
+}
+
+// Index arithmetic we can move around freely: no loads, which might
+// be of memory written by the loop, and nothing impure.
+class IsPlainArithmetic : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const Load *op) override {
+        result = false;
+    }
+
+    void visit(const Call *op) override {
+        if (!op->is_pure()) {
+            result = false;
+        } else {
+            IRVisitor::visit(op);
+        }
+    }
+
+public:
+    bool result = true;
+};
+
+bool is_plain_arithmetic(const Expr &e) {
+    IsPlainArithmetic p;
+    e.accept(&p);
+    return p.result;
+}
+
+// Flatten a tree of additions and subtractions into a list of terms,
+// each with a flag that says whether it is subtracted.
+void collect_terms(const Expr &e, bool negate, vector<pair<Expr, bool>> &terms) {
+    if (const Add *add = e.as<Add>()) {
+        collect_terms(add->a, negate, terms);
+        collect_terms(add->b, negate, terms);
+    } else if (const Sub *sub = e.as<Sub>()) {
+        collect_terms(sub->a, negate, terms);
+        collect_terms(sub->b, !negate, terms);
+    } else {
+        terms.emplace_back(e, negate);
+    }
+}
+
+Expr accumulate(const Expr &sum, const Expr &term, bool negate) {
+    if (!sum.defined()) {
+        return negate ? Sub::make(make_zero(term.type()), term) : term;
+    }
+    return negate ? Sub::make(sum, term) : Add::make(sum, term);
+}
+
+// Rewrite a 64-bit expression built from smaller integers as the same
+// computation in 32 bits. Each 64-bit subexpression that could
+// disagree with its 32-bit counterpart is added to must_fit. Returns an
+// undefined Expr if the expression has some other form.
+Expr narrow(const Expr &e, vector<Expr> &must_fit) {
+    if (e.type() != Int(64)) {
+        return Expr();
+    }
+    if (const Cast *op = e.as<Cast>()) {
+        Type t = op->value.type();
+        if (t == Int(32)) {
+            return op->value;
+        } else if ((t.is_int() || t.is_uint()) && t.bits() < 32) {
+            return Cast::make(Int(32), op->value);
+        }
+    } else if (const IntImm *op = e.as<IntImm>()) {
+        if (op->value >= std::numeric_limits<int32_t>::min() &&
+            op->value <= std::numeric_limits<int32_t>::max()) {
+            return make_const(Int(32), op->value);
+        }
+    } else if (e.as<Variable>()) {
+        must_fit.push_back(e);
+        return Cast::make(Int(32), e);
+    }
+
+    Expr a, b;
+    if (const Add *op = e.as<Add>()) {
+        a = narrow(op->a, must_fit);
+        b = narrow(op->b, must_fit);
+        if (a.defined() && b.defined()) {
+            must_fit.push_back(e);
+            return Add::make(a, b);
+        }
+    } else if (const Sub *op = e.as<Sub>()) {
+        a = narrow(op->a, must_fit);
+        b = narrow(op->b, must_fit);
+        if (a.defined() && b.defined()) {
+            must_fit.push_back(e);
+            return Sub::make(a, b);
+        }
+    } else if (const Mul *op = e.as<Mul>()) {
+        a = narrow(op->a, must_fit);
+        b = narrow(op->b, must_fit);
+        if (a.defined() && b.defined()) {
+            must_fit.push_back(e);
+            return Mul::make(a, b);
+        }
+    } else if (const Min *op = e.as<Min>()) {
+        a = narrow(op->a, must_fit);
+        b = narrow(op->b, must_fit);
+        if (a.defined() && b.defined()) {
+            return Min::make(a, b);
+        }
+    } else if (const Max *op = e.as<Max>()) {
+        a = narrow(op->a, must_fit);
+        b = narrow(op->b, must_fit);
+        if (a.defined() && b.defined()) {
+            return Max::make(a, b);
+        }
+    }
+    return Expr();
+}
+
+// The state for the innermost loop being mutated.
+struct LoopState {
+    string name;
+
+    // The bounds of the loop variable.
+    Scope<Interval> bounds;
+
+    // The values of the lets defined in the loop body so far, in
+    // terms of the loop variable and things defined outside the loop.
+    map<string, Expr> lets;
+
+    // The 64-bit subexpressions of the offsets, which must fit in 32
+    // bits for the narrowed loop to be used.
+    vector<Expr> must_fit;
+
+    // The loop-invariant bases, to be computed just outside the loop.
+    vector<pair<string, Expr>> bases;
+};
+
+class NarrowLargeBufferIndices : public IRMutator {
+    using IRMutator::visit;
+
+    LoopState *loop = nullptr;
+    bool in_device_code = false;
+
+    Stmt visit(const For *op) override {
+        if (in_device_code ||
+            (op->device_api != DeviceAPI::None &&
+             op->device_api != DeviceAPI::Host)) {
+            ScopedValue<bool> old_in_device_code(in_device_code, true);
+            return IRMutator::visit(op);
+        }
+
+        if (contains_loop(op->body)) {
+            return IRMutator::visit(op);
+        }
+
+        LoopState state;
+        state.name = op->name;
+        state.bounds.push(op->name, Interval(op->min, op->min + op->extent - 1));
+
+        Stmt body;
+        {
+            ScopedValue<LoopState *> old_loop(loop, &state);
+            body = mutate(op->body);
+        }
+        if (body.same_as(op->body)) {
+            return op;
+        }
+
+        Stmt narrowed = For::make(op->name, op->min, op->extent, op->for_type,
+                                  op->device_api, body, op->grain_size);
+        for (auto it = state.bases.rbegin(); it != state.bases.rend(); it++) {
+            narrowed = LetStmt::make(it->first, it->second, narrowed);
+        }
+
+        const Expr int32_min = make_const(Int(64), std::numeric_limits<int32_t>::min());
+        const Expr int32_max = make_const(Int(64), std::numeric_limits<int32_t>::max());
+        Expr fits = const_true();
+        for (const Expr &e : state.must_fit) {
+            Interval i = bounds_of_expr_in_scope(e, state.bounds);
+            internal_assert(i.is_bounded());
+            fits = fits && i.min >= int32_min && i.max <= int32_max;
+        }
+        fits = simplify(fits);
+
+        if (is_const_one(fits)) {
+            return narrowed;
+        } else if (is_const_zero(fits)) {
+            return op;
+        } else {
+            // Keep the original loop for when the offsets don't fit.
+            return IfThenElse::make(fits, narrowed, op);
+        }
+    }
+
+    template<typename LetOrLetStmt, typename StmtOrExpr>
+    StmtOrExpr visit_let(const LetOrLetStmt *op) {
+        if (!loop) {
+            return IRMutator::visit(op);
+        }
+        Expr value = mutate(op->value);
+        StmtOrExpr body;
+        {
+            Expr expanded = substitute(loop->lets, op->value);
+            auto old = loop->lets.find(op->name);
+            Expr shadowed = old == loop->lets.end() ? Expr() : old->second;
+            loop->lets[op->name] = expanded;
+            body = mutate(op->body);
+            if (shadowed.defined()) {
+                loop->lets[op->name] = shadowed;
+            } else {
+                loop->lets.erase(op->name);
+            }
+        }
+        if (value.same_as(op->value) && body.same_as(op->body)) {
+            return op;
+        }
+        return LetOrLetStmt::make(op->name, value, body);
+    }
+
+    Stmt visit(const LetStmt *op) override {
+        return visit_let<LetStmt, Stmt>(op);
+    }
+
+    Expr visit(const Let *op) override {
+        return visit_let<Let, Expr>(op);
+    }
+
+    // Split the index into a loop-invariant 64-bit base, a 32-bit
+    // offset, and a constant. Returns the index unchanged if that
+    // isn't possible.
+    Expr narrow_index(const string &buffer, const Expr &index) {
+        const Ramp *ramp = index.as<Ramp>();
+        Expr base = ramp ? ramp->base : index;
+        if (!loop || base.type() != Int(64)) {
+            return index;
+        }
+
+        Expr expanded = substitute(loop->lets, base);
+        if (!is_plain_arithmetic(expanded)) {
+            return index;
+        }
+
+        vector<pair<Expr, bool>> terms;
+        collect_terms(expanded, false, terms);
+        Expr invariant, varying;
+        int64_t constant = 0;
+        for (const auto &t : terms) {
+            const int64_t *c = as_const_int(t.first);
+            if (c && !t.second && !add_would_overflow(64, constant, *c)) {
+                constant += *c;
+            } else if (c && t.second && !sub_would_overflow(64, constant, *c)) {
+                constant -= *c;
+            } else if (!expr_uses_var(t.first, loop->name)) {
+                invariant = accumulate(invariant, t.first, t.second);
+            } else {
+                varying = accumulate(varying, t.first, t.second);
+            }
+        }
+        if (!varying.defined()) {
+            // The whole index is invariant. LLVM will hoist it.
+            return index;
+        }
+
+        vector<Expr> must_fit;
+        Expr offset = narrow(varying, must_fit);
+        if (!offset.defined()) {
+            return index;
+        }
+        for (const Expr &e : must_fit) {
+            if (!bounds_of_expr_in_scope(e, loop->bounds).is_bounded()) {
+                return index;
+            }
+        }
+        for (const Expr &e : must_fit) {
+            bool seen = false;
+            for (const Expr &f : loop->must_fit) {
+                seen = seen || equal(e, f);
+            }
+            if (!seen) {
+                loop->must_fit.push_back(e);
+            }
+        }
+
+        Expr new_base = Cast::make(Int(64), offset);
+        if (invariant.defined()) {
+            string name;
+            for (const auto &b : loop->bases) {
+                if (equal(b.second, invariant)) {
+                    name = b.first;
+                    break;
+                }
+            }
+            if (name.empty()) {
+                name = unique_name(buffer + ".base");
+                loop->bases.emplace_back(name, invariant);
+            }
+            new_base = Add::make(Variable::make(Int(64), name), new_base);
+        }
+        if (constant != 0) {
+            // Kept separate so that stencil taps share a base.
+            new_base = Add::make(new_base, make_const(Int(64), constant));
+        }
+
+        if (ramp) {
+            return Ramp::make(new_base, ramp->stride, ramp->lanes);
+        } else {
+            return new_base;
+        }
+    }
+
+    Expr visit(const Load *op) override {
+        Expr predicate = mutate(op->predicate);
+        Expr index = narrow_index(op->name, mutate(op->index));
+        if (predicate.same_as(op->predicate) && index.same_as(op->index)) {
+            return op;
+        }
+        return Load::make(op->type, op->name, index, op->image, op->param,
+                          predicate, op->alignment);
+    }
+
+    Stmt visit(const Store *op) override {
+        Expr predicate = mutate(op->predicate);
+        Expr value = mutate(op->value);
+        Expr index = narrow_index(op->name, mutate(op->index));
+        if (predicate.same_as(op->predicate) &&
+            value.same_as(op->value) &&
+            index.same_as(op->index)) {
+            return op;
+        }
+        return Store::make(op->name, value, index, op->param, predicate, op->alignment);
+    }
+};
+
+}  // namespace
+
+Stmt narrow_large_buffer_indices(const Stmt &s) {
+    return NarrowLargeBufferIndices().mutate(s);
+}
+
+}  // namespace Internal
+}  // namespace Halide
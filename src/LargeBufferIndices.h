@@ -0,0 +1,27 @@
+#ifndef HALIDE_LARGE_BUFFER_INDICES_H
+#define HALIDE_LARGE_BUFFER_INDICES_H
+
+/** \file
+ * Defines the lowering pass that moves the 64-bit index arithmetic of
+ * targets with large buffers out of inner loops.
+ */
+
+#include "Expr.h"
+
+namespace Halide {
+namespace Internal {
+
+/** With the LargeBuffers feature, buffer indices are computed in 64
+ * bits. For each innermost loop on the host, split the index of each
+ * load and store into a loop-invariant 64-bit base, computed once just
+ * outside the loop, and an offset that varies in the loop, computed in
+ * 32 bits. If the offsets can't be shown to fit in 32 bits at compile
+ * time, the loop is versioned on a runtime check of their bounds, with
+ * the original loop as the fallback. Should be run after the final
+ * simplification. */
+Stmt narrow_large_buffer_indices(const Stmt &s);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
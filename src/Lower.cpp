@@ -9,19 +9,25 @@
 #include "AddAtomicMutex.h"
 #include "AddImageChecks.h"
 #include "AddParameterChecks.h"
+#include "AliasedOutputs.h"
 #include "AllocationBoundsInference.h"
 #include "AsyncProducers.h"
+#include "AutoComputeWith.h"
 #include "BoundSmallAllocations.h"
 #include "Bounds.h"
 #include "BoundsInference.h"
 #include "CSE.h"
+#include "CancellationChecks.h"
 #include "CanonicalizeGPUVars.h"
+#include "CollapseParallelLoops.h"
 #include "CompilerLogger.h"
+#include "ComputeAtCompileTime.h"
 #include "Debug.h"
 #include "DebugArguments.h"
 #include "DebugToFile.h"
 #include "Deinterleave.h"
 #include "EarlyFree.h"
+#include "ExternVectorVariants.h"
 #include "FindCalls.h"
 #include "FindIntrinsics.h"
 #include "FlattenNestedRamps.h"
@@ -35,8 +41,10 @@
 #include "IRPrinter.h"
 #include "InferArguments.h"
 #include "InjectHostDevBufferCopies.h"
+#include "InvariantDivision.h"
 #include "Inline.h"
 #include "LICM.h"
+#include "LargeBufferIndices.h"
 #include "LoopCarry.h"
 #include "LowerWarpShuffles.h"
 #include "Memoization.h"
@@ -46,16 +54,20 @@
 #include "PurifyIndexMath.h"
 #include "Qualify.h"
 #include "RealizationOrder.h"
+#include "RegisterPromotion.h"
 #include "RemoveDeadAllocations.h"
 #include "RemoveExternLoops.h"
 #include "RemoveUndef.h"
 #include "ScheduleFunctions.h"
+#include "ScratchBytesQuery.h"
+#include "ScratchPool.h"
 #include "SelectGPUAPI.h"
 #include "Simplify.h"
 #include "SimplifyCorrelatedDifferences.h"
 #include "SimplifySpecializations.h"
 #include "SkipStages.h"
 #include "SlidingWindow.h"
+#include "SpecializeStrides.h"
 #include "SplitTuples.h"
 #include "StorageFlattening.h"
 #include "StorageFolding.h"
@@ -106,6 +118,7 @@ Module lower(const vector<Function> &output_funcs,
 
     bool any_strict_float = strictify_float(env, t);
     result_module.set_any_strict_float(any_strict_float);
+    result_module.set_vector_externs(gather_vector_externs(env));
 
     // Output functions should all be computed and stored at root.
     for (const Function &f : outputs) {
@@ -120,6 +133,17 @@ Module lower(const vector<Function> &output_funcs,
     // Substitute in wrapper Funcs
     env = wrap_func_calls(env);
 
+    // Evaluate any Funcs that are computed at compile time, and
+    // replace them with constant buffers.
+    compute_at_compile_time(outputs, env);
+
+    // Make sure outputs that alias inputs can be computed in place.
+    prepare_aliased_outputs(outputs, env, t);
+
+    // Fuse the loop nests of independent Funcs that read the same
+    // inputs, if the target asks for it.
+    auto_compute_with(env, t);
+
     // Compute a realization order and determine group of functions which loops
     // are to be fused together
     vector<string> order;
@@ -207,6 +231,9 @@ Module lower(const vector<Function> &output_funcs,
          t.has_feature(Target::HexagonDma) ||
          (t.arch != Target::Hexagon && (t.has_feature(Target::HVX))));
 
+    debug(1) << "Adding checks for aliased outputs...\n";
+    s = add_aliased_output_checks(s, outputs);
+
     debug(1) << "Adding checks for images\n";
     s = add_image_checks(s, outputs, t, order, env, func_bounds, will_inject_host_copies);
     debug(2) << "Lowering after injecting image checks:\n"
@@ -278,6 +305,13 @@ Module lower(const vector<Function> &output_funcs,
     debug(2) << "Lowering after adding atomic mutex allocation:\n"
              << s << "\n\n";
 
+    if (t.has_feature(Target::SpecializeStrides)) {
+        debug(1) << "Specializing loop nests on dense strides...\n";
+        s = specialize_strides(s);
+        debug(2) << "Lowering after specializing on dense strides:\n"
+                 << s << "\n\n";
+    }
+
     debug(1) << "Unpacking buffer arguments...\n";
     s = unpack_buffers(s);
     debug(2) << "Lowering after unpacking buffer arguments...\n"
@@ -351,6 +385,13 @@ Module lower(const vector<Function> &output_funcs,
     debug(2) << "Lowering after rewriting vector interleavings:\n"
              << s << "\n\n";
 
+    debug(1) << "Collapsing nested parallel loops...\n";
+    // This goes before loop partitioning, which would otherwise
+    // wrap the inner loop in the boundary cases of the outer one.
+    s = collapse_parallel_loops(s);
+    debug(2) << "Lowering after collapsing nested parallel loops:\n"
+             << s << "\n\n";
+
     debug(1) << "Partitioning loops to simplify boundary conditions...\n";
     s = partition_loops(s);
     s = simplify(s);
@@ -367,6 +408,16 @@ Module lower(const vector<Function> &output_funcs,
     debug(2) << "Lowering after hoisting loop invariant if statements:\n"
              << s << "\n\n";
 
+    debug(1) << "Lowering division by loop invariant divisors...\n";
+    s = lower_loop_invariant_division(s);
+    debug(2) << "Lowering after lowering division by loop invariant divisors:\n"
+             << s << "\n\n";
+
+    debug(1) << "Promoting small allocations to registers...\n";
+    s = promote_allocations_to_registers(s);
+    debug(2) << "Lowering after promoting small allocations to registers:\n"
+             << s << "\n\n";
+
     debug(1) << "Injecting early frees...\n";
     s = inject_early_frees(s);
     debug(2) << "Lowering after injecting early frees:\n"
@@ -389,6 +440,18 @@ Module lower(const vector<Function> &output_funcs,
     debug(2) << "Lowering after bounding small allocations:\n"
              << s << "\n\n";
 
+    debug(1) << "Pooling scratch memory of parallel tasks...\n";
+    s = pool_parallel_scratch(s);
+    debug(2) << "Lowering after pooling scratch memory of parallel tasks:\n"
+             << s << "\n\n";
+
+    if (t.has_feature(Target::Cancellable)) {
+        debug(1) << "Injecting cancellation checks...\n";
+        s = inject_cancellation_checks(s, t);
+        debug(2) << "Lowering after injecting cancellation checks:\n"
+                 << s << "\n\n";
+    }
+
     if (t.has_feature(Target::Profile)) {
         debug(1) << "Injecting profiling...\n";
         s = inject_profiling(s, pipeline_name);
@@ -423,6 +486,13 @@ Module lower(const vector<Function> &output_funcs,
     debug(2) << "Lowering after removing dead allocations and hoisting loop invariant values:\n"
              << s << "\n\n";
 
+    if (t.has_large_buffers()) {
+        debug(1) << "Narrowing large buffer indices...\n";
+        s = narrow_large_buffer_indices(s);
+        debug(2) << "Lowering after narrowing large buffer indices:\n"
+                 << s << "\n\n";
+    }
+
     debug(1) << "Finding intrinsics...\n";
     s = find_intrinsics(s);
     debug(2) << "Lowering after finding intrinsics:\n"
@@ -532,6 +602,11 @@ Module lower(const vector<Function> &output_funcs,
 
     result_module.append(main_func);
 
+    if (t.has_feature(Target::ScratchBytesQuery)) {
+        debug(1) << "Building the scratch bytes query...\n";
+        result_module.append(scratch_bytes_query(main_func));
+    }
+
     auto *logger = get_compiler_logger();
     if (logger) {
         auto time_end = std::chrono::high_resolution_clock::now();
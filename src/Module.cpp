@@ -332,6 +332,7 @@ struct ModuleContents {
     std::vector<ExternalCode> external_code;
     std::map<std::string, std::string> metadata_name_map;
     bool any_strict_float{false};
+    std::vector<VectorExternVariant> vector_externs;
     std::unique_ptr<AutoSchedulerResults> auto_scheduler_results;
 };
 
@@ -383,6 +384,10 @@ void Module::set_any_strict_float(bool any_strict_float) {
     contents->any_strict_float = any_strict_float;
 }
 
+void Module::set_vector_externs(const std::vector<VectorExternVariant> &vector_externs) {
+    contents->vector_externs = vector_externs;
+}
+
 const Target &Module::target() const {
     return contents->target;
 }
@@ -399,6 +404,10 @@ bool Module::any_strict_float() const {
     return contents->any_strict_float;
 }
 
+const std::vector<VectorExternVariant> &Module::vector_externs() const {
+    return contents->vector_externs;
+}
+
 const std::vector<Buffer<>> &Module::buffers() const {
     return contents->buffers;
 }
@@ -506,6 +515,7 @@ Module Module::resolve_submodules() const {
     }
 
     Module lowered_module(name(), target());
+    lowered_module.set_vector_externs(vector_externs());
 
     for (const auto &f : functions()) {
         lowered_module.append(f);
@@ -152,6 +152,10 @@ public:
     /** Return whether this module uses strict floating-point anywhere. */
     bool any_strict_float() const;
 
+    /** The vector variants of pure extern functions declared by the
+     * Funcs this module was lowered from. */
+    const std::vector<Internal::VectorExternVariant> &vector_externs() const;
+
     /** The declarations contained in this module. */
     // @{
     const std::vector<Buffer<void>> &buffers() const;
@@ -199,6 +203,8 @@ public:
 
     /** Set whether this module uses strict floating-point directives anywhere. */
     void set_any_strict_float(bool any_strict_float);
+
+    void set_vector_externs(const std::vector<Internal::VectorExternVariant> &vector_externs);
 };
 
 /** Link a set of modules together into one module. */
@@ -484,6 +484,15 @@ class PartitionLoops : public IRMutator {
 
     bool in_gpu_loop = false;
 
+    // How many prologues or epilogues we're currently inside. Loops
+    // inside a prologue or epilogue are partitioned too, so that the
+    // border of a multi-dimensional boundary condition gets split
+    // into edges and corners, and only the corners carry the clamps
+    // for every dimension. Each level of this multiplies code size,
+    // so we only go one level deep.
+    int border_depth = 0;
+    const int max_border_depth = 1;
+
     Stmt visit(const For *op) override {
         Stmt body = op->body;
 
@@ -631,6 +640,20 @@ class PartitionLoops : public IRMutator {
         // Recurse on the middle section.
         simpler_body = mutate(simpler_body);
 
+        // Recurse on the prologue and epilogue, if we're not too deep
+        // into the border already. This isn't safe inside GPU
+        // kernels, because RenormalizeGPULoops can't pull apart the
+        // resulting differently-shaped branches.
+        if (!in_gpu_loop && border_depth < max_border_depth) {
+            ScopedValue<int> old_border_depth(border_depth, border_depth + 1);
+            if (make_prologue) {
+                prologue = mutate(prologue);
+            }
+            if (make_epilogue) {
+                epilogue = mutate(epilogue);
+            }
+        }
+
         // Construct variables for the bounds of the simplified middle section
         Expr min_steady = op->min, max_steady = op->extent + op->min;
         Expr prologue_val, epilogue_val;
@@ -672,16 +695,16 @@ class PartitionLoops : public IRMutator {
         // Bust simple serial for loops up into three.
         if (op->for_type == ForType::Serial && !op->body.as<Acquire>()) {
             stmt = For::make(op->name, min_steady, max_steady - min_steady,
-                             op->for_type, op->device_api, simpler_body);
+                             op->for_type, op->device_api, simpler_body, op->grain_size);
 
             if (make_prologue) {
                 prologue = For::make(op->name, op->min, min_steady - op->min,
-                                     op->for_type, op->device_api, prologue);
+                                     op->for_type, op->device_api, prologue, op->grain_size);
                 stmt = Block::make(prologue, stmt);
             }
             if (make_epilogue) {
                 epilogue = For::make(op->name, max_steady, op->min + op->extent - max_steady,
-                                     op->for_type, op->device_api, epilogue);
+                                     op->for_type, op->device_api, epilogue, op->grain_size);
                 stmt = Block::make(stmt, epilogue);
             }
         } else {
@@ -709,7 +732,7 @@ class PartitionLoops : public IRMutator {
                     stmt = IfThenElse::make(loop_var < min_steady, prologue, stmt);
                 }
             }
-            stmt = For::make(op->name, op->min, op->extent, op->for_type, op->device_api, stmt);
+            stmt = For::make(op->name, op->min, op->extent, op->for_type, op->device_api, stmt, op->grain_size);
         }
 
         if (make_epilogue) {
@@ -832,7 +855,7 @@ class RenormalizeGPULoops : public IRMutator {
             internal_assert(!expr_uses_var(f->min, op->name) &&
                             !expr_uses_var(f->extent, op->name));
             Stmt inner = LetStmt::make(op->name, op->value, f->body);
-            inner = For::make(f->name, f->min, f->extent, f->for_type, f->device_api, inner);
+            inner = For::make(f->name, f->min, f->extent, f->for_type, f->device_api, inner, f->grain_size);
             return mutate(inner);
         } else if (a && in_gpu_loop && !in_thread_loop) {
             internal_assert(a->extents.size() == 1);
@@ -908,7 +931,7 @@ class RenormalizeGPULoops : public IRMutator {
                    for_a->min.same_as(for_b->min) &&
                    for_a->extent.same_as(for_b->extent)) {
             Stmt inner = IfThenElse::make(op->condition, for_a->body, for_b->body);
-            inner = For::make(for_a->name, for_a->min, for_a->extent, for_a->for_type, for_a->device_api, inner);
+            inner = For::make(for_a->name, for_a->min, for_a->extent, for_a->for_type, for_a->device_api, inner, for_a->grain_size);
             return mutate(inner);
         } else {
             internal_error << "Unexpected construct inside if statement: " << Stmt(op) << "\n";
@@ -21,7 +21,11 @@ bool has_likely_tag(const Expr &e);
 
 /** Partitions loop bodies into a prologue, a steady state, and an
  * epilogue. Finds the steady state by hunting for use of clamped
- * ramps, or the 'likely' intrinsic. */
+ * ramps, or the 'likely' intrinsic. Loops inside the prologue and
+ * epilogue are partitioned too (one level deep), so that
+ * multi-dimensional boundary conditions produce a clean interior,
+ * edges that only handle the boundary in one dimension, and
+ * corners. */
 Stmt partition_loops(Stmt s);
 
 }  // namespace Internal
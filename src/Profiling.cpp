@@ -285,7 +285,7 @@ private:
             body = op->body;
         }
 
-        Stmt stmt = For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body);
+        Stmt stmt = For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body, op->grain_size);
 
         if (update_active_threads) {
             stmt = Block::make({decr_active_threads(), stmt, incr_active_threads()});
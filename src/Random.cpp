@@ -1,5 +1,8 @@
+#include <algorithm>
+
 #include "Random.h"
 #include "Func.h"
+#include "IREquality.h"
 #include "IRMutator.h"
 #include "IROperator.h"
 
@@ -61,6 +64,27 @@ Expr rng32(const Expr &x) {
 
     return (((C2 * x) + C1) * x) + C0;
 }
+
+// The multipliers and key increments of Philox-4x32, from Salmon et
+// al., "Parallel Random Numbers: As Easy as 1, 2, 3", SC 2011.
+const uint32_t philox_m0 = 0xD2511F53;
+const uint32_t philox_m1 = 0xCD9E8D57;
+const uint32_t philox_w0 = 0x9E3779B9;
+const uint32_t philox_w1 = 0xBB67AE85;
+
+// The paper reports that seven rounds is the fewest that passes all of
+// BigCrush. Each round costs two 32x32->64 multiplies.
+const int philox_rounds = 7;
+
+// Fill the mantissa of a float in [1, 2) with the high bits of a
+// random integer, and subtract one.
+Expr uint_to_unit_float(const Expr &bits) {
+    // Set the exponent to one, and fill the mantissa with 23 random bits.
+    Expr result = (127 << 23) | (cast<uint32_t>(bits) >> 9);
+    // The clamp is purely for the benefit of bounds inference.
+    return clamp(reinterpret(Float(32), result) - 1.0f, 0.0f, 1.0f);
+}
+
 }  // namespace
 
 Expr random_int(const vector<Expr> &e) {
@@ -86,11 +110,70 @@ Expr random_int(const vector<Expr> &e) {
 }
 
 Expr random_float(const vector<Expr> &e) {
-    Expr result = random_int(e);
-    // Set the exponent to one, and fill the mantissa with 23 random bits.
-    result = (127 << 23) | (cast<uint32_t>(result) >> 9);
-    // The clamp is purely for the benefit of bounds inference.
-    return clamp(reinterpret(Float(32), result) - 1.0f, 0.0f, 1.0f);
+    return uint_to_unit_float(random_int(e));
+}
+
+vector<Expr> random_ints_philox(const vector<Expr> &e) {
+    internal_assert(e.size());
+    size_t next = 0;
+    auto take = [&]() {
+        if (next < e.size()) {
+            internal_assert(e[next].type() == Int(32) || e[next].type() == UInt(32));
+            return cast<uint32_t>(e[next++]);
+        }
+        return make_zero(UInt(32));
+    };
+
+    // The first four inputs are the counter, and the next two are the
+    // key. The caller should put the inputs that vary the most
+    // first, so that the key is usually a constant, and the key
+    // schedule folds away.
+    Expr c[4], k[2];
+    for (Expr &ci : c) {
+        ci = take();
+    }
+    for (Expr &ki : k) {
+        ki = take();
+    }
+
+    // Each round uses both halves of each product, so bind the
+    // products to lets to keep the size of the expression linear in
+    // the number of rounds.
+    vector<std::pair<string, Expr>> lets;
+    while (true) {
+        for (int r = 0; r < philox_rounds; r++) {
+            string p0_name = unique_name('P'), p1_name = unique_name('P');
+            lets.emplace_back(p0_name, cast<uint64_t>(c[0]) * make_const(UInt(64), philox_m0));
+            lets.emplace_back(p1_name, cast<uint64_t>(c[2]) * make_const(UInt(64), philox_m1));
+            Expr p0 = Variable::make(UInt(64), p0_name);
+            Expr p1 = Variable::make(UInt(64), p1_name);
+            Expr hi0 = cast<uint32_t>(p0 >> 32), lo0 = cast<uint32_t>(p0);
+            Expr hi1 = cast<uint32_t>(p1 >> 32), lo1 = cast<uint32_t>(p1);
+            c[0] = hi1 ^ c[1] ^ k[0];
+            c[1] = lo1;
+            c[2] = hi0 ^ c[3] ^ k[1];
+            c[3] = lo0;
+            k[0] = k[0] + make_const(UInt(32), philox_w0);
+            k[1] = k[1] + make_const(UInt(32), philox_w1);
+        }
+        if (next >= e.size()) {
+            break;
+        }
+        // Fold any remaining inputs into the counter and go again.
+        for (Expr &ci : c) {
+            ci = ci ^ take();
+        }
+    }
+
+    vector<Expr> result;
+    for (const Expr &ci : c) {
+        Expr r = ci;
+        for (auto it = lets.rbegin(); it != lets.rend(); it++) {
+            r = Let::make(it->first, it->second, r);
+        }
+        result.push_back(r);
+    }
+    return result;
 }
 
 namespace {
@@ -100,14 +183,29 @@ class LowerRandom : public IRMutator {
 
     Expr visit(const Call *op) override {
         if (op->is_intrinsic(Call::random)) {
-            vector<Expr> args = op->args;
-            args.insert(args.end(), extra_args.begin(), extra_args.end());
+            internal_assert(!op->args.empty() && op->args.size() <= 2);
+            const int64_t *id = as_const_int(op->args.back());
+            internal_assert(id) << "The last argument to random() should be a constant id\n";
+
+            // The free vars go first, as they're the part of the
+            // counter that varies. Calls with ids that differ only in
+            // bits 1 and 2 (i.e. up to four random_float or four
+            // random_uint calls in a row) share a block, and take
+            // different words from it.
+            vector<Expr> args = free_args;
+            args.emplace_back(tag);
+            args.emplace_back((int)(*id & ~6));
+            if (op->args.size() == 2) {
+                args.push_back(op->args[0]);
+            }
+            Expr bits = block(args)[(*id >> 1) & 3];
+
             if (op->type == Float(32)) {
-                return random_float(args);
+                return uint_to_unit_float(bits);
             } else if (op->type == Int(32)) {
-                return cast<int32_t>(random_int(args));
+                return cast<int32_t>(bits);
             } else if (op->type == UInt(32)) {
-                return random_int(args);
+                return bits;
             } else {
                 internal_error << "The intrinsic random() returns an Int(32), UInt(32) or a Float(32).\n";
                 return Expr();
@@ -117,16 +215,33 @@ class LowerRandom : public IRMutator {
         }
     }
 
-    vector<Expr> extra_args;
+    // Get the four words of random bits for a counter, reusing the
+    // same Exprs for calls that share a block, so that common
+    // subexpression elimination can find them.
+    const vector<Expr> &block(const vector<Expr> &args) {
+        for (const auto &b : blocks) {
+            if (b.first.size() == args.size() &&
+                std::equal(args.begin(), args.end(), b.first.begin(),
+                           [](const Expr &a, const Expr &b) { return equal(a, b); })) {
+                return b.second;
+            }
+        }
+        blocks.emplace_back(args, random_ints_philox(args));
+        return blocks.back().second;
+    }
+
+    vector<Expr> free_args;
+    int tag;
+    vector<std::pair<vector<Expr>, vector<Expr>>> blocks;
 
 public:
-    LowerRandom(const vector<VarOrRVar> &free_vars, int tag) {
-        extra_args.emplace_back(tag);
+    LowerRandom(const vector<VarOrRVar> &free_vars, int tag)
+        : tag(tag) {
         for (const VarOrRVar &v : free_vars) {
             if (v.is_rvar) {
-                extra_args.push_back(v.rvar);
+                free_args.push_back(v.rvar);
             } else {
-                extra_args.push_back(v.var);
+                free_args.push_back(v.var);
             }
         }
     }
@@ -23,9 +23,20 @@ Expr random_float(const std::vector<Expr> &);
  * be integers or unsigned integers). */
 Expr random_int(const std::vector<Expr> &);
 
-/** Convert calls to random() to IR generated by random_float and
- * random_int. Tags all calls with the variables in free_vars, and the
- * integer given as the last argument. */
+/** Return four independent random unsigned integers that vary
+ * deterministically based on the input expressions (which must be
+ * integers or unsigned integers), using the counter-based Philox-4x32
+ * generator. Costs two 32x32->64 multiplies per round, which
+ * vectorize on x86 and ARM. The first four inputs form the counter
+ * and the next two the key, so inputs that vary the most should come
+ * first. Any further inputs are mixed in with extra rounds. */
+std::vector<Expr> random_ints_philox(const std::vector<Expr> &);
+
+/** Convert calls to random() to IR generated by
+ * random_ints_philox. Tags all calls with the variables in free_vars,
+ * and the integer given as the last argument. Up to four calls to
+ * random_float (or four calls to random_uint) with the same seed in a
+ * definition share a single evaluation of the generator. */
 Expr lower_random(const Expr &e, const std::vector<VarOrRVar> &free_vars, int tag);
 
 }  // namespace Internal
@@ -0,0 +1,449 @@
+#include "RegisterPromotion.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "IRVisitor.h"
+#include "Scope.h"
+#include "Simplify.h"
+#include "Util.h"
+
+#include <utility>
+
+namespace Halide {
+namespace Internal {
+
+using std::pair;
+using std::string;
+using std::vector;
+
+namespace {
+
+// Allocations not explicitly placed in registers are only promoted if
+// they're at most this big.
+const int max_promoted_bytes = 256;
+
+// Get the element indices touched by a load or store, if they're all
+// constants.
+bool constant_indices(const Expr &index, vector<int64_t> *result) {
+    result->clear();
+    if (const int64_t *i = as_const_int(index)) {
+        result->push_back(*i);
+        return true;
+    } else if (const Ramp *r = index.as<Ramp>()) {
+        const int64_t *base = as_const_int(r->base);
+        const int64_t *stride = as_const_int(r->stride);
+        if (base && stride) {
+            for (int i = 0; i < r->lanes; i++) {
+                result->push_back(*base + *stride * i);
+            }
+            return true;
+        }
+    } else if (const Broadcast *b = index.as<Broadcast>()) {
+        if (const int64_t *i = as_const_int(b->value)) {
+            result->resize(b->lanes, *i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Flattened indices into small allocations are often only constant
+// once the lets for the bounds of the allocation and of the loops
+// that fill it are substituted in (e.g. x - f.s0.x.min_realized, where
+// x is f.s0.x.loop_min plus a constant, and the two mins are equal).
+// Replace any such indices with the constants.
+class MakeIndicesConstant : public IRMutator {
+    using IRMutator::visit;
+
+    const string &name;
+    Scope<Expr> &lets;
+
+    // Substitute in all the lets an index depends on.
+    class ExpandLets : public IRMutator {
+        using IRMutator::visit;
+
+        Expr visit(const Variable *op) override {
+            if (lets.contains(op->name)) {
+                return mutate(lets.get(op->name));
+            }
+            return op;
+        }
+
+    public:
+        const Scope<Expr> &lets;
+        ExpandLets(const Scope<Expr> &l)
+            : lets(l) {
+        }
+    };
+
+    Expr constant_index(const Expr &index) {
+        vector<int64_t> indices;
+        if (constant_indices(index, &indices)) {
+            return index;
+        }
+        Expr expanded = simplify(ExpandLets(lets).mutate(index));
+        if (constant_indices(expanded, &indices)) {
+            return expanded;
+        }
+        return index;
+    }
+
+    Stmt visit(const LetStmt *op) override {
+        ScopedBinding<Expr> bind(lets, op->name, op->value);
+        return IRMutator::visit(op);
+    }
+
+    Expr visit(const Load *op) override {
+        if (op->name != name) {
+            return IRMutator::visit(op);
+        }
+        Expr index = constant_index(op->index);
+        if (index.same_as(op->index)) {
+            return op;
+        }
+        return Load::make(op->type, op->name, index, op->image, op->param, op->predicate, op->alignment);
+    }
+
+    Stmt visit(const Store *op) override {
+        if (op->name != name) {
+            return IRMutator::visit(op);
+        }
+        Expr value = mutate(op->value);
+        Expr index = constant_index(op->index);
+        if (index.same_as(op->index) && value.same_as(op->value)) {
+            return op;
+        }
+        return Store::make(op->name, value, index, op->param, op->predicate, op->alignment);
+    }
+
+public:
+    MakeIndicesConstant(const string &n, Scope<Expr> &l)
+        : name(n), lets(l) {
+    }
+};
+
+// Check the accesses to an allocation are all of a form we can turn
+// into lets. Doesn't check the control flow around them.
+class CheckAccesses : public IRVisitor {
+    using IRVisitor::visit;
+
+    const string &name;
+    Type type;
+    int size;
+    vector<int64_t> indices;
+
+    void check_access(Type t, const Expr &index, const Expr &predicate) {
+        if (!failure.empty()) {
+            return;
+        }
+        if (!is_const_one(predicate)) {
+            failure = "it has a predicated load or store";
+        } else if (t.element_of() != type) {
+            failure = "it is accessed with a type other than the one it was allocated with";
+        } else if (!constant_indices(index, &indices)) {
+            failure = "it is accessed at a non-constant index";
+        } else {
+            for (int64_t i : indices) {
+                if (i < 0 || i >= size) {
+                    failure = "it is accessed out of bounds";
+                }
+            }
+        }
+    }
+
+    void visit(const Load *op) override {
+        if (op->name == name) {
+            check_access(op->type, op->index, op->predicate);
+        }
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Store *op) override {
+        if (op->name == name) {
+            check_access(op->value.type(), op->index, op->predicate);
+            if (failure.empty() && op->index.as<Broadcast>()) {
+                failure = "it has a store of several values to the same index";
+            }
+        }
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Variable *op) override {
+        if (op->name == name || op->name == name + ".buffer") {
+            failure = "its address is taken";
+        }
+    }
+
+public:
+    string failure;
+
+    CheckAccesses(const string &n, Type t, int s)
+        : name(n), type(t), size(s) {
+    }
+};
+
+class StoresTo : public IRVisitor {
+    using IRVisitor::visit;
+
+    const string &name;
+
+    void visit(const Store *op) override {
+        result = result || op->name == name;
+        IRVisitor::visit(op);
+    }
+
+public:
+    bool result = false;
+    StoresTo(const string &n)
+        : name(n) {
+    }
+};
+
+bool stores_to(const Stmt &s, const string &name) {
+    StoresTo v(name);
+    s.accept(&v);
+    return v.result;
+}
+
+// The current value of each element of an allocation, as a lane of a
+// let that held a stored value. Rewrites loads as references to those
+// lets.
+class ReplaceLoads : public IRMutator {
+    using IRMutator::visit;
+
+    const string &name;
+
+    Expr visit(const Load *op) override {
+        if (op->name != name) {
+            return IRMutator::visit(op);
+        }
+        vector<int64_t> indices;
+        internal_assert(constant_indices(op->index, &indices));
+
+        vector<Expr> vectors;
+        vector<int> shuffle_indices;
+        for (int64_t i : indices) {
+            const pair<Expr, int> &e = elements[i];
+            if (!e.first.defined()) {
+                if (failure.empty()) {
+                    failure = "it is loaded from before it is stored to";
+                }
+                return op;
+            }
+            int offset = 0;
+            size_t j = 0;
+            while (j < vectors.size() && !vectors[j].same_as(e.first)) {
+                offset += vectors[j].type().lanes();
+                j++;
+            }
+            if (j == vectors.size()) {
+                vectors.push_back(e.first);
+            }
+            shuffle_indices.push_back(offset + e.second);
+        }
+
+        if (vectors.size() == 1 && vectors[0].type().lanes() == op->type.lanes()) {
+            bool identity = true;
+            for (int i = 0; i < op->type.lanes(); i++) {
+                identity = identity && shuffle_indices[i] == i;
+            }
+            if (identity) {
+                return vectors[0];
+            }
+        }
+        return Shuffle::make(vectors, shuffle_indices);
+    }
+
+public:
+    vector<pair<Expr, int>> elements;
+    string failure;
+
+    ReplaceLoads(const string &n, int size)
+        : name(n), elements(size) {
+    }
+};
+
+// Rewrite the body of an allocation, in program order, with each
+// store to the allocation turned into a let around the rest of the
+// body.
+class Promote {
+    const Allocate *alloc;
+    ReplaceLoads replacer;
+
+    // The statements and lets making up the rewritten body, in
+    // order. A let is represented by a name and value, and a
+    // statement by an undefined value.
+    vector<pair<string, Expr>> lets;
+    vector<Stmt> stmts;
+
+    void emit_let(const string &name, const Expr &value) {
+        lets.emplace_back(name, value);
+        stmts.emplace_back();
+    }
+
+    void emit_stmt(const Stmt &s) {
+        lets.emplace_back();
+        stmts.push_back(s);
+    }
+
+public:
+    string failure;
+
+    Promote(const Allocate *op, int size)
+        : alloc(op), replacer(op->name, size) {
+    }
+
+    Stmt run() {
+        // Statements left to do, with the next one at the back.
+        vector<Stmt> todo = {alloc->body};
+        while (!todo.empty() && failure.empty()) {
+            Stmt s = todo.back();
+            todo.pop_back();
+            const Block *block = s.as<Block>();
+            const ProducerConsumer *pc = s.as<ProducerConsumer>();
+            const Free *free = s.as<Free>();
+            const LetStmt *let = s.as<LetStmt>();
+            const Store *store = s.as<Store>();
+            if (block) {
+                todo.push_back(block->rest);
+                todo.push_back(block->first);
+            } else if (pc && pc->name == alloc->name) {
+                // The Func stored in this allocation is going away,
+                // so its producer and consumer markers can go too.
+                todo.push_back(pc->body);
+            } else if (free && free->name == alloc->name) {
+                // Nothing to free.
+            } else if (let && stores_to(let->body, alloc->name)) {
+                emit_let(let->name, replacer.mutate(let->value));
+                todo.push_back(let->body);
+            } else if (store && store->name == alloc->name) {
+                Expr value = replacer.mutate(store->value);
+                string name = unique_name(alloc->name);
+                emit_let(name, value);
+                Expr var = Variable::make(value.type(), name);
+                vector<int64_t> indices;
+                internal_assert(constant_indices(store->index, &indices));
+                for (int i = 0; i < (int)indices.size(); i++) {
+                    replacer.elements[indices[i]] = {var, i};
+                }
+            } else if (stores_to(s, alloc->name)) {
+                if (s.as<For>()) {
+                    failure = "it is stored to inside a loop that is not unrolled";
+                } else {
+                    failure = "it is stored to under control flow";
+                }
+            } else {
+                emit_stmt(replacer.mutate(s));
+            }
+            if (failure.empty()) {
+                failure = replacer.failure;
+            }
+        }
+        if (!failure.empty()) {
+            return Stmt();
+        }
+
+        Stmt result;
+        for (size_t i = stmts.size(); i > 0; i--) {
+            if (stmts[i - 1].defined()) {
+                result = result.defined() ? Block::make(stmts[i - 1], result) : stmts[i - 1];
+            } else {
+                if (!result.defined()) {
+                    result = Evaluate::make(0);
+                }
+                result = LetStmt::make(lets[i - 1].first, lets[i - 1].second, result);
+            }
+        }
+        return result.defined() ? result : Evaluate::make(0);
+    }
+};
+
+class PromoteAllocationsToRegisters : public IRMutator {
+    using IRMutator::visit;
+
+    bool in_device_loop = false;
+
+    // The lets outside the allocation being considered.
+    Scope<Expr> lets;
+
+    Stmt visit(const LetStmt *op) override {
+        ScopedBinding<Expr> bind(lets, op->name, op->value);
+        return IRMutator::visit(op);
+    }
+
+    Stmt visit(const For *op) override {
+        // GPU backends allocate registers themselves.
+        bool device_loop = (op->device_api != DeviceAPI::None &&
+                            op->device_api != DeviceAPI::Host);
+        ScopedValue<bool> old_in_device_loop(in_device_loop, in_device_loop || device_loop);
+        return IRMutator::visit(op);
+    }
+
+    Stmt visit(const Allocate *op) override {
+        Stmt body = mutate(op->body);
+        Stmt stmt = op;
+        if (!body.same_as(op->body)) {
+            stmt = Allocate::make(op->name, op->type, op->memory_type, op->extents,
+                                  op->condition, body, op->new_expr, op->free_function);
+        }
+        op = stmt.as<Allocate>();
+
+        const bool explicit_register = op->memory_type == MemoryType::Register;
+        if (in_device_loop ||
+            !(explicit_register ||
+              op->memory_type == MemoryType::Auto ||
+              op->memory_type == MemoryType::Stack) ||
+            op->new_expr.defined()) {
+            return stmt;
+        }
+
+        int size = Allocate::constant_allocation_size(op->extents, op->name);
+        string failure;
+        if (size <= 0) {
+            failure = "it does not have a constant size";
+        } else if (!explicit_register && size * op->type.bytes() > max_promoted_bytes) {
+            // Too big to be worth trying.
+            return stmt;
+        } else {
+            Stmt body = MakeIndicesConstant(op->name, lets).mutate(op->body);
+            if (!body.same_as(op->body)) {
+                stmt = Allocate::make(op->name, op->type, op->memory_type, op->extents,
+                                      op->condition, body, op->new_expr, op->free_function);
+                op = stmt.as<Allocate>();
+            }
+            CheckAccesses check(op->name, op->type, size);
+            op->body.accept(&check);
+            failure = check.failure;
+        }
+
+        Stmt promoted;
+        if (failure.empty()) {
+            Promote promote(op, size);
+            promoted = promote.run();
+            failure = promote.failure;
+        }
+
+        if (!failure.empty()) {
+            if (explicit_register) {
+                user_warning << "Could not promote allocation " << op->name
+                             << " to registers, because " << failure
+                             << ". It will be stored on the stack instead.\n";
+            } else {
+                debug(3) << "Not promoting allocation " << op->name
+                         << " to registers, because " << failure << "\n";
+            }
+            return stmt;
+        }
+
+        debug(3) << "Promoted allocation " << op->name << " to registers\n";
+        return promoted;
+    }
+};
+
+}  // namespace
+
+Stmt promote_allocations_to_registers(const Stmt &s) {
+    return PromoteAllocationsToRegisters().mutate(s);
+}
+
+}  // namespace Internal
+}  // namespace Halide
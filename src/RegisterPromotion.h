@@ -0,0 +1,29 @@
+#ifndef HALIDE_REGISTER_PROMOTION_H
+#define HALIDE_REGISTER_PROMOTION_H
+
+/** \file
+ * Defines the lowering pass that replaces small allocations with lets.
+ */
+
+#include "Expr.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Replace small constant-size host allocations that are only ever
+ * accessed at constant indices, from straight-line code, with a let
+ * per store and direct references to those lets in place of loads
+ * (i.e. scalar replacement). This is what makes
+ * MemoryType::Register work on the CPU without relying on LLVM to
+ * promote the stack array, which it often fails to do for fully
+ * unrolled vector code. Allocations explicitly placed in registers
+ * that can't be promoted (e.g. because they're stored to inside a
+ * loop that isn't unrolled) are left on the stack with a warning
+ * saying why. Must be run after storage flattening, unrolling, and
+ * vectorization. */
+Stmt promote_allocations_to_registers(const Stmt &s);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
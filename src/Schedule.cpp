@@ -219,8 +219,11 @@ struct FuncScheduleContents {
     std::vector<Bound> estimates;
     std::map<std::string, Internal::FunctionPtr> wrappers;
     MemoryType memory_type = MemoryType::Auto;
-    bool memoized = false, async = false;
+    bool memoized = false, async = false, interleave_tuple = false;
+    bool compute_at_compile_time = false;
+    std::vector<VectorExternVariant> vector_externs;
     Expr memoize_eviction_key;
+    Parameter aliased_input;
 
     FuncScheduleContents()
         : store_level(LoopLevel::inlined()), compute_level(LoopLevel::inlined()){};
@@ -339,6 +342,10 @@ FuncSchedule FuncSchedule::deep_copy(
     copy.contents->memoized = contents->memoized;
     copy.contents->memoize_eviction_key = contents->memoize_eviction_key;
     copy.contents->async = contents->async;
+    copy.contents->interleave_tuple = contents->interleave_tuple;
+    copy.contents->compute_at_compile_time = contents->compute_at_compile_time;
+    copy.contents->vector_externs = contents->vector_externs;
+    copy.contents->aliased_input = contents->aliased_input;
 
     // Deep-copy wrapper functions.
     for (const auto &iter : contents->wrappers) {
@@ -350,6 +357,22 @@ FuncSchedule FuncSchedule::deep_copy(
     return copy;
 }
 
+bool &FuncSchedule::interleave_tuple() {
+    return contents->interleave_tuple;
+}
+
+bool FuncSchedule::interleave_tuple() const {
+    return contents->interleave_tuple;
+}
+
+const Parameter &FuncSchedule::aliased_input() const {
+    return contents->aliased_input;
+}
+
+Parameter &FuncSchedule::aliased_input() {
+    return contents->aliased_input;
+}
+
 MemoryType FuncSchedule::memory_type() const {
     return contents->memory_type;
 }
@@ -382,6 +405,22 @@ bool FuncSchedule::async() const {
     return contents->async;
 }
 
+bool &FuncSchedule::compute_at_compile_time() {
+    return contents->compute_at_compile_time;
+}
+
+bool FuncSchedule::compute_at_compile_time() const {
+    return contents->compute_at_compile_time;
+}
+
+std::vector<VectorExternVariant> &FuncSchedule::vector_externs() {
+    return contents->vector_externs;
+}
+
+const std::vector<VectorExternVariant> &FuncSchedule::vector_externs() const {
+    return contents->vector_externs;
+}
+
 std::vector<StorageDim> &FuncSchedule::storage_dims() {
     return contents->storage_dims;
 }
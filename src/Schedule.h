@@ -12,6 +12,7 @@
 
 #include "DeviceAPI.h"
 #include "Expr.h"
+#include "ExternVectorVariants.h"
 #include "FunctionPtr.h"
 #include "Parameter.h"
 #include "PrefetchDirective.h"
@@ -391,6 +392,11 @@ struct Dim {
      * loop (see the DimType enum above). */
     DimType dim_type;
 
+    /** For parallel loops, the smallest number of iterations a
+     * worker thread should claim at once. Zero lets the thread pool
+     * decide. Set by Func::parallel_grain. */
+    int grain_size;
+
     /** Can this loop be evaluated in any order (including in
      * parallel)? Equivalently, are there no data hazards between
      * evaluations of the Func at distinct values of this var? */
@@ -540,6 +546,20 @@ public:
     bool &async();
     bool async() const;
 
+    /** Is this Function evaluated during compilation, with its
+     * results embedded in the pipeline as a constant buffer. */
+    // @{
+    bool &compute_at_compile_time();
+    bool compute_at_compile_time() const;
+    // @}
+
+    /** The vector variants of pure extern functions declared by
+     * this Function with Func::vector_extern. */
+    // @{
+    std::vector<VectorExternVariant> &vector_externs();
+    const std::vector<VectorExternVariant> &vector_externs() const;
+    // @}
+
     /** The list and order of dimensions used to store this
      * function. The first dimension in the vector corresponds to the
      * innermost dimension for storage (i.e. which dimension is
@@ -555,6 +575,21 @@ public:
     MemoryType &memory_type();
     // @}
 
+    /** Are the elements of this Tuple-valued Function stored
+     * interleaved in a single allocation, rather than in one
+     * allocation each. See \ref Func::store_tuple_interleaved */
+    // @{
+    bool interleave_tuple() const;
+    bool &interleave_tuple();
+    // @}
+
+    /** The input buffer that the output buffer of this Function may
+     * be the same memory as, if any. See \ref Func::aliases */
+    // @{
+    const Parameter &aliased_input() const;
+    Parameter &aliased_input();
+    // @}
+
     /** You may explicitly bound some of the dimensions of a function,
      * or constrain them to lie on multiples of a given factor. See
      * \ref Func::bound and \ref Func::align_bounds */
@@ -0,0 +1,281 @@
+#include "ScratchBytesQuery.h"
+#include "Bounds.h"
+#include "ExprUsesVar.h"
+#include "IROperator.h"
+#include "IRVisitor.h"
+#include "Scope.h"
+#include "ScratchPool.h"
+#include "Simplify.h"
+#include "UnpackBuffers.h"
+#include "Util.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::string;
+using std::vector;
+
+namespace {
+
+// Find whether an Expr can't be evaluated by the query: it reads
+// memory, which the query doesn't have, or it calls something other
+// than the accessors of a buffer argument, which might have side
+// effects.
+class CantEvaluate : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const Load *op) override {
+        result = true;
+    }
+
+    void visit(const Call *op) override {
+        // The buffer accessors are extern calls to runtime functions
+        // that just read fields of the halide_buffer_t.
+        if (op->call_type != Call::PureIntrinsic &&
+            !starts_with(op->name, "_halide_buffer_get_")) {
+            result = true;
+        }
+        IRVisitor::visit(op);
+    }
+
+public:
+    bool result = false;
+};
+
+bool cant_evaluate(const Expr &e) {
+    CantEvaluate c;
+    e.accept(&c);
+    return c.result;
+}
+
+// The stack limit for constant-sized allocations in CodeGen_Posix
+// (see can_allocation_fit_on_stack). Larger ones, and Stack
+// allocations of dynamic size, come from halide_malloc.
+const int64_t max_stack_bytes = 16 * 1024;
+
+// Upper bounds on the size of the header in front of each block from
+// the scratch pool, and of the pool itself. These match
+// runtime/scratch_pool.cpp.
+const int64_t scratch_block_header_bytes = 128;
+const int64_t scratch_pool_bytes = 64 * 64 + 64;
+
+// Compute an upper bound on the peak number of bytes of heap memory
+// live at once during a Stmt, as an expression in terms of the
+// pipeline's arguments.
+class PeakScratchBytes : public IRVisitor {
+    using IRVisitor::visit;
+
+    // Bounds of the loop variables, and of the lets that depend on
+    // them or that the query can't evaluate.
+    Scope<Interval> scope;
+
+    // The peak bytes of allocations that are freed at the end of
+    // their scope.
+    Expr result = make_zero(UInt(64));
+
+    // The bytes of the pseudostack allocations in the function
+    // (pipeline or parallel task) being visited. Those are only
+    // freed when it returns. A pseudostack slot is reused by each
+    // execution of its allocation, so each counts once.
+    Expr pseudostack = make_zero(UInt(64));
+
+    // The total bytes requested from the scratch pool, counting each
+    // iteration of the enclosing loops. The pool hangs on to freed
+    // blocks until the pipeline returns, and may hand a larger block
+    // than needed to a later request, so the memory it holds is only
+    // bounded by the sum of everything ever requested from it.
+    Expr pooled = make_zero(UInt(64));
+    bool pool_used = false;
+
+    // The number of iterations of the loops enclosing the Stmt being
+    // visited, or undefined if unbounded.
+    Expr trips = make_one(UInt(64));
+
+    Expr peak(const Stmt &s) {
+        Expr old = result;
+        result = make_zero(UInt(64));
+        s.accept(this);
+        Expr r = result;
+        result = old;
+        return r;
+    }
+
+    // The peak of a Stmt that runs as a function of its own, in which
+    // the pseudostack allocations are made and freed.
+    Expr function_peak(const Stmt &s) {
+        Expr old = pseudostack;
+        pseudostack = make_zero(UInt(64));
+        Expr r = peak(s) + pseudostack;
+        pseudostack = old;
+        return r;
+    }
+
+    Expr upper_bound(const Expr &e) {
+        Interval i = bounds_of_expr_in_scope(e, scope);
+        if (!i.has_upper_bound()) {
+            debug(2) << "Can't bound " << e << "\n";
+            bounded = false;
+            return make_zero(e.type());
+        }
+        return i.max;
+    }
+
+    void visit(const Allocate *op) override {
+        Expr body = peak(op->body);
+        const bool from_pool = is_pooled_scratch(op);
+        // Other allocations with a custom allocator don't come from
+        // the heap, and neither does memory on the device.
+        if ((op->new_expr.defined() && !from_pool) ||
+            (op->memory_type != MemoryType::Auto &&
+             op->memory_type != MemoryType::Heap &&
+             op->memory_type != MemoryType::Stack)) {
+            result = body;
+            return;
+        }
+        // Small constant-sized allocations go on the stack, unless
+        // they're explicitly on the heap.
+        int64_t constant_bytes = Allocate::constant_allocation_size(op->extents, op->name) * (int64_t)op->type.bytes();
+        if (op->memory_type != MemoryType::Heap &&
+            constant_bytes > 0 && constant_bytes <= max_stack_bytes) {
+            result = body;
+            return;
+        }
+
+        // Match the padding of a heap allocation in CodeGen_Posix: we
+        // may load one scalar past the end.
+        Expr size = make_const(UInt(64), op->type.bytes());
+        for (const Expr &e : op->extents) {
+            size *= cast(UInt(64), max(upper_bound(e), 0));
+        }
+        size += op->type.bytes();
+
+        if (from_pool) {
+            size += make_const(UInt(64), scratch_block_header_bytes);
+            pool_used = true;
+            if (trips.defined()) {
+                pooled += size * trips;
+            } else {
+                debug(2) << "Can't bound the trip count of " << op->name << "\n";
+                bounded = false;
+            }
+            result = body;
+        } else if (op->memory_type == MemoryType::Stack) {
+            pseudostack += size;
+            result = body;
+        } else {
+            result = size + body;
+        }
+    }
+
+    void visit(const Block *op) override {
+        result = max(peak(op->first), peak(op->rest));
+    }
+
+    void visit(const Fork *op) override {
+        // Both branches run at the same time, as tasks of their own.
+        result = function_peak(op->first) + function_peak(op->rest);
+    }
+
+    void visit(const IfThenElse *op) override {
+        Expr then_bytes = peak(op->then_case);
+        if (op->else_case.defined()) {
+            result = max(then_bytes, peak(op->else_case));
+        } else {
+            result = then_bytes;
+        }
+    }
+
+    void visit(const For *op) override {
+        if (op->device_api != DeviceAPI::None &&
+            op->device_api != DeviceAPI::Host) {
+            return;
+        }
+        Interval min_bounds = bounds_of_expr_in_scope(op->min, scope);
+        Interval max_bounds = bounds_of_expr_in_scope(op->min + op->extent - 1, scope);
+        Interval extent_bounds = bounds_of_expr_in_scope(op->extent, scope);
+        Expr old_trips = trips;
+        if (trips.defined() && extent_bounds.has_upper_bound()) {
+            trips *= cast(UInt(64), max(extent_bounds.max, 0));
+        } else {
+            trips = Expr();
+        }
+        Expr body;
+        {
+            ScopedBinding<Interval> bind(scope, op->name, Interval(min_bounds.min, max_bounds.max));
+            if (op->is_parallel()) {
+                body = function_peak(op->body);
+            } else {
+                body = peak(op->body);
+            }
+        }
+        trips = old_trips;
+        if (op->is_parallel()) {
+            result = body * cast(UInt(64), max(upper_bound(op->extent), 0));
+        } else {
+            result = body;
+        }
+    }
+
+    void visit(const LetStmt *op) override {
+        if (expr_uses_vars(op->value, scope) || cant_evaluate(op->value)) {
+            ScopedBinding<Interval> bind(scope, op->name, bounds_of_expr_in_scope(op->value, scope));
+            result = peak(op->body);
+        } else {
+            Expr body = peak(op->body);
+            if (expr_uses_var(body, op->name) ||
+                expr_uses_var(pseudostack, op->name) ||
+                expr_uses_var(pooled, op->name)) {
+                result = Let::make(op->name, op->value, body);
+                pseudostack = Let::make(op->name, op->value, pseudostack);
+                pooled = Let::make(op->name, op->value, pooled);
+            } else {
+                result = body;
+            }
+        }
+    }
+
+public:
+    bool bounded = true;
+
+    Expr compute(const Stmt &s) {
+        Expr bytes = function_peak(s);
+        if (pool_used) {
+            bytes += make_const(UInt(64), scratch_pool_bytes) + pooled;
+        }
+        return bytes;
+    }
+};
+
+}  // namespace
+
+LoweredFunc scratch_bytes_query(const LoweredFunc &f) {
+    string name = f.name + "_scratch_bytes";
+    string result_name = "scratch_bytes";
+
+    PeakScratchBytes peak;
+    Expr bytes = peak.compute(f.body);
+    if (!peak.bounded) {
+        user_warning << "Could not bound the scratch memory used by " << f.name
+                     << " at compile time. " << name << " will report the maximum uint64 value.\n";
+        bytes = UInt(64).max();
+    }
+    bytes = simplify(bytes);
+    debug(2) << "Peak scratch bytes of " << f.name << ": " << bytes << "\n";
+
+    Parameter result_param(UInt(64), true, 0, result_name);
+    Stmt body = Store::make(result_name, bytes, 0, result_param,
+                            const_true(), ModulusRemainder());
+    Expr host = Variable::make(Handle(), result_name, result_param);
+    Expr error = Call::make(Int(32), "halide_error_host_is_null",
+                            {Expr(result_name)}, Call::Extern);
+    body = Block::make(AssertStmt::make(host != make_zero(Handle()), error), body);
+    body = unpack_buffers(body);
+
+    vector<LoweredArgument> args = f.args;
+    args.emplace_back(Argument(result_name, Argument::OutputBuffer, UInt(64), 0, ArgumentEstimates{}));
+
+    return LoweredFunc(name, args, body, LinkageType::External, f.name_mangling);
+}
+
+}  // namespace Internal
+}  // namespace Halide
@@ -0,0 +1,41 @@
+#ifndef HALIDE_SCRATCH_BYTES_QUERY_H
+#define HALIDE_SCRATCH_BYTES_QUERY_H
+
+/** \file
+ * Defines the pass that builds an entry point which predicts the scratch
+ * memory a pipeline will use, without running it.
+ */
+
+#include "Module.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Make a function named f.name + "_scratch_bytes", which takes the
+ * same arguments as f followed by a zero-dimensional uint64 output
+ * buffer, and writes into it an upper bound on the number of bytes of
+ * heap memory that f would have allocated at any one time for buffers
+ * of the given shapes. The query only inspects the shapes of the
+ * buffers passed to it: their host pointers may be null, and nothing
+ * is computed.
+ *
+ * The bound is derived from the allocations in f's body, using
+ * bounds inference over the enclosing loops. It follows where
+ * CodeGen_Posix puts each allocation: small constant-sized ones on the
+ * stack are free, Stack allocations too large for it are counted until
+ * the enclosing function returns, as the pseudostack keeps them, and
+ * every block requested from the scratch pool is counted, as the pool
+ * keeps freed blocks until the pipeline returns. Each iteration of a
+ * parallel loop is assumed to be live at once. Lets that the query
+ * can't evaluate, because they load from memory or call something
+ * other than a buffer accessor, are replaced by their bounds, so the
+ * query has no side effects. Device allocations, and memory allocated
+ * by extern stages, are not counted. If some allocation size can't be
+ * bounded at compile time, the query writes the maximum uint64
+ * value. */
+LoweredFunc scratch_bytes_query(const LoweredFunc &f);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
@@ -0,0 +1,104 @@
+#include "ScratchPool.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "Util.h"
+
+namespace Halide {
+namespace Internal {
+
+namespace {
+
+class PoolParallelScratch : public IRMutator {
+    using IRMutator::visit;
+
+    const std::string &pool_name;
+    bool in_parallel_loop = false;
+    bool in_device_loop = false;
+
+    Stmt visit(const For *op) override {
+        bool device_loop = (op->device_api != DeviceAPI::None &&
+                            op->device_api != DeviceAPI::Host);
+        ScopedValue<bool> old_in_parallel_loop(in_parallel_loop,
+                                               in_parallel_loop || op->for_type == ForType::Parallel);
+        ScopedValue<bool> old_in_device_loop(in_device_loop, in_device_loop || device_loop);
+        return IRMutator::visit(op);
+    }
+
+    Stmt visit(const Fork *op) override {
+        // The branches of a fork (async producers) also run as tasks
+        // in the thread pool.
+        ScopedValue<bool> old_in_parallel_loop(in_parallel_loop, true);
+        return IRMutator::visit(op);
+    }
+
+    Stmt visit(const Allocate *op) override {
+        Stmt body = mutate(op->body);
+        if (!in_parallel_loop ||
+            in_device_loop ||
+            op->memory_type != MemoryType::Auto ||
+            op->new_expr.defined() ||
+            Allocate::constant_allocation_size(op->extents, op->name) > 0) {
+            if (body.same_as(op->body)) {
+                return op;
+            }
+            return Allocate::make(op->name, op->type, op->memory_type, op->extents,
+                                  op->condition, body, op->new_expr, op->free_function);
+        }
+
+        debug(3) << "Getting scratch for " << op->name << " from the pool\n";
+        used = true;
+
+        // Match the size and padding of a heap allocation in
+        // CodeGen_Posix: we may load one scalar past the end.
+        Expr size = make_const(UInt(64), op->type.bytes());
+        for (const Expr &e : op->extents) {
+            size *= cast(UInt(64), e);
+        }
+        size += op->type.bytes();
+        size = select(op->condition, size, make_zero(UInt(64)));
+
+        Expr pool = Variable::make(Handle(), pool_name);
+        Expr new_expr = Call::make(Handle(), "halide_scratch_alloc", {pool, size}, Call::Extern);
+        return Allocate::make(op->name, op->type, op->memory_type, op->extents,
+                              op->condition, body, new_expr, "halide_scratch_free");
+    }
+
+public:
+    bool used = false;
+
+    PoolParallelScratch(const std::string &pool_name)
+        : pool_name(pool_name) {
+    }
+};
+
+}  // namespace
+
+bool is_pooled_scratch(const Allocate *op) {
+    const Call *alloc = op->new_expr.as<Call>();
+    return (alloc && alloc->name == "halide_scratch_alloc" &&
+            op->free_function == "halide_scratch_free");
+}
+
+Stmt pool_parallel_scratch(const Stmt &s) {
+    // A unique name, so that it can't clash with a Func or a Param.
+    const std::string pool_name = unique_name("scratch_pool");
+    PoolParallelScratch pooler(pool_name);
+    Stmt stmt = pooler.mutate(s);
+    if (!pooler.used) {
+        return s;
+    }
+
+    // Create the pool on entry, and destroy it on exit from the
+    // pipeline, whether or not there was an error. If the pool can't
+    // be allocated, scratch comes straight from the heap.
+    Expr pool = Variable::make(Handle(), pool_name);
+    Expr destructor = Call::make(Handle(), Call::register_destructor,
+                                 {Expr("halide_scratch_pool_destroy"), pool}, Call::Intrinsic);
+    stmt = Block::make(Evaluate::make(destructor), stmt);
+    return LetStmt::make(pool_name,
+                         Call::make(Handle(), "halide_scratch_pool_create", {}, Call::Extern),
+                         stmt);
+}
+
+}  // namespace Internal
+}  // namespace Halide
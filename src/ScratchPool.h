@@ -0,0 +1,31 @@
+#ifndef HALIDE_SCRATCH_POOL_H
+#define HALIDE_SCRATCH_POOL_H
+
+/** \file
+ * Defines the lowering pass that reuses the scratch memory of
+ * parallel tasks.
+ */
+
+#include "Expr.h"
+#include "IR.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Allocations of dynamic size inside parallel loops (e.g. a Func
+ * computed per tile, for tiles of runtime size) would otherwise call
+ * halide_malloc and halide_free once per task. Instead, get them from
+ * a pool of scratch blocks created once per call to the pipeline, so
+ * a block freed by one task is reused by the next one run on that
+ * thread. Only allocations with MemoryType::Auto on the host are
+ * affected; explicit heap allocations still go to the heap. */
+Stmt pool_parallel_scratch(const Stmt &s);
+
+/** Is this an allocation that pool_parallel_scratch moved into the
+ * pool? */
+bool is_pooled_scratch(const Allocate *op);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
@@ -0,0 +1,260 @@
+#include <algorithm>
+
+#include "Sorting.h"
+#include "IROperator.h"
+#include "Util.h"
+
+namespace Halide {
+
+using std::pair;
+using std::string;
+using std::vector;
+
+namespace {
+
+// A min/max pair that puts the smaller of wires a and b on a, and the
+// larger on b. Pruning can remove one of the two outputs.
+struct Comparator {
+    int a, b;
+    bool need_min, need_max;
+};
+
+// Batcher's odd-even merge sort for n wires. The network for the next
+// power of two is generated, and comparators that touch wires past n
+// are dropped, which is equivalent to padding the input with +inf.
+vector<Comparator> odd_even_merge_sort_network(int n) {
+    int size = 1;
+    while (size < n) {
+        size *= 2;
+    }
+    vector<Comparator> network;
+    for (int p = 1; p < size; p *= 2) {
+        for (int k = p; k >= 1; k /= 2) {
+            for (int j = k % p; j + k < size; j += 2 * k) {
+                for (int i = 0; i < std::min(k, size - j - k); i++) {
+                    int a = i + j, b = i + j + k;
+                    if (a / (2 * p) == b / (2 * p) && b < n) {
+                        network.push_back({a, b, true, true});
+                    }
+                }
+            }
+        }
+    }
+    return network;
+}
+
+// Remove the comparators and comparator outputs that none of the
+// needed wires depend on.
+vector<Comparator> prune_network(const vector<Comparator> &network, vector<bool> needed) {
+    vector<Comparator> result;
+    for (auto it = network.rbegin(); it != network.rend(); it++) {
+        Comparator c = *it;
+        c.need_min = needed[c.a];
+        c.need_max = needed[c.b];
+        if (c.need_min || c.need_max) {
+            needed[c.a] = needed[c.b] = true;
+            result.push_back(c);
+        }
+    }
+    std::reverse(result.begin(), result.end());
+    return result;
+}
+
+vector<Expr> apply_network(const vector<Expr> &values, const vector<Comparator> &network) {
+    user_assert(!values.empty()) << "Can't sort an empty list of values\n";
+    for (const Expr &v : values) {
+        user_assert(v.defined()) << "Can't sort an undefined Expr\n";
+        user_assert(v.type() == values[0].type())
+            << "All values to sort must have the same type. "
+            << v << " has type " << v.type()
+            << ", but " << values[0] << " has type " << values[0].type() << "\n";
+    }
+
+    // Every wire is used by two comparators, so bind them all to lets
+    // to keep the size of the expressions linear in the size of the
+    // network.
+    vector<pair<string, Expr>> lets;
+    auto bind = [&](const Expr &e) {
+        if (e.as<Internal::Variable>() || is_const(e)) {
+            return e;
+        }
+        string name = Internal::unique_name('s');
+        lets.emplace_back(name, e);
+        return Internal::Variable::make(e.type(), name);
+    };
+
+    vector<Expr> wires;
+    for (const Expr &v : values) {
+        wires.push_back(bind(v));
+    }
+    for (const Comparator &c : network) {
+        Expr a = wires[c.a], b = wires[c.b];
+        if (c.need_min) {
+            wires[c.a] = bind(min(a, b));
+        }
+        if (c.need_max) {
+            wires[c.b] = bind(max(a, b));
+        }
+    }
+
+    for (Expr &w : wires) {
+        for (auto it = lets.rbegin(); it != lets.rend(); it++) {
+            w = Internal::Let::make(it->first, it->second, w);
+        }
+    }
+    return wires;
+}
+
+}  // namespace
+
+vector<Expr> sorting_network(const vector<Expr> &values) {
+    return apply_network(values, odd_even_merge_sort_network((int)values.size()));
+}
+
+Expr median(const vector<Expr> &values) {
+    const int n = (int)values.size();
+    vector<bool> needed(n, false);
+    if (n > 0) {
+        needed[n / 2] = true;
+    }
+    vector<Comparator> network = prune_network(odd_even_merge_sort_network(n), needed);
+    return apply_network(values, network)[n / 2];
+}
+
+vector<Expr> top_k(const vector<Expr> &values, int k) {
+    const int n = (int)values.size();
+    user_assert(k > 0 && k <= n)
+        << "Can't take the top " << k << " of " << n << " values\n";
+    vector<bool> needed(n, false);
+    for (int i = n - k; i < n; i++) {
+        needed[i] = true;
+    }
+    vector<Comparator> network = prune_network(odd_even_merge_sort_network(n), needed);
+    vector<Expr> sorted = apply_network(values, network);
+    return vector<Expr>(sorted.rbegin(), sorted.rbegin() + k);
+}
+
+Func sorted(const Func &input, int extent, const string &name) {
+    user_assert(input.defined())
+        << "Can't sort undefined Func " << input.name() << "\n";
+    user_assert(input.outputs() == 1)
+        << "Can't sort Func " << input.name() << " because it returns a Tuple\n";
+    user_assert(extent > 0)
+        << "Can't sort Func " << input.name() << " over an extent of " << extent << "\n";
+
+    const Type t = input.output_types()[0];
+
+    // The first dimension is sorted. The others come along for the ride.
+    Var x(name + "_x");
+    vector<Var> args = {x};
+    for (int i = 1; i < input.dimensions(); i++) {
+        args.emplace_back(name + "_" + std::to_string(i));
+    }
+    auto at = [&](const Func &f, const Expr &i) {
+        vector<Expr> coords(args.begin(), args.end());
+        coords[0] = i;
+        return f(coords);
+    };
+    auto at_var = [&](const Var &v) {
+        vector<Var> coords = args;
+        coords[0] = v;
+        return coords;
+    };
+
+    // Round up to a power of two, and sort past the end as if the
+    // input were padded with the largest value of its type.
+    int padded_extent = 1;
+    while (padded_extent < extent) {
+        padded_extent *= 2;
+    }
+    const int block_size = std::min(padded_extent, 8);
+    const int vector_size = 8;
+
+    Func padded(name + "_padded");
+    padded(args) = select(x < extent, at(input, min(x, extent - 1)), t.max());
+
+    // Sort blocks in registers, vectorized across the blocks.
+    Var b(name + "_block");
+    Func blocks(name + "_blocks");
+    {
+        vector<Expr> values;
+        for (int i = 0; i < block_size; i++) {
+            values.push_back(at(padded, b * block_size + i));
+        }
+        blocks(at_var(b)) = Tuple(sorting_network(values));
+    }
+
+    Func prev(name + "_sorted_blocks");
+    {
+        vector<Expr> values;
+        for (int i = 0; i < block_size; i++) {
+            if (block_size > 1) {
+                values.push_back(at(blocks, x / block_size)[i]);
+            } else {
+                values.push_back(at(blocks, x));
+            }
+        }
+        prev(args) = mux(x % block_size, values);
+    }
+    if (padded_extent / block_size >= vector_size) {
+        blocks.compute_root().vectorize(b, vector_size);
+    } else {
+        blocks.compute_root();
+    }
+
+    // Merge pairs of sorted runs of length m into runs of length 2m.
+    for (int m = block_size; m < padded_extent; m *= 2) {
+        Expr k = x % (2 * m);
+        Expr a_base = x - k;
+        Expr b_base = a_base + m;
+        auto from_a = [&](const Expr &i) {
+            return at(prev, clamp(a_base + i, a_base, a_base + m - 1));
+        };
+        auto from_b = [&](const Expr &j) {
+            return at(prev, clamp(b_base + j, b_base, b_base + m - 1));
+        };
+
+        // Binary search for the number of values among the first k
+        // outputs that come from the first run. Ties go to the first
+        // run, so the merge is stable.
+        vector<pair<string, Expr>> lets;
+        auto bind = [&](const Expr &e) {
+            string name = Internal::unique_name('m');
+            lets.emplace_back(name, e);
+            return Internal::Variable::make(e.type(), name);
+        };
+        Expr lo = bind(max(k - m, 0));
+        Expr hi = bind(min(k, m));
+        for (int step = 1; step <= m; step *= 2) {
+            Expr mid = bind((lo + hi) / 2);
+            Expr searching = lo < hi;
+            Expr a_first = bind(from_a(mid) <= from_b(k - mid - 1));
+            Expr new_lo = bind(select(searching && a_first, mid + 1, lo));
+            hi = bind(select(searching && !a_first, mid, hi));
+            lo = new_lo;
+        }
+        Expr i = lo, j = k - lo;
+        Expr take_a = j >= m || (i < m && from_a(i) <= from_b(j));
+        Expr value = select(take_a, from_a(i), from_b(j));
+        for (auto it = lets.rbegin(); it != lets.rend(); it++) {
+            value = Internal::Let::make(it->first, it->second, value);
+        }
+
+        Func next(name + "_merge_" + std::to_string(2 * m));
+        next(args) = value;
+        prev.compute_root();
+        if (padded_extent >= 4096) {
+            Var xo, xi;
+            prev.split(x, xo, xi, 1024).parallel(xo).vectorize(xi, vector_size);
+        } else if (padded_extent >= vector_size) {
+            prev.vectorize(x, vector_size);
+        }
+        prev = next;
+    }
+
+    Func result(name);
+    result(args) = prev(args);
+    return result;
+}
+
+}  // namespace Halide
@@ -0,0 +1,63 @@
+#ifndef HALIDE_SORTING_H
+#define HALIDE_SORTING_H
+
+/** \file
+ * Defines helpers for sorting small lists of Exprs with networks of
+ * min and max operations, and for sorting a Func along a dimension.
+ */
+
+#include <string>
+#include <vector>
+
+#include "Expr.h"
+#include "Func.h"
+
+namespace Halide {
+
+/** Sort a small, fixed-size list of values into ascending order using
+ * Batcher's odd-even merge sorting network. Each comparison is a min
+ * and a max, so there are no branches or data-dependent memory
+ * accesses, and the result vectorizes cleanly. Useful for median
+ * filters and rank statistics over a small window, e.g.
+ *
+ \code
+ std::vector<Expr> window;
+ for (int dy = -1; dy <= 1; dy++) {
+     for (int dx = -1; dx <= 1; dx++) {
+         window.push_back(input(x + dx, y + dy));
+     }
+ }
+ f(x, y) = sorting_network(window)[4];
+ \endcode
+ *
+ * Comparators that do not affect any of the outputs used are removed
+ * by dead code elimination, but \ref median and \ref top_k prune the
+ * network directly, which is cheaper to compile. All values must have
+ * the same type. NaNs are not ordered consistently. */
+std::vector<Expr> sorting_network(const std::vector<Expr> &values);
+
+/** The median of a small, fixed-size list of values, computed with a
+ * sorting network pruned to the comparisons the middle element
+ * depends on. For an even number of values, returns the upper of the
+ * two middle values. */
+Expr median(const std::vector<Expr> &values);
+
+/** The k largest of a small, fixed-size list of values, in descending
+ * order, computed with a sorting network pruned to the comparisons
+ * those outputs depend on. */
+std::vector<Expr> top_k(const std::vector<Expr> &values, int k);
+
+/** Sort a single-valued Func along its first dimension, over the range
+ * [0, extent). Any other dimensions are independent. The returned
+ * Func is defined over the same range. Blocks of eight values are
+ * sorted in registers with a sorting network, and then merged
+ * pairwise until the whole range is sorted. Each output of a merge is
+ * found independently by a binary search for how many of its
+ * predecessors come from each input, so every pass vectorizes and
+ * parallelizes. The intermediate passes are scheduled compute_root;
+ * the returned Func is not scheduled. */
+Func sorted(const Func &input, int extent, const std::string &name = "sorted");
+
+}  // namespace Halide
+
+#endif
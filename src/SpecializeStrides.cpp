@@ -0,0 +1,86 @@
+#include "SpecializeStrides.h"
+#include "ExprUsesVar.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "IRVisitor.h"
+#include "Substitute.h"
+
+#include <map>
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::string;
+
+namespace {
+
+// Find the innermost strides of buffer parameters that have no
+// constraint on them. Constrained strides have already been replaced
+// with their constrained values by add_image_checks.
+class FindUnconstrainedStrides : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const Variable *op) override {
+        const Parameter &p = op->param;
+        if (p.defined() && p.is_buffer() && p.dimensions() > 0 &&
+            !p.stride_constraint(0).defined() &&
+            op->name == p.name() + ".stride.0") {
+            strides[op->name] = op;
+        }
+    }
+
+public:
+    map<string, Expr> strides;
+};
+
+class SpecializeOuterLoops : public IRMutator {
+    using IRMutator::visit;
+
+    const map<string, Expr> &strides;
+
+    Stmt visit(const For *op) override {
+        if (op->device_api != DeviceAPI::None &&
+            op->device_api != DeviceAPI::Host) {
+            return op;
+        }
+
+        Expr dense;
+        map<string, Expr> replacements;
+        for (const auto &p : strides) {
+            if (stmt_uses_var(op, p.first)) {
+                Expr c = (p.second == 1);
+                dense = dense.defined() ? (dense && c) : c;
+                replacements[p.first] = 1;
+            }
+        }
+        if (!dense.defined()) {
+            return op;
+        }
+
+        // Don't recurse: the condition is checked once per outermost
+        // loop nest, and the loops inside it are specialized along with
+        // it.
+        Stmt fast = substitute(replacements, Stmt(op));
+        return IfThenElse::make(dense, fast, op);
+    }
+
+public:
+    SpecializeOuterLoops(const map<string, Expr> &s)
+        : strides(s) {
+    }
+};
+
+}  // namespace
+
+Stmt specialize_strides(const Stmt &s) {
+    FindUnconstrainedStrides finder;
+    s.accept(&finder);
+    if (finder.strides.empty()) {
+        return s;
+    }
+    return SpecializeOuterLoops(finder.strides).mutate(s);
+}
+
+}  // namespace Internal
+}  // namespace Halide
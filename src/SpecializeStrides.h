@@ -0,0 +1,27 @@
+#ifndef HALIDE_SPECIALIZE_STRIDES_H
+#define HALIDE_SPECIALIZE_STRIDES_H
+
+/** \file
+ * Defines the lowering pass that versions loop nests on whether the
+ * input and output buffers with unconstrained strides are dense.
+ */
+
+#include "Expr.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Find the buffer parameters whose innermost stride has been left
+ * unconstrained (with dim(0).set_stride(Expr())), and wrap each
+ * outermost host loop nest that uses them in an if statement that
+ * checks at runtime whether they are all dense. The true branch is a
+ * copy of the loop nest with those strides replaced by one, so that
+ * it gets dense vector loads and stores, and simpler address
+ * arithmetic. The false branch is the generic loop nest. Should be run
+ * after storage flattening, and before buffer arguments are unpacked. */
+Stmt specialize_strides(const Stmt &s);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
@@ -8,6 +8,7 @@
 #include "IRPrinter.h"
 #include "Parameter.h"
 #include "Scope.h"
+#include "Simplify.h"
 
 #include <sstream>
 
@@ -23,6 +24,33 @@ using std::vector;
 
 namespace {
 
+// Can the elements of a tuple be stored interleaved in a single
+// allocation? Not if anything needs a buffer that describes one of
+// them on its own, or if they may be used on a device, which will
+// need such a buffer to copy them.
+class CanInterleaveTuple : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const Variable *op) override {
+        if (buffers.count(op->name)) {
+            result = false;
+        }
+    }
+
+    void visit(const For *op) override {
+        if (op->device_api != DeviceAPI::None &&
+            op->device_api != DeviceAPI::Host) {
+            result = false;
+        } else {
+            IRVisitor::visit(op);
+        }
+    }
+
+public:
+    set<string> buffers;
+    bool result = true;
+};
+
 class FlattenDimensions : public IRMutator {
 public:
     FlattenDimensions(const map<string, pair<Function, int>> &e,
@@ -42,6 +70,131 @@ private:
     Scope<> realizations;
     bool in_gpu = false;
 
+    // Constant bounds of the enclosing lets and loop variables, for
+    // deciding whether a row of symbolic size is worth padding.
+    Scope<Interval> bounds;
+
+    // The elements of tuples being stored interleaved, with the name
+    // of the allocation they share, their index in the tuple, the
+    // size of the tuple, and the bounds and type of the first element,
+    // which the layout of the allocation is based on.
+    struct InterleavedElement {
+        string allocation;
+        int index, elements;
+        Region bounds;
+        Type type;
+    };
+    map<string, InterleavedElement> interleaved;
+
+    // If the realization is the first element of a tuple that should
+    // be stored interleaved, and it's safe to do so, start storing
+    // all its elements in its allocation.
+    void start_interleaving(const Realize *op) {
+        auto iter = env.find(op->name);
+        if (iter == env.end()) {
+            return;
+        }
+        const Function &f = iter->second.first;
+        if (iter->second.second != 0 ||
+            f.outputs() < 2 ||
+            !f.schedule().interleave_tuple() ||
+            outputs.count(f.name()) ||
+            in_gpu ||
+            (op->memory_type != MemoryType::Auto &&
+             op->memory_type != MemoryType::Heap &&
+             op->memory_type != MemoryType::Stack)) {
+            return;
+        }
+        CanInterleaveTuple check;
+        for (int i = 0; i < f.outputs(); i++) {
+            check.buffers.insert(f.name() + "." + std::to_string(i) + ".buffer");
+        }
+        op->body.accept(&check);
+        if (!check.result) {
+            debug(2) << "Not storing the elements of " << f.name() << " interleaved, "
+                     << "because they are accessed through a buffer or on a device\n";
+            return;
+        }
+        for (int i = 0; i < f.outputs(); i++) {
+            interleaved[f.name() + "." + std::to_string(i)] = {op->name, i, f.outputs(), op->bounds, op->types[0]};
+        }
+    }
+
+    // Padding the rows of an allocation so that they start on vector
+    // boundaries can cost at most this fraction of its size.
+    static constexpr int max_row_padding_fraction = 8;
+
+    bool should_align_rows(const Realize *op) const {
+        return (target.has_feature(Target::AlignAllocations) &&
+                !in_gpu &&
+                (op->memory_type == MemoryType::Auto ||
+                 op->memory_type == MemoryType::Heap ||
+                 op->memory_type == MemoryType::Stack));
+    }
+
+    // Pad the innermost extent of an internal allocation up to a
+    // multiple of the vector width, so that a vector load or store
+    // that is aligned in one row is aligned in all of them. The
+    // simplifier sees the padded stride, so it can prove this to
+    // codegen. Rows are only padded if it costs less than
+    // 1/max_row_padding_fraction of the row. For symbolic extents,
+    // that has to follow from a constant lower bound on the extent,
+    // e.g. from the range of a Param it depends on.
+    Expr align_row(const Expr &extent, Type t) const {
+        const int vector_bytes = target.natural_vector_size(UInt(8));
+        if (t.bytes() >= vector_bytes || vector_bytes % t.bytes() != 0) {
+            return extent;
+        }
+        const int lanes = vector_bytes / t.bytes();
+        const int64_t *c = as_const_int(simplify(extent));
+        if (!c) {
+            Interval range = find_constant_bounds(extent, bounds);
+            const int64_t *min_extent = range.has_lower_bound() ? as_const_int(range.min) : nullptr;
+            if (!min_extent || (int64_t)(lanes - 1) * max_row_padding_fraction > *min_extent) {
+                return extent;
+            }
+            return ((extent + (lanes - 1)) / lanes) * lanes;
+        }
+        int64_t padded = ((*c + lanes - 1) / lanes) * lanes;
+        if ((padded - *c) * max_row_padding_fraction > *c) {
+            return extent;
+        }
+        return make_const(extent.type(), padded);
+    }
+
+    // The other elements of an interleaved tuple are indexed as if
+    // they were the first one, so they must have the same bounds and
+    // type.
+    void check_interleaved_element(const Realize *op) const {
+        auto it = interleaved.find(op->name);
+        if (it == interleaved.end() || it->second.index == 0) {
+            return;
+        }
+        const InterleavedElement &element = it->second;
+        internal_assert(op->types.size() == 1 && op->types[0] == element.type)
+            << "Element " << op->name << " of an interleaved tuple has type " << op->types[0]
+            << " instead of " << element.type << "\n";
+        internal_assert(op->bounds.size() == element.bounds.size())
+            << "Element " << op->name << " of an interleaved tuple has a different dimensionality\n";
+        for (size_t i = 0; i < op->bounds.size(); i++) {
+            internal_assert(can_prove(op->bounds[i].min == element.bounds[i].min) &&
+                            can_prove(op->bounds[i].extent == element.bounds[i].extent))
+                << "Element " << op->name << " of an interleaved tuple has bounds "
+                << "[" << op->bounds[i].min << ", " << op->bounds[i].extent << "] in dimension " << i
+                << " instead of [" << element.bounds[i].min << ", " << element.bounds[i].extent << "]\n";
+        }
+    }
+
+    // Redirect a load or store of an element of an interleaved tuple
+    // to the shared allocation.
+    void interleave_access(string &name, Expr &idx) {
+        auto it = interleaved.find(name);
+        if (it != interleaved.end()) {
+            idx += it->second.index;
+            name = it->second.allocation;
+        }
+    }
+
     Expr make_shape_var(string name, const string &field, size_t dim,
                         const Buffer<> &buf, const Parameter &param) {
         ReductionDomain rdom;
@@ -108,6 +261,8 @@ private:
 
     Stmt visit(const Realize *op) override {
         realizations.push(op->name);
+        start_interleaving(op);
+        check_interleaved_element(op);
 
         if (op->memory_type == MemoryType::GPUTexture) {
             textures.insert(op->name);
@@ -126,6 +281,14 @@ private:
 
         realizations.pop(op->name);
 
+        const InterleavedElement *element = nullptr;
+        {
+            auto it = interleaved.find(op->name);
+            if (it != interleaved.end()) {
+                element = &it->second;
+            }
+        }
+
         // The allocation extents of the function taken into account of
         // the align_storage directives. It is only used to determine the
         // host allocation size and the strides in halide_buffer_t objects (which
@@ -145,6 +308,8 @@ private:
                         Expr alignment = storage_dims[i].alignment;
                         if (alignment.defined()) {
                             allocation_extents[j] = ((extents[j] + alignment - 1) / alignment) * alignment;
+                        } else if (i == 0 && storage_dims.size() > 1 && !element && should_align_rows(op)) {
+                            allocation_extents[j] = align_row(extents[j], op->types[0]);
                         } else {
                             allocation_extents[j] = extents[j];
                         }
@@ -185,10 +350,19 @@ private:
             builder.extents.push_back(extent_var[i]);
             builder.strides.push_back(stride_var[i]);
         }
-        stmt = LetStmt::make(op->name + ".buffer", builder.build(), stmt);
+        if (!element) {
+            stmt = LetStmt::make(op->name + ".buffer", builder.build(), stmt);
+        }
 
-        // Make the allocation node
-        stmt = Allocate::make(op->name, op->types[0], op->memory_type, allocation_extents, condition, stmt);
+        // Make the allocation node. The elements of an interleaved
+        // tuple all live in the allocation of the first element,
+        // which has an extra innermost dimension.
+        if (!element) {
+            stmt = Allocate::make(op->name, op->types[0], op->memory_type, allocation_extents, condition, stmt);
+        } else if (element->index == 0) {
+            allocation_extents.insert(allocation_extents.begin(), element->elements);
+            stmt = Allocate::make(op->name, op->types[0], op->memory_type, allocation_extents, condition, stmt);
+        }
 
         // Compute the strides
         for (int i = (int)op->bounds.size() - 1; i > 0; i--) {
@@ -198,10 +372,11 @@ private:
             stmt = LetStmt::make(stride_name[j], stride, stmt);
         }
 
-        // Innermost stride is one
+        // Innermost stride is one, or the size of the tuple if its
+        // elements are interleaved
         if (dims > 0) {
             int innermost = storage_permutation.empty() ? 0 : storage_permutation[0];
-            stmt = LetStmt::make(stride_name[innermost], 1, stmt);
+            stmt = LetStmt::make(stride_name[innermost], element ? element->elements : 1, stmt);
         }
 
         // Assign the mins and extents stored
@@ -209,6 +384,16 @@ private:
             stmt = LetStmt::make(min_name[i - 1], op->bounds[i - 1].min, stmt);
             stmt = LetStmt::make(extent_name[i - 1], extents[i - 1], stmt);
         }
+
+        if (element && element->index == 0) {
+            for (auto it = interleaved.begin(); it != interleaved.end();) {
+                if (it->second.allocation == op->name) {
+                    it = interleaved.erase(it);
+                } else {
+                    it++;
+                }
+            }
+        }
         return stmt;
     }
 
@@ -254,7 +439,9 @@ private:
             return Evaluate::make(store);
         } else {
             Expr idx = mutate(flatten_args(op->name, op->args, Buffer<>(), output_buf));
-            return Store::make(op->name, value, idx, output_buf, const_true(value.type().lanes()), ModulusRemainder());
+            string name = op->name;
+            interleave_access(name, idx);
+            return Store::make(name, value, idx, output_buf, const_true(value.type().lanes()), ModulusRemainder());
         }
     }
 
@@ -305,7 +492,9 @@ private:
                                   op->param);
             } else {
                 Expr idx = mutate(flatten_args(op->name, op->args, op->image, op->param));
-                return Load::make(op->type, op->name, idx, op->image, op->param,
+                string name = op->name;
+                interleave_access(name, idx);
+                return Load::make(op->type, name, idx, op->image, op->param,
                                   const_true(op->type.lanes()), ModulusRemainder());
             }
 
@@ -330,7 +519,9 @@ private:
         }
 
         Expr base_offset = mutate(flatten_args(op->name, prefetch_min, Buffer<>(), op->prefetch.param));
-        Expr base_address = Variable::make(Handle(), op->name);
+        string base_name = op->name;
+        interleave_access(base_name, base_offset);
+        Expr base_address = Variable::make(Handle(), base_name);
         vector<Expr> args = {base_address, base_offset};
 
         auto iter = env.find(op->name);
@@ -374,12 +565,47 @@ private:
         return Block::make(prefetch_call, body);
     }
 
+    Stmt visit(const LetStmt *op) override {
+        // Visit an entire chain of lets in a single method to conserve stack space.
+        struct Frame {
+            const LetStmt *op;
+            ScopedBinding<Interval> binding;
+            Frame(const LetStmt *op, Scope<Interval> &scope)
+                : op(op),
+                  binding(scope, op->name, find_constant_bounds(op->value, scope)) {
+            }
+        };
+        vector<Frame> frames;
+        Stmt result;
+
+        do {
+            result = op->body;
+            frames.emplace_back(op, bounds);
+        } while ((op = result.as<LetStmt>()));
+
+        result = mutate(result);
+
+        for (auto it = frames.rbegin(); it != frames.rend(); it++) {
+            Expr value = mutate(it->op->value);
+            if (value.same_as(it->op->value) && result.same_as(it->op->body)) {
+                result = it->op;
+            } else {
+                result = LetStmt::make(it->op->name, value, result);
+            }
+        }
+
+        return result;
+    }
+
     Stmt visit(const For *op) override {
         bool old_in_gpu = in_gpu;
         if (op->for_type == ForType::GPUBlock ||
             op->for_type == ForType::GPUThread) {
             in_gpu = true;
         }
+        Interval min_bounds = find_constant_bounds(op->min, bounds);
+        Interval max_bounds = find_constant_bounds(op->min + op->extent - 1, bounds);
+        ScopedBinding<Interval> bind(bounds, op->name, Interval::make_union(min_bounds, max_bounds));
         Stmt stmt = IRMutator::visit(op);
         in_gpu = old_in_gpu;
         return stmt;
@@ -20,6 +20,10 @@
 #include <sys/auxv.h>
 #endif
 
+#if (defined(__riscv) || defined(__riscv__)) && defined(__linux__)
+#include <sys/auxv.h>
+#endif
+
 #ifdef _MSC_VER
 #include <intrin.h>
 #endif  // _MSC_VER
@@ -77,9 +81,25 @@ Target calculate_host_target() {
     bool use_64_bits = (sizeof(size_t) == 8);
     int bits = use_64_bits ? 64 : 32;
     std::vector<Target::Feature> initial_features;
+    int vector_bits = 0;
 
-#if __riscv__
+#if defined(__riscv) || defined(__riscv__)
     Target::Arch arch = Target::RISCV;
+
+#if defined(__linux__)
+    // The kernel reports single-letter ISA extensions as bits of
+    // AT_HWCAP, indexed from 'a'.
+    unsigned long hwcap = getauxval(AT_HWCAP);
+    if (hwcap & (1UL << ('v' - 'a'))) {
+        initial_features.push_back(Target::RVV);
+        // Read VLEN, in bytes, from the vlenb CSR (0xc22), so that
+        // code for the host uses the whole vector register.
+        unsigned long vlenb = 0;
+        __asm__ volatile("csrr %0, 0xc22"
+                         : "=r"(vlenb));
+        vector_bits = (int)vlenb * 8;
+    }
+#endif
 #else
 #if __mips__ || __mips || __MIPS__
     Target::Arch arch = Target::MIPS;
@@ -180,7 +200,9 @@ Target calculate_host_target() {
 #endif
 #endif
 
-    return {os, arch, bits, initial_features};
+    Target t{os, arch, bits, initial_features};
+    t.vector_bits = vector_bits;
+    return t;
 }
 
 bool is_using_hexagon(const Target &t) {
@@ -374,6 +396,13 @@ const std::map<std::string, Target::Feature> feature_name_map = {
     {"sve2", Target::SVE2},
     {"arm_dot_prod", Target::ARMDotProd},
     {"llvm_large_code_model", Target::LLVMLargeCodeModel},
+    {"align_allocations", Target::AlignAllocations},
+    {"cancellable", Target::Cancellable},
+    {"auto_compute_with", Target::AutoComputeWith},
+    {"specialize_strides", Target::SpecializeStrides},
+    {"scratch_bytes_query", Target::ScratchBytesQuery},
+    {"rvv", Target::RVV},
+    {"wasm_relaxed_simd", Target::WasmRelaxedSimd},
     // NOTE: When adding features to this map, be sure to update PyEnums.cpp as well.
 };
 
@@ -473,6 +502,20 @@ bool merge_string(Target &t, const std::string &target) {
         } else if (tok == "trace_all") {
             t.set_features({Target::TraceLoads, Target::TraceStores, Target::TraceRealizations});
             features_specified = true;
+        } else if (Internal::starts_with(tok, "vector_bits_")) {
+            string num = tok.substr(sizeof("vector_bits_") - 1);
+            if (num.empty() || num.size() > 6 ||
+                num.find_first_not_of("0123456789") != string::npos) {
+                return false;
+            }
+            int vector_bits = std::stoi(num);
+            // Vector registers are a power of two bits wide, and at
+            // least as wide as the largest scalar element type.
+            if (vector_bits < 64 || (vector_bits & (vector_bits - 1)) != 0) {
+                return false;
+            }
+            t.vector_bits = vector_bits;
+            features_specified = true;
         } else {
             return false;
         }
@@ -546,6 +589,9 @@ void bad_target_string(const std::string &target) {
                << "\n"
                << "Features are: " << features << ".\n"
                << "\n"
+               << "The width of vector registers can be given, for targets where it is "
+               << "configurable, as vector_bits_<N>, e.g. riscv-64-linux-rvv-vector_bits_256.\n"
+               << "\n"
                << "The target can also begin with \"host\", which sets the "
                << "host's architecture, os, and feature set, with the "
                << "exception of the GPU runtimes, which default to off.\n"
@@ -620,6 +666,9 @@ std::string Target::to_string() const {
     if (has_feature(Target::TraceLoads) && has_feature(Target::TraceStores) && has_feature(Target::TraceRealizations)) {
         result = Internal::replace_all(result, "trace_loads-trace_realizations-trace_stores", "trace_all");
     }
+    if (vector_bits != 0) {
+        result += "-vector_bits_" + std::to_string(vector_bits);
+    }
     return result;
 }
 
@@ -929,6 +978,11 @@ int Target::natural_vector_size(const Halide::Type &t) const {
             // No vectors, sorry.
             return 1;
         }
+    } else if (arch == Target::RISCV && has_feature(Halide::Target::RVV)) {
+        // Vectors are VLEN bits wide. Default to the minimum VLEN
+        // required by the V extension.
+        int vlen = vector_bits ? vector_bits : 128;
+        return vlen / (data_size * 8);
     } else {
         // Assume 128-bit vectors on other targets.
         return 16 / data_size;
@@ -1105,6 +1159,14 @@ void target_test() {
         internal_assert(t.has_feature((Target::Feature)i)) << "Feature " << i << " not in feature_names_map.\n";
     }
 
+    // Vector register widths round-trip through the target string.
+    Target rvv("riscv-64-linux-rvv-vector_bits_256");
+    internal_assert(rvv.vector_bits == 256 && Target(rvv.to_string()) == rvv)
+        << "vector_bits did not round-trip: " << rvv.to_string() << "\n";
+    internal_assert(Target("riscv-64-linux-rvv") != rvv);
+    internal_assert(!Target::validate_target_string("riscv-64-linux-rvv-vector_bits_100"));
+    internal_assert(!Target::validate_target_string("riscv-64-linux-rvv-vector_bits_"));
+
     // 3 targets: {A,B,C}. Want gcd(A,B)=C
     std::vector<std::array<std::string, 3>> gcd_tests = {
         {{"x86-64-linux-sse41-fma", "x86-64-linux-sse41-fma", "x86-64-linux-sse41-fma"}},
@@ -50,6 +50,13 @@ struct Target {
     /** The bit-width of the target machine. Must be 0 for unknown, or 32 or 64. */
     int bits = 0;
 
+    /** The bit-width of a vector register, for targets where this is
+     * configurable (e.g. VLEN on RISC-V with the RVV feature). 0 means
+     * use the default for the target. Corresponds to the
+     * vector_bits_<N> token of the target string. This is a minimum:
+     * the code also runs on cores with wider vector registers. */
+    int vector_bits = 0;
+
     /** Optional features a target can have.
      * Corresponds to feature_name_map in Target.cpp.
      * See definitions in HalideRuntime.h for full information.
@@ -126,6 +133,13 @@ struct Target {
         SVE2 = halide_target_feature_sve2,
         ARMDotProd = halide_target_feature_arm_dot_prod,
         LLVMLargeCodeModel = halide_llvm_large_code_model,
+        AlignAllocations = halide_target_feature_align_allocations,
+        Cancellable = halide_target_feature_cancellable,
+        AutoComputeWith = halide_target_feature_auto_compute_with,
+        SpecializeStrides = halide_target_feature_specialize_strides,
+        ScratchBytesQuery = halide_target_feature_scratch_bytes_query,
+        RVV = halide_target_feature_rvv,
+        WasmRelaxedSimd = halide_target_feature_wasm_relaxed_simd,
         FeatureEnd = halide_target_feature_end
     };
     Target() = default;
@@ -219,6 +233,7 @@ struct Target {
         return os == other.os &&
                arch == other.arch &&
                bits == other.bits &&
+               vector_bits == other.vector_bits &&
                features == other.features;
     }
 
@@ -240,7 +255,7 @@ struct Target {
     /** Convert the Target into a string form that can be reconstituted
      * by merge_string(), which will always be of the form
      *
-     *   arch-bits-os-feature1-feature2...featureN.
+     *   arch-bits-os-feature1-feature2...featureN[-vector_bits_N].
      *
      * Note that is guaranteed that Target(t1.to_string()) == t1,
      * but not that Target(s).to_string() == s (since there can be
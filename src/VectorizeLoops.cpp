@@ -359,6 +359,11 @@ class PredicateLoadStore : public IRMutator {
             // See: https://github.com/halide/Halide/issues/3534
             // return (bit_size == 32) && (lanes >= 4);
             return false;
+        } else if (target.arch == Target::RISCV && target.has_feature(Target::RVV)) {
+            // RVV loads and stores take a mask, so a guarded tail
+            // becomes a single vector iteration with the tail lanes
+            // masked off, rather than a scalar loop.
+            return true;
         }
         // For other architecture, do not predicate vector load/store
         return false;
@@ -4,6 +4,7 @@
 #include "Error.h"
 #include "Float16.h"
 #include "Func.h"
+#include "IRVisitor.h"
 #include "ImageParam.h"
 #include "JITModule.h"
 #if WITH_WABT
@@ -272,6 +273,9 @@ const wasm32_ptr_t kMagicJitUserContextValue = -1;
 // failures. https://github.com/halide/Halide/issues/3738
 constexpr size_t kExtraMallocSlop = 32;
 
+// The maximum size of the memory of a module built with wasm_threads.
+constexpr uint32_t kMaxMemorySize = 0x80000000;
+
 std::vector<char> compile_to_wasm(const Module &module, const std::string &fn_name) {
     static std::mutex link_lock;
     std::lock_guard<std::mutex> lock(link_lock);
@@ -312,7 +316,7 @@ std::vector<char> compile_to_wasm(const Module &module, const std::string &fn_na
 
     TemporaryFile wasm_output("", ".wasm");
 
-    std::string lld_arg_strs[] = {
+    std::vector<std::string> lld_arg_strs = {
         "HalideJITLinker",
         // For debugging purposes:
         // "--verbose",
@@ -326,10 +330,17 @@ std::vector<char> compile_to_wasm(const Module &module, const std::string &fn_na
         "-o",
         wasm_output.pathname()};
 
-    constexpr int c = sizeof(lld_arg_strs) / sizeof(lld_arg_strs[0]);
-    const char *lld_args[c];
-    for (int i = 0; i < c; ++i) {
-        lld_args[i] = lld_arg_strs[i].c_str();
+    if (module.target().has_feature(Target::WasmThreads)) {
+        // Atomics require a shared memory, and a shared memory must
+        // declare its maximum size. Allow it to grow as far as
+        // BDMalloc can address.
+        lld_arg_strs.emplace_back("--shared-memory");
+        lld_arg_strs.emplace_back("--max-memory=" + std::to_string(kMaxMemorySize));
+    }
+
+    std::vector<const char *> lld_args;
+    for (const std::string &a : lld_arg_strs) {
+        lld_args.push_back(a.c_str());
     }
 
     // lld will temporarily hijack the signal handlers to ensure that temp files get cleaned up,
@@ -1286,6 +1297,25 @@ wabt::interp::HostFunc::Ptr make_extern_callback(wabt::interp::Store &store,
     return host_func;
 }
 
+// Does any function in the module have a parallel loop?
+bool has_parallel_loops(const Module &module) {
+    class FindParallelLoops : public IRVisitor {
+        using IRVisitor::visit;
+
+        void visit(const For *op) override {
+            found = found || op->for_type == ForType::Parallel;
+            IRVisitor::visit(op);
+        }
+
+    public:
+        bool found = false;
+    } finder;
+    for (const LoweredFunc &f : module.functions()) {
+        f.body.accept(&finder);
+    }
+    return finder.found;
+}
+
 wabt::Features calc_features(const Target &target) {
     wabt::Features f;
     if (target.has_feature(Target::WasmSignExt)) {
@@ -1297,6 +1327,13 @@ wabt::Features calc_features(const Target &target) {
     if (target.has_feature(Target::WasmSatFloatToInt)) {
         f.enable_sat_float_to_int();
     }
+    if (target.has_feature(Target::WasmThreads)) {
+        f.enable_threads();
+    }
+    if (target.has_feature(Target::WasmBulkMemory) ||
+        target.has_feature(Target::WasmThreads)) {
+        f.enable_bulk_memory();
+    }
     return f;
 }
 
@@ -1349,7 +1386,17 @@ WasmModuleContents::WasmModuleContents(
 #if WITH_WABT
     user_assert(LLVM_VERSION >= 110) << "Using the WebAssembly JIT is only supported under LLVM 11+.";
 
-    user_assert(!target.has_feature(Target::WasmThreads)) << "The Halide WebAssembly JIT doesn't support wasm threads yet.";
+    user_assert(!target.has_feature(Target::WasmRelaxedSimd)) << "The Halide WebAssembly JIT doesn't support wasm relaxed simd yet.";
+
+    // The interpreter runs every instance in a Store on one thread, so
+    // wasm_threads code is supported, but parallel loops run serially
+    // via the fake thread pool linked in by link_with_wasm_jit_runtime().
+    // TODO: Running them concurrently needs one Store per worker sharing
+    // a single memory, which WABT 1.0.20 can't do.
+    if (target.has_feature(Target::WasmThreads) && has_parallel_loops(halide_module)) {
+        user_warning << "The Halide WebAssembly JIT runs the parallel loops of "
+                     << fn_name << " serially, even with wasm_threads.\n";
+    }
 
     wdebug(1) << "Compiling wasm function " << fn_name << "\n";
 
@@ -1555,7 +1602,7 @@ void destroy<WasmModuleContents>(const WasmModuleContents *p) {
 bool WasmModule::can_jit_target(const Target &target) {
 #if WITH_WABT
     if (target.arch == Target::WebAssembly) {
-        return true;
+        return !target.has_feature(Target::WasmRelaxedSimd);
     }
 #endif
     return false;
@@ -333,6 +333,24 @@ extern void halide_join_thread(struct halide_thread *);
  */
 extern int halide_set_num_threads(int n);
 
+/** Pipelines compiled with the cancellable target feature call this
+ * at the top of each iteration of their outer loops, and the default
+ * thread pool calls it before running each chunk of a parallel
+ * loop. If it returns non-zero, the pipeline stops as soon as it can,
+ * frees its scratch memory, and returns
+ * halide_error_code_cancelled. It is called concurrently from many
+ * threads, so it should be cheap and thread-safe. To implement a
+ * deadline, compare halide_current_time_ns against a time stored in
+ * the user_context. The default implementation calls the function
+ * set by halide_set_custom_cancel_requested, which by default is
+ * halide_default_cancel_requested, which never cancels. */
+// @{
+extern int halide_cancel_requested(void *user_context);
+typedef int (*halide_cancel_requested_t)(void *user_context);
+extern halide_cancel_requested_t halide_set_custom_cancel_requested(halide_cancel_requested_t);
+extern int halide_default_cancel_requested(void *user_context);
+// @}
+
 /** Halide calls these functions to allocate and free memory. To
  * replace in AOT code, use the halide_set_custom_malloc and
  * halide_set_custom_free, or (on platforms that support weak
@@ -1173,6 +1191,16 @@ enum halide_error_code_t {
      * pipeline, or enable the appropriate device backend. */
     halide_error_code_device_dirty_with_no_device_support = -44,
 
+    /** halide_cancel_requested returned non-zero, so the pipeline
+     * stopped early. The contents of the output buffers are
+     * undefined. */
+    halide_error_code_cancelled = -45,
+
+    /** An output declared to alias an input was passed memory that
+     * overlaps that input, but isn't the same buffer with the same
+     * mins and strides, so it can't be computed in place. */
+    halide_error_code_aliased_buffer_mismatch = -46,
+
 };
 
 /** Halide calls the functions below on various error conditions. The
@@ -1244,6 +1272,9 @@ extern int halide_error_device_interface_no_device(void *user_context);
 extern int halide_error_host_and_device_dirty(void *user_context);
 extern int halide_error_buffer_is_null(void *user_context, const char *routine);
 extern int halide_error_device_dirty_with_no_device_support(void *user_context, const char *buffer_name);
+extern int halide_error_cancelled(void *user_context);
+extern int halide_error_aliased_buffer_mismatch(void *user_context, const char *output_name,
+                                                const char *input_name);
 // @}
 
 /** Optional features a compilation Target can have.
@@ -1334,6 +1365,13 @@ typedef enum halide_target_feature_t {
     halide_target_feature_egl,                    ///< Force use of EGL support.
     halide_target_feature_arm_dot_prod,           ///< Enable ARMv8.2-a dotprod extension (i.e. udot and sdot instructions)
     halide_llvm_large_code_model,                 ///< Use the LLVM large code model to compile
+    halide_target_feature_align_allocations,      ///< Pad the rows of internal allocations so that vector loads and stores are aligned.
+    halide_target_feature_cancellable,            ///< Call halide_cancel_requested at the top of outer loops, and stop early if it returns non-zero.
+    halide_target_feature_auto_compute_with,      ///< Fuse the loop nests of independent Funcs that read the same inputs, as if by compute_with.
+    halide_target_feature_specialize_strides,     ///< Generate a dense fast path, and a generic fallback, for buffers whose innermost stride is unconstrained.
+    halide_target_feature_scratch_bytes_query,    ///< Generate an extra entry point, <name>_scratch_bytes, that predicts the peak heap memory used for given buffer shapes.
+    halide_target_feature_rvv,                    ///< Enable RISC-V "V" Vector Extension (RVV 1.0).
+    halide_target_feature_wasm_relaxed_simd,      ///< Enable +relaxed-simd instructions for WebAssembly codegen.
     halide_target_feature_end                     ///< A sentinel. Every target is considered to have this feature, and setting this feature does nothing.
 } halide_target_feature_t;
 
@@ -0,0 +1,29 @@
+#include "HalideRuntime.h"
+
+namespace Halide {
+namespace Runtime {
+namespace Internal {
+
+WEAK halide_cancel_requested_t custom_cancel_requested = halide_default_cancel_requested;
+
+}  // namespace Internal
+}  // namespace Runtime
+}  // namespace Halide
+
+extern "C" {
+
+WEAK int halide_default_cancel_requested(void *user_context) {
+    return 0;
+}
+
+WEAK halide_cancel_requested_t halide_set_custom_cancel_requested(halide_cancel_requested_t fn) {
+    halide_cancel_requested_t result = custom_cancel_requested;
+    custom_cancel_requested = fn;
+    return result;
+}
+
+WEAK int halide_cancel_requested(void *user_context) {
+    return (*custom_cancel_requested)(user_context);
+}
+
+}  // extern "C"
@@ -276,4 +276,18 @@ WEAK int halide_error_buffer_is_null(void *user_context, const char *routine) {
     return halide_error_code_buffer_is_null;
 }
 
+WEAK int halide_error_cancelled(void *user_context) {
+    // Cancellation is something the caller asked for, so unlike the
+    // errors above, don't report it via halide_error.
+    return halide_error_code_cancelled;
+}
+
+WEAK int halide_error_aliased_buffer_mismatch(void *user_context, const char *output_name,
+                                              const char *input_name) {
+    error(user_context)
+        << "Output buffer " << output_name << " overlaps input buffer " << input_name
+        << ", but doesn't have the same host pointer, mins and strides, so it can't be computed in place.";
+    return halide_error_code_aliased_buffer_mismatch;
+}
+
 }  // extern "C"
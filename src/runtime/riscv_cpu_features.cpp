@@ -1,13 +1,34 @@
 #include "HalideRuntime.h"
 #include "cpu_features.h"
 
+#define AT_HWCAP 16
+
+// The Linux kernel reports single-letter ISA extensions as bits of
+// AT_HWCAP, indexed from 'a'.
+#define RISCV_HWCAP_V (1UL << ('v' - 'a'))
+
+// Bare-metal targets have no getauxval, so only reference it weakly.
+extern "C" __attribute__((weak)) unsigned long int getauxval(unsigned long int);
+
 namespace Halide {
 namespace Runtime {
 namespace Internal {
 
 WEAK CpuFeatures halide_get_cpu_features() {
-    // For now, no version specific features, though RISCV promises to have many.
-    return CpuFeatures();
+    CpuFeatures features;
+    if (getauxval == nullptr) {
+        // Nothing is known without an OS to ask.
+        return features;
+    }
+
+    features.set_known(halide_target_feature_rvv);
+
+    const unsigned long hwcap = getauxval(AT_HWCAP);
+
+    if (hwcap & RISCV_HWCAP_V) {
+        features.set_available(halide_target_feature_rvv);
+    }
+    return features;
 }
 
 }  // namespace Internal
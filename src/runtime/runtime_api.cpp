@@ -22,6 +22,7 @@ extern "C" __attribute__((used)) void *halide_runtime_api_functions[] = {
     (void *)&halide_buffer_copy,
     (void *)&halide_buffer_to_string,
     (void *)&halide_can_use_target_features,
+    (void *)&halide_cancel_requested,
     (void *)&halide_cond_broadcast,
     (void *)&halide_cond_signal,
     (void *)&halide_cond_wait,
@@ -36,6 +37,7 @@ extern "C" __attribute__((used)) void *halide_runtime_api_functions[] = {
     (void *)&halide_current_time_ns,
     (void *)&halide_debug_to_file,
     (void *)&halide_default_can_use_target_features,
+    (void *)&halide_default_cancel_requested,
     (void *)&halide_device_and_host_free,
     (void *)&halide_device_and_host_free_as_destructor,
     (void *)&halide_device_and_host_malloc,
@@ -52,6 +54,7 @@ extern "C" __attribute__((used)) void *halide_runtime_api_functions[] = {
     (void *)&halide_double_to_string,
     (void *)&halide_error,
     (void *)&halide_error_access_out_of_bounds,
+    (void *)&halide_error_aliased_buffer_mismatch,
     (void *)&halide_error_bad_dimensions,
     (void *)&halide_error_bad_fold,
     (void *)&halide_error_bad_extern_fold,
@@ -61,6 +64,7 @@ extern "C" __attribute__((used)) void *halide_runtime_api_functions[] = {
     (void *)&halide_error_buffer_argument_is_null,
     (void *)&halide_error_buffer_extents_negative,
     (void *)&halide_error_buffer_extents_too_large,
+    (void *)&halide_error_cancelled,
     (void *)&halide_error_constraint_violated,
     (void *)&halide_error_constraints_make_required_region_smaller,
     (void *)&halide_error_debug_to_file_failed,
@@ -166,10 +170,15 @@ extern "C" __attribute__((used)) void *halide_runtime_api_functions[] = {
     (void *)&halide_qurt_hvx_unlock,
     (void *)&halide_qurt_hvx_unlock_as_destructor,
     (void *)&halide_release_jit_module,
+    (void *)&halide_scratch_alloc,
+    (void *)&halide_scratch_free,
+    (void *)&halide_scratch_pool_create,
+    (void *)&halide_scratch_pool_destroy,
     (void *)&halide_semaphore_init,
     (void *)&halide_semaphore_release,
     (void *)&halide_semaphore_try_acquire,
     (void *)&halide_set_custom_can_use_target_features,
+    (void *)&halide_set_custom_cancel_requested,
     (void *)&halide_set_custom_do_par_for,
     (void *)&halide_set_custom_do_loop_task,
     (void *)&halide_set_custom_do_task,
@@ -139,6 +139,14 @@ WEAK void halide_device_free_as_destructor(void *user_context, void *obj);
 WEAK void halide_device_and_host_free_as_destructor(void *user_context, void *obj);
 WEAK void halide_device_host_nop_free(void *user_context, void *obj);
 
+// Scratch memory for dynamic-size allocations inside parallel
+// loops. The pool lives for one call to the pipeline, and blocks
+// freed by one task are reused by the next.
+WEAK void *halide_scratch_pool_create(void *user_context);
+WEAK void halide_scratch_pool_destroy(void *user_context, void *pool);
+WEAK void *halide_scratch_alloc(void *user_context, void *pool, uint64_t size);
+WEAK void halide_scratch_free(void *user_context, void *ptr);
+
 // The pipeline_state is declared as void* type since halide_profiler_pipeline_stats
 // is defined inside HalideRuntime.h which includes this header file.
 WEAK void halide_profiler_stack_peak_update(void *user_context,
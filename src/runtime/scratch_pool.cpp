@@ -0,0 +1,148 @@
+#include "HalideRuntime.h"
+#include "runtime_internal.h"
+#include "scoped_spin_lock.h"
+
+namespace Halide {
+namespace Runtime {
+namespace Internal {
+
+// The header in front of each block handed out.
+struct scratch_block {
+    struct scratch_pool *pool;
+    scratch_block *next;
+    uint64_t capacity;
+};
+
+#define SCRATCH_POOL_SLOTS 64
+#define SCRATCH_POOL_MAX_BLOCKS_PER_SLOT 64
+#define SCRATCH_POOL_MAX_BYTES (128 * 1024 * 1024)
+
+// A free list of blocks, used mostly by a single thread. Each is
+// given a cache line of its own, so that threads using different
+// slots don't fight over it.
+struct __attribute__((aligned(64))) scratch_slot {
+    ScopedSpinLock::AtomicFlag lock;
+    int count;
+    scratch_block *blocks;
+};
+
+// A pool of scratch blocks, created for one call to a pipeline, for
+// the dynamic-size allocations made inside its parallel loops. We
+// don't know which worker thread we're running on, but each thread
+// has its own stack, so the address of the stack picks the free list
+// to use. Blocks freed by a task are then reused by the next task run
+// on the same thread, usually without contention, and most recently
+// freed first, so the memory is likely still in cache. Only a bounded
+// number of bytes is kept; the rest goes back to the heap. If the pool
+// itself couldn't be allocated, blocks come straight from the heap.
+struct scratch_pool {
+    scratch_slot slots[SCRATCH_POOL_SLOTS];
+    size_t free_bytes;
+};
+
+WEAK size_t scratch_header_size() {
+    // Keep the memory after the header aligned like halide_malloc would.
+    size_t alignment = (size_t)halide_malloc_alignment();
+    return (sizeof(scratch_block) + alignment - 1) & ~(alignment - 1);
+}
+
+WEAK_INLINE scratch_slot *this_threads_slot(scratch_pool *pool) {
+    // Thread stacks are at least hundreds of KB apart on the
+    // platforms we care about.
+    uint64_t stack = (uint64_t)(uintptr_t)__builtin_frame_address(0) >> 18;
+    uint64_t hash = stack * 0x9E3779B97F4A7C15ULL;
+    return &pool->slots[hash >> 58];
+}
+
+}  // namespace Internal
+}  // namespace Runtime
+}  // namespace Halide
+
+using namespace Halide::Runtime::Internal;
+
+extern "C" {
+
+WEAK void *halide_scratch_pool_create(void *user_context) {
+    scratch_pool *pool = (scratch_pool *)halide_malloc(user_context, sizeof(scratch_pool));
+    if (pool) {
+        memset(pool, 0, sizeof(scratch_pool));
+    }
+    return pool;
+}
+
+WEAK void halide_scratch_pool_destroy(void *user_context, void *obj) {
+    scratch_pool *pool = (scratch_pool *)obj;
+    if (!pool) {
+        return;
+    }
+    // Everything handed out has been freed by now, so there's no
+    // need to lock.
+    for (int i = 0; i < SCRATCH_POOL_SLOTS; i++) {
+        scratch_block *b = pool->slots[i].blocks;
+        while (b) {
+            scratch_block *next = b->next;
+            halide_free(user_context, b);
+            b = next;
+        }
+    }
+    halide_free(user_context, pool);
+}
+
+WEAK void *halide_scratch_alloc(void *user_context, void *obj, uint64_t size) {
+    if (size == 0) {
+        return nullptr;
+    }
+    scratch_pool *pool = (scratch_pool *)obj;
+    const size_t header = scratch_header_size();
+
+    scratch_block *b = nullptr;
+    if (pool) {
+        scratch_slot *slot = this_threads_slot(pool);
+        ScopedSpinLock lock(&slot->lock);
+        scratch_block **prev = &slot->blocks;
+        for (b = slot->blocks; b; prev = &b->next, b = b->next) {
+            if (b->capacity >= size) {
+                *prev = b->next;
+                slot->count--;
+                __atomic_fetch_sub(&pool->free_bytes, (size_t)b->capacity, __ATOMIC_RELAXED);
+                break;
+            }
+        }
+    }
+
+    if (!b) {
+        b = (scratch_block *)halide_malloc(user_context, header + size);
+        if (!b) {
+            return nullptr;
+        }
+        b->pool = pool;
+        b->capacity = size;
+    }
+    b->next = nullptr;
+    return (uint8_t *)b + header;
+}
+
+WEAK void halide_scratch_free(void *user_context, void *ptr) {
+    if (!ptr) {
+        return;
+    }
+    scratch_block *b = (scratch_block *)((uint8_t *)ptr - scratch_header_size());
+    scratch_pool *pool = b->pool;
+    if (pool) {
+        scratch_slot *slot = this_threads_slot(pool);
+        ScopedSpinLock lock(&slot->lock);
+        if (slot->count < SCRATCH_POOL_MAX_BLOCKS_PER_SLOT) {
+            size_t bytes = __atomic_add_fetch(&pool->free_bytes, (size_t)b->capacity, __ATOMIC_RELAXED);
+            if (bytes <= SCRATCH_POOL_MAX_BYTES) {
+                b->next = slot->blocks;
+                slot->blocks = b;
+                slot->count++;
+                return;
+            }
+            __atomic_fetch_sub(&pool->free_bytes, (size_t)b->capacity, __ATOMIC_RELAXED);
+        }
+    }
+    halide_free(user_context, b);
+}
+
+}  // extern "C"
@@ -43,6 +43,10 @@ struct work {
     // which condition variable is the owner sleeping on. nullptr if it isn't sleeping.
     bool owner_is_sleeping;
 
+    // The number of claims made from this job so far. Used to size
+    // the next claim.
+    int claims;
+
     ALWAYS_INLINE bool make_runnable() {
         for (; next_semaphore < task.num_semaphores; next_semaphore++) {
             if (!halide_default_semaphore_try_acquire(task.semaphores[next_semaphore].semaphore,
@@ -165,6 +169,32 @@ struct work_queue_t {
 
 WEAK work_queue_t work_queue = {};
 
+// The number of iterations to claim from a non-serial job in one go
+// (must be called while locked). Claims never exceed a fraction of
+// what's left (guided self-scheduling), so they shrink as the loop
+// drains and the tail stays balanced across threads. On top of that,
+// the first claim from a job is a single iteration and each later one
+// may be at most twice as large as the one before it. Short loops are
+// handed out one iteration at a time, and long loops quickly get to
+// claims large enough that the work queue lock stops mattering. This
+// only counts claims, so it doesn't depend on having a clock.
+WEAK int claim_size(work *job) {
+    const int remaining = job->task.extent;
+    if (remaining <= 1 || job->task.num_semaphores > 0) {
+        // Semaphores are acquired once per iteration, so only one
+        // iteration is runnable.
+        return 1;
+    }
+
+    const int divisor = 2 * work_queue.desired_threads_working;
+    int iters = (remaining + divisor - 1) / divisor;
+    if (job->claims < 30) {
+        iters = min(iters, 1 << job->claims);
+        job->claims++;
+    }
+    return min(iters, remaining);
+}
+
 #if EXTENDED_DEBUG
 WEAK void print_job(work *job, const char *indent, const char *prefix = nullptr) {
     if (prefix == nullptr) {
@@ -319,6 +349,11 @@ WEAK void worker_thread_already_locked(work *owned_job) {
             int total_iters = 0;
             int iters = 1;
             while (result == 0) {
+                if (halide_cancel_requested(job->user_context)) {
+                    result = halide_error_cancelled(job->user_context);
+                    break;
+                }
+
                 // Claim as many iterations as possible
                 while ((job->task.extent - total_iters) > iters &&
                        job->make_runnable()) {
@@ -348,10 +383,11 @@ WEAK void worker_thread_already_locked(work *owned_job) {
                 work_queue.jobs = job;
             }
         } else {
-            // Claim a task from it.
+            // Claim some tasks from it.
             work myjob = *job;
-            job->task.min++;
-            job->task.extent--;
+            int iters = claim_size(job);
+            job->task.min += iters;
+            job->task.extent -= iters;
 
             // If there were no more tasks pending for this job, remove it
             // from the stack.
@@ -359,14 +395,20 @@ WEAK void worker_thread_already_locked(work *owned_job) {
                 *prev_ptr = job->next_job;
             }
 
-            // Release the lock and do the task.
+            // Release the lock and do the tasks, unless the pipeline
+            // has been cancelled.
             halide_mutex_unlock(&work_queue.mutex);
+            if (halide_cancel_requested(myjob.user_context)) {
+                result = halide_error_cancelled(myjob.user_context);
+            }
             if (myjob.task_fn) {
-                result = halide_do_task(myjob.user_context, myjob.task_fn,
-                                        myjob.task.min, myjob.task.closure);
-            } else {
+                for (int i = 0; i < iters && result == 0; i++) {
+                    result = halide_do_task(myjob.user_context, myjob.task_fn,
+                                            myjob.task.min + i, myjob.task.closure);
+                }
+            } else if (result == 0) {
                 result = halide_do_loop_task(myjob.user_context, myjob.task.fn,
-                                             myjob.task.min, 1,
+                                             myjob.task.min, iters,
                                              myjob.task.closure, job);
             }
             halide_mutex_lock(&work_queue.mutex);
@@ -602,6 +644,7 @@ WEAK int halide_default_do_par_for(void *user_context, halide_task_t f,
     job.active_workers = 0;
     job.next_semaphore = 0;
     job.owner_is_sleeping = false;
+    job.claims = 0;
     job.siblings = &job;  // guarantees no other job points to the same siblings.
     job.sibling_count = 0;
     job.parent_job = nullptr;
@@ -630,6 +673,7 @@ WEAK int halide_default_do_parallel_tasks(void *user_context, int num_tasks,
         jobs[i].active_workers = 0;
         jobs[i].next_semaphore = 0;
         jobs[i].owner_is_sleeping = false;
+        jobs[i].claims = 0;
         jobs[i].parent_job = (work *)task_parent;
     }
 
@@ -0,0 +1,202 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+// An output declared to alias an input can be computed over the same
+// buffer. Check the results are right whether the pipeline writes in
+// place or has to copy the input first, and that writing in place
+// doesn't allocate.
+
+int allocations = 0;
+
+void *my_malloc(void *user_context, size_t size) {
+    allocations++;
+    return malloc(size);
+}
+
+void my_free(void *user_context, void *ptr) {
+    free(ptr);
+}
+
+bool error_occurred = false;
+void my_error(void *user_context, const char *msg) {
+    printf("Expected: %s\n", msg);
+    error_occurred = true;
+}
+
+const int W = 37, H = 20;
+
+Buffer<int> make_input() {
+    Buffer<int> buf(W, H);
+    buf.for_each_element([&](int x, int y) { buf(x, y) = x * 5 + y * 11; });
+    return buf;
+}
+
+// Run f over the input in place, and compare to the reference.
+bool check(const char *name, Func f, ImageParam in,
+           std::function<int(const Buffer<int> &, int, int)> reference,
+           bool expect_allocations) {
+    Buffer<int> original = make_input();
+    Buffer<int> buf = make_input();
+    in.set(buf);
+    f.set_custom_allocator(my_malloc, my_free);
+    allocations = 0;
+    f.realize(buf);
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            int correct = reference(original, x, y);
+            if (buf(x, y) != correct) {
+                printf("%s: out(%d, %d) = %d instead of %d\n", name, x, y, buf(x, y), correct);
+                return false;
+            }
+        }
+    }
+    if (expect_allocations != (allocations > 0)) {
+        printf("%s: expected %s, but there were %d allocations\n", name,
+               expect_allocations ? "some allocations" : "none", allocations);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    Var x("x"), y("y");
+
+    // A chain of pointwise Funcs, vectorized with a tail and
+    // parallelized, is computed in place.
+    {
+        ImageParam in(Int(32), 2, "in");
+        Func g("g"), f("f");
+        g(x, y) = in(x, y) * 3;
+        f(x, y) = g(x, y) + 1;
+        f.vectorize(x, 8).parallel(y);
+        f.aliases(in);
+        if (!check("pointwise", f, in,
+                   [](const Buffer<int> &b, int x, int y) { return b(x, y) * 3 + 1; },
+                   false)) {
+            return -1;
+        }
+    }
+
+    // A compute_root producer can read the input anywhere, because it
+    // is done before the output starts.
+    {
+        ImageParam in(Int(32), 2, "in");
+        Func row_max("row_max"), f("f");
+        RDom r(0, W);
+        row_max(y) = maximum(in(r, y));
+        f(x, y) = row_max(y) - in(x, y);
+        row_max.compute_root();
+        f.vectorize(x, 4);
+        f.aliases(in);
+        if (!check("root producer", f, in,
+                   [](const Buffer<int> &b, int x, int y) {
+                       int m = b(0, y);
+                       for (int i = 1; i < W; i++) {
+                           m = std::max(m, b(i, y));
+                       }
+                       return m - b(x, y);
+                   },
+                   true)) {
+            return -1;
+        }
+    }
+
+    // A stencil reads points that have already been overwritten, so
+    // the input is copied first.
+    {
+        ImageParam in(Int(32), 2, "in");
+        Func clamped = BoundaryConditions::repeat_edge(in);
+        Func f("f");
+        f(x, y) = clamped(x - 1, y) + clamped(x + 1, y) + clamped(x, y - 1) + clamped(x, y + 1);
+        f.aliases(in);
+        if (!check("stencil", f, in,
+                   [](const Buffer<int> &b, int x, int y) {
+                       auto c = [&](int x, int y) {
+                           return b(std::min(std::max(x, 0), W - 1), std::min(std::max(y, 0), H - 1));
+                       };
+                       return c(x - 1, y) + c(x + 1, y) + c(x, y - 1) + c(x, y + 1);
+                   },
+                   true)) {
+            return -1;
+        }
+    }
+
+    // So does an explicit ShiftInwards tail, which recomputes points
+    // that have already been written.
+    {
+        ImageParam in(Int(32), 2, "in");
+        Func f("f");
+        f(x, y) = in(x, y) * 2;
+        f.vectorize(x, 8, TailStrategy::ShiftInwards);
+        f.aliases(in);
+        if (!check("shift inwards", f, in,
+                   [](const Buffer<int> &b, int x, int y) { return b(x, y) * 2; },
+                   true)) {
+            return -1;
+        }
+    }
+
+    // Separate input and output buffers still work, and the same
+    // memory with a different layout is an error.
+    {
+        ImageParam in(Int(32), 2, "in");
+        Func f("f");
+        f(x, y) = in(x, y) + 1;
+        f.aliases(in);
+        f.set_error_handler(my_error);
+
+        Buffer<int> input = make_input();
+        Buffer<int> output(W, H);
+        in.set(input);
+        f.realize(output);
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W; x++) {
+                if (output(x, y) != input(x, y) + 1) {
+                    printf("separate: out(%d, %d) = %d instead of %d\n", x, y, output(x, y), input(x, y) + 1);
+                    return -1;
+                }
+            }
+        }
+
+        Buffer<int> larger(W, H + 1);
+        halide_dimension_t shape[] = {{0, W, 1}, {1, H, W}};
+        Buffer<int> shifted(larger.data(), 2, shape);
+        in.set(larger);
+        f.realize(shifted);
+        if (!error_occurred) {
+            printf("Aliasing with a different layout did not fail\n");
+            return -1;
+        }
+
+        // A crop of the input starting one row further in overlaps it
+        // without having the same host pointer.
+        error_occurred = false;
+        Buffer<int> overlapping(larger.data() + W, 2, shape);
+        f.realize(overlapping);
+        if (!error_occurred) {
+            printf("Aliasing with a partially overlapping buffer did not fail\n");
+            return -1;
+        }
+
+        // Buffers next to each other in the same allocation don't
+        // overlap, so they're fine.
+        error_occurred = false;
+        Buffer<int> both(W, 2 * H);
+        halide_dimension_t half_shape[] = {{0, W, 1}, {0, H, W}};
+        Buffer<int> top(both.data(), 2, half_shape);
+        Buffer<int> bottom(both.data() + W * H, 2, half_shape);
+        top.fill(1);
+        in.set(top);
+        f.realize(bottom);
+        if (error_occurred || bottom(0, 0) != 2) {
+            printf("Aliasing with an adjacent buffer failed\n");
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
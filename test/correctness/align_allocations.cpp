@@ -0,0 +1,154 @@
+#include "Halide.h"
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// With the align_allocations target feature, the rows of internal
+// allocations get padded to a multiple of the vector width, so vector
+// loads of them can be proven aligned.
+class CountAlignedLoads : public IRMutator {
+    using IRMutator::visit;
+
+    Expr visit(const Load *op) override {
+        if (op->name == name && op->type.is_vector()) {
+            total++;
+            if (op->alignment.modulus % lanes == 0 &&
+                op->alignment.remainder % lanes == 0) {
+                aligned++;
+            }
+        }
+        return IRMutator::visit(op);
+    }
+
+public:
+    std::string name;
+    int lanes;
+    int total = 0, aligned = 0;
+    CountAlignedLoads(const std::string &n, int l)
+        : name(n), lanes(l) {
+    }
+};
+
+size_t largest_allocation = 0;
+
+void *my_malloc(void *user_context, size_t size) {
+    largest_allocation = std::max(largest_allocation, size);
+    return malloc(size);
+}
+
+void my_free(void *user_context, void *ptr) {
+    free(ptr);
+}
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    const int lanes = target.natural_vector_size<float>();
+    if (lanes < 2) {
+        printf("[SKIP] Target has no vector units\n");
+        return 0;
+    }
+
+    // An odd width, so that rows are misaligned without padding.
+    const int W = 1001, H = 32;
+
+    for (int align = 0; align < 2; align++) {
+        Func f("f"), g("g");
+        Var x("x"), y("y");
+        f(x, y) = cast<float>(x * 3 + y * 5);
+        g(x, y) = f(x, y) * 2 + f(x, y + 1);
+
+        f.compute_root();
+        g.bound(x, 0, W - 1).bound(y, 0, H).vectorize(x, lanes, TailStrategy::GuardWithIf);
+
+        CountAlignedLoads *counter = new CountAlignedLoads("f", lanes);
+        g.add_custom_lowering_pass(counter, [=]() { delete counter; });
+
+        Target t = align ? target.with_feature(Target::AlignAllocations) : target;
+        Buffer<float> out = g.realize(W - 1, H, t);
+
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W - 1; x++) {
+                float correct = (float)(x * 3 + y * 5) * 2 + (float)(x * 3 + (y + 1) * 5);
+                if (out(x, y) != correct) {
+                    printf("out(%d, %d) = %f instead of %f\n", x, y, out(x, y), correct);
+                    return -1;
+                }
+            }
+        }
+
+        if (counter->total == 0) {
+            printf("Found no vector loads of f\n");
+            return -1;
+        }
+        if (align && counter->aligned != counter->total) {
+            printf("Only %d of %d vector loads were aligned with align_allocations\n",
+                   counter->aligned, counter->total);
+            return -1;
+        }
+        if (!align && counter->aligned == counter->total) {
+            printf("Expected misaligned vector loads without align_allocations\n");
+            return -1;
+        }
+    }
+
+    // Rows of a size only known at runtime are padded too, if a lower
+    // bound on it shows the padding costs less than an eighth of the
+    // row. The loads are then still provably aligned.
+    for (bool has_min : {false, true}) {
+        for (int width : {129, 1001}) {
+            Param<int> w("w");
+            if (has_min) {
+                w.set_min_value(lanes * 8);
+            }
+            w.set(width);
+
+            Func f("f"), g("g");
+            Var x("x"), y("y");
+            f(x, y) = cast<float>(x * 3 + y * 5);
+            g(x, y) = f(x, y) * 2 + f(x, y + 1);
+            f.compute_root();
+            g.bound(x, 0, w).bound(y, 0, H).vectorize(x, lanes, TailStrategy::GuardWithIf);
+            g.set_custom_allocator(my_malloc, my_free);
+
+            CountAlignedLoads *counter = new CountAlignedLoads("f", lanes);
+            g.add_custom_lowering_pass(counter, [=]() { delete counter; });
+
+            largest_allocation = 0;
+            Buffer<float> out = g.realize(width, H, target.with_feature(Target::AlignAllocations));
+            for (int y = 0; y < H; y++) {
+                for (int x = 0; x < width; x++) {
+                    float correct = (float)(x * 3 + y * 5) * 2 + (float)(x * 3 + (y + 1) * 5);
+                    if (out(x, y) != correct) {
+                        printf("out(%d, %d) = %f instead of %f\n", x, y, out(x, y), correct);
+                        return -1;
+                    }
+                }
+            }
+
+            if (counter->total == 0) {
+                printf("Found no vector loads of f\n");
+                return -1;
+            }
+            if (has_min && counter->aligned != counter->total) {
+                printf("Only %d of %d vector loads were aligned for a row of width %d\n",
+                       counter->aligned, counter->total, width);
+                return -1;
+            }
+
+            // f has H + 1 rows, and the allocation has one extra element.
+            const int padded_width = ((width + lanes - 1) / lanes) * lanes;
+            const size_t expected = ((has_min ? padded_width : width) * (H + 1) + 1) * sizeof(float);
+            if (largest_allocation != expected) {
+                printf("Allocation of f for width %d was %d bytes instead of %d\n",
+                       width, (int)largest_allocation, (int)expected);
+                return -1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,222 @@
+#include "Halide.h"
+#include <set>
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// With the AutoComputeWith target feature, independent Funcs computed
+// at the same level that read the same input get their loop nests
+// fused. Check which loops end up shared, and that the results are
+// unaffected.
+
+// Record, for each loop variable, whether some loop over it stores to
+// both of two Funcs.
+class FindSharedLoops : public IRMutator {
+    using IRMutator::visit;
+
+    std::set<std::string> stored;
+
+    Stmt visit(const Store *op) override {
+        stored.insert(op->name);
+        return IRMutator::visit(op);
+    }
+
+    Stmt visit(const For *op) override {
+        std::set<std::string> outer;
+        outer.swap(stored);
+        Stmt s = IRMutator::visit(op);
+        if (stored.count(a) && stored.count(b)) {
+            shared.insert(op->name.substr(op->name.rfind('.') + 1));
+        }
+        stored.insert(outer.begin(), outer.end());
+        return s;
+    }
+
+public:
+    std::string a, b;
+    std::set<std::string> shared;
+    FindSharedLoops(const std::string &a, const std::string &b)
+        : a(a), b(b) {
+    }
+};
+
+const int W = 64, H = 32;
+
+Buffer<int> make_input() {
+    Buffer<int> input(W + 4, H + 4);
+    input.set_min(-2, -2);
+    for (int y = -2; y < H + 2; y++) {
+        for (int x = -2; x < W + 2; x++) {
+            input(x, y) = x * 3 + y * 7 + (x ^ y);
+        }
+    }
+    return input;
+}
+
+// Realize f and g as outputs of one pipeline, and check which loops
+// they share, and that they match the reference values.
+bool check(const char *name, Func f, Func g,
+           std::function<int(int, int)> f_ref, std::function<int(int, int)> g_ref,
+           bool enable, std::set<std::string> expected_shared) {
+    Pipeline p({f, g});
+    FindSharedLoops *finder = new FindSharedLoops(f.name(), g.name());
+    p.add_custom_lowering_pass(finder, [=]() { delete finder; });
+
+    Target t = get_jit_target_from_environment();
+    if (enable) {
+        t = t.with_feature(Target::AutoComputeWith);
+    }
+    Realization r = p.realize(W, H, t);
+    Buffer<int> f_out = r[0], g_out = r[1];
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            if (f_out(x, y) != f_ref(x, y)) {
+                printf("%s: f(%d, %d) = %d instead of %d\n", name, x, y, f_out(x, y), f_ref(x, y));
+                return false;
+            }
+            if (g_out(x, y) != g_ref(x, y)) {
+                printf("%s: g(%d, %d) = %d instead of %d\n", name, x, y, g_out(x, y), g_ref(x, y));
+                return false;
+            }
+        }
+    }
+
+    if (finder->shared != expected_shared) {
+        printf("%s: unexpected set of shared loops:", name);
+        for (const std::string &s : finder->shared) {
+            printf(" %s", s.c_str());
+        }
+        printf("\n");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    Buffer<int> input = make_input();
+    auto in = [&](int x, int y) { return input(x, y); };
+    Var x("x"), y("y");
+
+    // Two cheap Funcs of the same input are fused all the way in.
+    {
+        Func f("f"), g("g");
+        f(x, y) = input(x, y) + 1;
+        g(x, y) = input(x, y) * 2;
+        if (!check("cheap", f, g,
+                   [&](int x, int y) { return in(x, y) + 1; },
+                   [&](int x, int y) { return in(x, y) * 2; },
+                   true, {"x", "y"})) {
+            return -1;
+        }
+    }
+
+    // Not without the target feature.
+    {
+        Func f("f"), g("g");
+        f(x, y) = input(x, y) + 1;
+        g(x, y) = input(x, y) * 2;
+        if (!check("disabled", f, g,
+                   [&](int x, int y) { return in(x, y) + 1; },
+                   [&](int x, int y) { return in(x, y) * 2; },
+                   false, {})) {
+            return -1;
+        }
+    }
+
+    // Funcs with many loads each are only fused at the rows, going
+    // through inlined Funcs to count the loads.
+    {
+        Func blur_x("blur_x"), f("f"), g("g");
+        blur_x(x, y) = input(x - 2, y) + input(x - 1, y) + input(x, y) + input(x + 1, y) + input(x + 2, y);
+        f(x, y) = blur_x(x, y - 2) + blur_x(x, y - 1) + blur_x(x, y) + blur_x(x, y + 1) + blur_x(x, y + 2);
+        g(x, y) = blur_x(x, y) - input(x, y);
+        auto blur_ref = [&](int x, int y) {
+            int s = 0;
+            for (int dy = -2; dy <= 2; dy++) {
+                for (int dx = -2; dx <= 2; dx++) {
+                    s += in(x + dx, y + dy);
+                }
+            }
+            return s;
+        };
+        auto blur_x_ref = [&](int x, int y) {
+            return in(x - 2, y) + in(x - 1, y) + in(x, y) + in(x + 1, y) + in(x + 2, y);
+        };
+        if (!check("expensive", f, g, blur_ref,
+                   [&](int x, int y) { return blur_x_ref(x, y) - in(x, y); },
+                   true, {"y"})) {
+            return -1;
+        }
+    }
+
+    // A Func that depends on another can't share its loops.
+    {
+        Func f("f"), g("g");
+        f(x, y) = input(x, y) + 1;
+        g(x, y) = f(x, y) + input(x, y);
+        if (!check("dependent", f, g,
+                   [&](int x, int y) { return in(x, y) + 1; },
+                   [&](int x, int y) { return 2 * in(x, y) + 1; },
+                   true, {})) {
+            return -1;
+        }
+    }
+
+    // Neither can Funcs with different schedules, or Funcs that don't
+    // read the same input.
+    {
+        Func f("f"), g("g");
+        f(x, y) = input(x, y) + 1;
+        g(x, y) = input(x, y) * 2;
+        g.vectorize(x, 8);
+        if (!check("different schedules", f, g,
+                   [&](int x, int y) { return in(x, y) + 1; },
+                   [&](int x, int y) { return in(x, y) * 2; },
+                   true, {})) {
+            return -1;
+        }
+    }
+    {
+        Buffer<int> other = make_input();
+        Func f("f"), g("g");
+        f(x, y) = input(x, y) + 1;
+        g(x, y) = other(x, y) * 2;
+        if (!check("different inputs", f, g,
+                   [&](int x, int y) { return in(x, y) + 1; },
+                   [&](int x, int y) { return other(x, y) * 2; },
+                   true, {})) {
+            return -1;
+        }
+    }
+
+    // Intermediate Funcs computed at the same level of a consumer are
+    // fused too.
+    {
+        Func f("f"), g("g"), out("out");
+        f(x, y) = input(x, y) + 1;
+        g(x, y) = input(x, y) * 2;
+        out(x, y) = f(x, y) + g(x, y);
+        f.compute_at(out, y);
+        g.compute_at(out, y);
+        FindSharedLoops *finder = new FindSharedLoops("f", "g");
+        out.add_custom_lowering_pass(finder, [=]() { delete finder; });
+        Buffer<int> result = out.realize(W, H, get_jit_target_from_environment().with_feature(Target::AutoComputeWith));
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W; x++) {
+                int correct = in(x, y) * 3 + 1;
+                if (result(x, y) != correct) {
+                    printf("intermediate: out(%d, %d) = %d instead of %d\n", x, y, result(x, y), correct);
+                    return -1;
+                }
+            }
+        }
+        if (!finder->shared.count("x")) {
+            printf("intermediate: f and g were not fused\n");
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
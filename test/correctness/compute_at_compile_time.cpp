@@ -0,0 +1,152 @@
+#include "Halide.h"
+#include <cmath>
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Funcs computed at compile time should be replaced by constant
+// Buffers before lowering. Check there are no loops over them or
+// allocations for them left, and that they are loaded from instead.
+class CheckComputedAtCompileTime : public IRMutator {
+    using IRMutator::visit;
+
+    Stmt visit(const ProducerConsumer *op) override {
+        if (op->name == name) {
+            found_producer = true;
+        }
+        return IRMutator::visit(op);
+    }
+
+    Expr visit(const Load *op) override {
+        if (op->name == name || starts_with(op->name, name + "_")) {
+            found_load = true;
+        }
+        return IRMutator::visit(op);
+    }
+
+public:
+    std::string name;
+    bool found_producer = false, found_load = false;
+    CheckComputedAtCompileTime(const std::string &n)
+        : name(n) {
+    }
+};
+
+bool error_occurred = false;
+void my_halide_error(void *user_context, const char *msg) {
+    error_occurred = true;
+}
+
+int main(int argc, char **argv) {
+    Var x("x"), y("y");
+
+    // A gamma curve lookup table, applied to an image.
+    {
+        const int W = 64, H = 32;
+        Buffer<uint8_t> input(W, H);
+        for (int j = 0; j < H; j++) {
+            for (int i = 0; i < W; i++) {
+                input(i, j) = (uint8_t)(i * 7 + j * 13);
+            }
+        }
+
+        Func gamma("gamma");
+        gamma(x) = cast<uint8_t>(clamp(255.0f * pow(x / 255.0f, 1 / 2.2f) + 0.5f, 0, 255));
+        gamma.bound(x, 0, 256).compute_at_compile_time();
+
+        Func out("out");
+        out(x, y) = gamma(input(x, y));
+        out.vectorize(x, 16);
+
+        CheckComputedAtCompileTime *checker = new CheckComputedAtCompileTime("gamma");
+        out.add_custom_lowering_pass(checker, [=]() { delete checker; });
+
+        Buffer<uint8_t> result = out.realize(W, H);
+
+        if (checker->found_producer) {
+            printf("gamma was computed at runtime\n");
+            return -1;
+        }
+        if (!checker->found_load) {
+            printf("Did not find a load from the gamma table\n");
+            return -1;
+        }
+
+        for (int j = 0; j < H; j++) {
+            for (int i = 0; i < W; i++) {
+                float v = 255.0f * std::pow(input(i, j) / 255.0f, 1 / 2.2f) + 0.5f;
+                int correct = (int)std::min(std::max(v, 0.0f), 255.0f);
+                if (std::abs(result(i, j) - correct) > 1) {
+                    printf("result(%d, %d) = %d instead of %d\n", i, j, result(i, j), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    // A table with a non-zero min, computed with an update, that
+    // depends on another table computed at compile time, and a
+    // Tuple-valued table.
+    {
+        Func squares("squares");
+        squares(x) = x * x;
+        squares.bound(x, -8, 17).compute_at_compile_time();
+
+        Func prefix_sum("prefix_sum");
+        RDom r(-7, 16);
+        prefix_sum(x) = squares(x);
+        prefix_sum(r) = prefix_sum(r - 1) + squares(r);
+        prefix_sum.bound(x, -8, 17).compute_at_compile_time();
+
+        Func sin_cos("sin_cos");
+        sin_cos(x) = Tuple(sin(x * 0.1f), cos(x * 0.1f));
+        sin_cos.bound(x, 0, 16).compute_at_compile_time();
+
+        Func out("out");
+        out(x) = cast<float>(prefix_sum(x - 8)) + sin_cos(x)[0] * sin_cos(x)[1];
+
+        CheckComputedAtCompileTime *checker = new CheckComputedAtCompileTime("sin_cos");
+        out.add_custom_lowering_pass(checker, [=]() { delete checker; });
+
+        Buffer<float> result = out.realize(16);
+
+        if (checker->found_producer || !checker->found_load) {
+            printf("sin_cos was not computed at compile time\n");
+            return -1;
+        }
+
+        int sum = 0;
+        for (int i = 0; i < 16; i++) {
+            int k = i - 8;
+            sum += k * k;
+            float correct = sum + std::sin(i * 0.1f) * std::cos(i * 0.1f);
+            if (std::abs(result(i) - correct) > 1e-4f) {
+                printf("result(%d) = %f instead of %f\n", i, result(i), correct);
+                return -1;
+            }
+        }
+    }
+
+    // Reading outside of the evaluated region should fail the bounds
+    // check on the constant buffer.
+    {
+        Func table("table");
+        table(x) = x * 3;
+        table.bound(x, 0, 10).compute_at_compile_time();
+
+        Func out("out");
+        out(x) = table(x) + table(x + 1);
+        out.set_error_handler(&my_halide_error);
+
+        error_occurred = false;
+        out.realize(10);
+        if (!error_occurred) {
+            printf("Reading past the end of a table computed at compile time should have been an error\n");
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
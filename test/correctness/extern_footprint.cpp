@@ -0,0 +1,118 @@
+#include "Halide.h"
+
+#include <atomic>
+#include <cstdio>
+
+using namespace Halide;
+
+#ifdef _WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT
+#endif
+
+std::atomic<int> calls{0};
+std::atomic<int> bad_calls{0};
+
+// An extern stage that knows nothing about bounds queries, and just
+// computes the region of the output it's handed.
+extern "C" DLLEXPORT int blur_x_no_bounds_query(halide_buffer_t *in, halide_buffer_t *out) {
+    if (in->is_bounds_query() || out->is_bounds_query()) {
+        bad_calls++;
+        return -1;
+    }
+    calls++;
+    int min_x = out->dim[0].min, max_x = min_x + out->dim[0].extent - 1;
+    int min_y = out->dim[1].min, max_y = min_y + out->dim[1].extent - 1;
+    if (in->dim[0].min > min_x - 1 ||
+        in->dim[0].min + in->dim[0].extent - 1 < max_x + 1 ||
+        in->dim[1].min > min_y ||
+        in->dim[1].min + in->dim[1].extent - 1 < max_y) {
+        bad_calls++;
+        return -1;
+    }
+    for (int y = min_y; y <= max_y; y++) {
+        for (int x = min_x; x <= max_x; x++) {
+            int l[] = {x - 1, y}, c[] = {x, y}, r[] = {x + 1, y};
+            *(int *)out->address_of(c) = (*(int *)in->address_of(l) +
+                                          *(int *)in->address_of(c) +
+                                          *(int *)in->address_of(r));
+        }
+    }
+    return 0;
+}
+
+bool check(const Buffer<int> &buf, int scale) {
+    for (int y = 0; y < buf.height(); y++) {
+        for (int x = 0; x < buf.width(); x++) {
+            int correct = scale * 3 * (x + y * 100);
+            if (buf(x, y) != correct) {
+                printf("buf(%d, %d) = %d instead of %d\n", x, y, buf(x, y), correct);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    const int W = 64, H = 48;
+    Var x, y, xo, yo, xi, yi;
+
+    {
+        // Compute the extern stage per tile of its consumer, inside a
+        // parallel loop.
+        Func input;
+        input(x, y) = x + y * 100;
+
+        Func blurred;
+        blurred.define_extern("blur_x_no_bounds_query", {input}, Int(32), {x, y});
+        blurred.extern_footprint({input(x - 1, y), input(x + 1, y)});
+
+        Func out;
+        out(x, y) = blurred(x, y) * 2;
+        out.tile(x, y, xo, yo, xi, yi, 16, 16).parallel(yo);
+        blurred.compute_at(out, xo);
+        input.compute_at(out, xo);
+
+        calls = 0;
+        Buffer<int> buf = out.realize(W, H);
+        if (!check(buf, 2)) {
+            return -1;
+        }
+        if (calls != (W / 16) * (H / 16)) {
+            printf("Extern stage was called %d times instead of once per tile\n", calls.load());
+            return -1;
+        }
+    }
+
+    {
+        // Tile the extern stage itself.
+        Func input;
+        input(x, y) = x + y * 100;
+
+        Func blurred;
+        blurred.define_extern("blur_x_no_bounds_query", {input}, Int(32), {x, y});
+        blurred.extern_footprint({input(x - 1, y), input(x + 1, y)});
+        blurred.compute_root().split(y, yo, yi, 8).parallel(yo);
+        input.compute_root();
+
+        calls = 0;
+        Buffer<int> buf = blurred.realize(W, H);
+        if (!check(buf, 1)) {
+            return -1;
+        }
+        if (calls != H / 8) {
+            printf("Extern stage was called %d times instead of once per strip\n", calls.load());
+            return -1;
+        }
+    }
+
+    if (bad_calls != 0) {
+        printf("Extern stage was called in bounds query mode, or with too small an input\n");
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,316 @@
+#include "Halide.h"
+#include "halide_test_dirs.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <regex>
+#include <string>
+#include <vector>
+
+using namespace Halide;
+
+// Compile some of the pipelines from apps/hexagon_benchmarks for HVX,
+// and count the packets and instructions in their innermost loops by
+// reading the assembly. Regressions in instruction selection for HVX
+// then show up as a failure here, on any host with the Hexagon LLVM
+// backend, instead of only when someone runs the benchmarks on a
+// device. Set HL_HVX_COUNTS_VERBOSE=1 to print the counts for every
+// inner loop, and a line of the table of counts below for each
+// pipeline, e.g. to update the table after an improvement.
+
+struct LoopCounts {
+    std::string label;
+    int packets = 0;
+    int instructions = 0;
+};
+
+// Find every hardware loop (loop0 is always the innermost), and
+// count the packets and instructions between its label and the
+// matching endloop0.
+std::vector<LoopCounts> count_inner_loops(const std::string &asm_filename) {
+    std::vector<std::string> lines;
+    {
+        std::ifstream asm_file(asm_filename);
+        std::string line;
+        while (std::getline(asm_file, line)) {
+            lines.push_back(line);
+        }
+    }
+
+    std::regex loop_start("loop0\\(([^,]+),");
+    std::vector<LoopCounts> result;
+    for (const std::string &line : lines) {
+        std::smatch m;
+        if (!std::regex_search(line, m, loop_start)) {
+            continue;
+        }
+        LoopCounts counts;
+        counts.label = m[1];
+
+        size_t i = 0;
+        while (i < lines.size() && lines[i].compare(0, counts.label.size() + 1, counts.label + ":") != 0) {
+            i++;
+        }
+        bool in_packet = false;
+        for (i++; i < lines.size(); i++) {
+            std::string l = lines[i];
+            l.erase(0, l.find_first_not_of(" \t"));
+            if (l.empty() || l[0] == '/' || l[0] == '.' || l[0] == '#') {
+                // Comments, labels and directives
+                continue;
+            }
+            if (l[0] == '{') {
+                in_packet = true;
+                counts.packets++;
+                l.erase(0, 1);
+                l.erase(0, l.find_first_not_of(" \t"));
+            }
+            bool end_of_packet = false;
+            size_t close = l.find('}');
+            if (close != std::string::npos) {
+                end_of_packet = true;
+            }
+            std::string instruction = l.substr(0, close);
+            instruction.erase(0, instruction.find_first_not_of(" \t"));
+            if (!instruction.empty()) {
+                counts.instructions++;
+                if (!in_packet) {
+                    // An instruction on its own is a packet too.
+                    counts.packets++;
+                }
+            }
+            if (end_of_packet) {
+                in_packet = false;
+            }
+            if (l.find(":endloop0") != std::string::npos) {
+                break;
+            }
+        }
+        result.push_back(counts);
+    }
+    return result;
+}
+
+// The counts measured for each pipeline: the number of inner loops,
+// which includes the loops over the borders of the image that loop
+// partitioning splits off, the packets and instructions of the
+// largest of them (the steady state), and the packets of all of them
+// together. A pipeline with no measured counts (all zero) is compiled
+// and its counts are printed, but it isn't checked, so the test
+// never passes or fails on made-up numbers.
+struct Counts {
+    const char *name;
+    int loops;
+    int packets;
+    int instructions;
+    int total_packets;
+};
+
+const Counts measured[] = {
+    {"conv3x3", 0, 0, 0, 0},
+    {"dilate3x3", 0, 0, 0, 0},
+    {"gaussian5x5", 0, 0, 0, 0},
+    {"median3x3", 0, 0, 0, 0},
+    {"sobel", 0, 0, 0, 0},
+};
+
+// The measured counts may grow by this many percent, and at least one,
+// before the test fails. That still catches an extra instruction or
+// two per row of a tile.
+const int margin_percent = 5;
+
+int with_margin(int count) {
+    return count + std::max(1, count * margin_percent / 100);
+}
+
+Var x{"x"}, y{"y"}, xi{"xi"}, yi{"yi"};
+
+// The common parts of the HVX schedules of the benchmarks.
+void schedule_hvx(Func output, Func bounded_input, ImageParam input, int tile_width) {
+    const int vector_size = 128;
+    input.dim(0).set_min(0);
+    input.dim(1).set_min(0);
+    input.dim(1).set_stride((input.dim(1).stride() / vector_size) * vector_size);
+    output.output_buffer().dim(0).set_min(0);
+    output.output_buffer().dim(1).set_min(0);
+    output.output_buffer().dim(1).set_stride((output.output_buffer().dim(1).stride() / vector_size) * vector_size);
+    bounded_input
+        .compute_at(output, y)
+        .align_storage(x, 128)
+        .vectorize(x, vector_size, TailStrategy::RoundUp);
+    output
+        .tile(x, y, xi, yi, tile_width, 4, TailStrategy::RoundUp)
+        .vectorize(xi)
+        .unroll(yi);
+    output.prefetch(input, y, 2);
+    Var yo;
+    output.split(y, yo, y, 128).parallel(yo);
+}
+
+Func conv3x3(ImageParam input, ImageParam mask) {
+    Func bounded_input("bounded_input"), output("conv3x3");
+    bounded_input(x, y) = BoundaryConditions::repeat_edge(input)(x, y);
+    Expr sum = cast<int16_t>(0);
+    for (int i = -1; i <= 1; i++) {
+        for (int j = -1; j <= 1; j++) {
+            sum += cast<int16_t>(bounded_input(x + j, y + i)) * cast<int16_t>(mask(j + 1, i + 1));
+        }
+    }
+    output(x, y) = cast<uint8_t>(clamp(sum >> 4, 0, 255));
+    schedule_hvx(output, bounded_input, input, 128);
+    return output;
+}
+
+Func dilate3x3(ImageParam input) {
+    Func bounded_input("bounded_input"), max_y("max_y"), output("dilate3x3");
+    bounded_input(x, y) = BoundaryConditions::repeat_edge(input)(x, y);
+    max_y(x, y) = max(bounded_input(x, y - 1), bounded_input(x, y), bounded_input(x, y + 1));
+    output(x, y) = max(max_y(x - 1, y), max_y(x, y), max_y(x + 1, y));
+    schedule_hvx(output, bounded_input, input, 128);
+    return output;
+}
+
+Func gaussian5x5(ImageParam input) {
+    Func bounded_input("bounded_input"), input_16("input_16"), rows("rows"), cols("cols"), output("gaussian5x5");
+    bounded_input(x, y) = BoundaryConditions::repeat_edge(input)(x, y);
+    input_16(x, y) = cast<int16_t>(bounded_input(x, y));
+    rows(x, y) = input_16(x, y - 2) + 4 * input_16(x, y - 1) + 6 * input_16(x, y) + 4 * input_16(x, y + 1) + input_16(x, y + 2);
+    cols(x, y) = rows(x - 2, y) + 4 * rows(x - 1, y) + 6 * rows(x, y) + 4 * rows(x + 1, y) + rows(x + 2, y);
+    output(x, y) = cast<uint8_t>(cols(x, y) >> 8);
+    schedule_hvx(output, bounded_input, input, 256);
+    rows.compute_at(output, y)
+        .tile(x, y, x, y, xi, yi, 128, 4, TailStrategy::RoundUp)
+        .vectorize(xi)
+        .unroll(yi);
+    return output;
+}
+
+Func median3x3(ImageParam input) {
+    Func bounded_input("bounded_input"), max_y("max_y"), min_y("min_y"), mid_y("mid_y");
+    Func minmax_x("minmax_x"), maxmin_x("maxmin_x"), midmid_x("midmid_x"), output("median3x3");
+    auto mid = [](Expr a, Expr b, Expr c) {
+        return max(min(max(a, b), c), min(a, b));
+    };
+    bounded_input(x, y) = BoundaryConditions::repeat_edge(input)(x, y);
+    max_y(x, y) = max(bounded_input(x, y - 1), bounded_input(x, y), bounded_input(x, y + 1));
+    min_y(x, y) = min(bounded_input(x, y - 1), bounded_input(x, y), bounded_input(x, y + 1));
+    mid_y(x, y) = mid(bounded_input(x, y - 1), bounded_input(x, y), bounded_input(x, y + 1));
+    minmax_x(x, y) = min(max_y(x - 1, y), max_y(x, y), max_y(x + 1, y));
+    maxmin_x(x, y) = max(min_y(x - 1, y), min_y(x, y), min_y(x + 1, y));
+    midmid_x(x, y) = mid(mid_y(x - 1, y), mid_y(x, y), mid_y(x + 1, y));
+    output(x, y) = mid(minmax_x(x, y), maxmin_x(x, y), midmid_x(x, y));
+    schedule_hvx(output, bounded_input, input, 128);
+    return output;
+}
+
+Func sobel(ImageParam input) {
+    Func bounded_input("bounded_input"), input_16("input_16");
+    Func sobel_x_avg("sobel_x_avg"), sobel_x("sobel_x"), sobel_y_avg("sobel_y_avg"), sobel_y("sobel_y");
+    Func output("sobel");
+    bounded_input(x, y) = BoundaryConditions::repeat_edge(input)(x, y);
+    input_16(x, y) = cast<uint16_t>(bounded_input(x, y));
+    sobel_x_avg(x, y) = input_16(x - 1, y) + 2 * input_16(x, y) + input_16(x + 1, y);
+    sobel_x(x, y) = absd(sobel_x_avg(x, y - 1), sobel_x_avg(x, y + 1));
+    sobel_y_avg(x, y) = input_16(x, y - 1) + 2 * input_16(x, y) + input_16(x, y + 1);
+    sobel_y(x, y) = absd(sobel_y_avg(x - 1, y), sobel_y_avg(x + 1, y));
+    output(x, y) = cast<uint8_t>(clamp(sobel_x(x, y) + sobel_y(x, y), 0, 255));
+    schedule_hvx(output, bounded_input, input, 128);
+    return output;
+}
+
+int main(int argc, char **argv) {
+    Target target(Target::NoOS, Target::Hexagon, 32, {Target::HVX, Target::NoAsserts, Target::NoBoundsQuery});
+    if (!target.supported()) {
+        printf("[SKIP] Halide was not built with the Hexagon backend.\n");
+        return 0;
+    }
+    const bool verbose = getenv("HL_HVX_COUNTS_VERBOSE") && std::string(getenv("HL_HVX_COUNTS_VERBOSE")) == "1";
+
+    bool success = true;
+    int unmeasured = 0;
+    for (const Counts &expected : measured) {
+        ImageParam input(UInt(8), 2, "input");
+        ImageParam mask(Int(8), 2, "mask");
+        std::string name = expected.name;
+        Func output;
+        std::vector<Argument> args = {input};
+        if (name == "conv3x3") {
+            output = conv3x3(input, mask);
+            args.push_back(mask);
+        } else if (name == "dilate3x3") {
+            output = dilate3x3(input);
+        } else if (name == "gaussian5x5") {
+            output = gaussian5x5(input);
+        } else if (name == "median3x3") {
+            output = median3x3(input);
+        } else {
+            output = sobel(input);
+        }
+
+        std::string asm_filename = Internal::get_test_tmp_dir() + "hvx_instruction_counts_" + name + ".s";
+        output.compile_to_assembly(asm_filename, args, name, target);
+
+        std::vector<LoopCounts> loops = count_inner_loops(asm_filename);
+        if (loops.empty()) {
+            printf("%s: Found no hardware loops in %s\n", expected.name, asm_filename.c_str());
+            success = false;
+            continue;
+        }
+
+        Counts actual = {expected.name, (int)loops.size(), 0, 0, 0};
+        for (const LoopCounts &l : loops) {
+            if (verbose) {
+                printf("%s: loop %s: %d packets, %d instructions\n",
+                       expected.name, l.label.c_str(), l.packets, l.instructions);
+            }
+            actual.packets = std::max(actual.packets, l.packets);
+            actual.instructions = std::max(actual.instructions, l.instructions);
+            actual.total_packets += l.packets;
+        }
+
+        if (verbose || expected.loops == 0) {
+            printf("    {\"%s\", %d, %d, %d, %d},\n", actual.name,
+                   actual.loops, actual.packets, actual.instructions, actual.total_packets);
+        }
+        if (expected.loops == 0) {
+            unmeasured++;
+            continue;
+        }
+
+        // Loop partitioning should split off the same border loops
+        // as when the counts were measured.
+        if (actual.loops != expected.loops) {
+            printf("%s: found %d inner loops in %s instead of %d\n",
+                   expected.name, actual.loops, asm_filename.c_str(), expected.loops);
+            success = false;
+        }
+        if (actual.packets > with_margin(expected.packets) ||
+            actual.instructions > with_margin(expected.instructions)) {
+            printf("%s: the largest inner loop in %s has %d packets and %d instructions. "
+                   "%d packets and %d instructions were measured.\n",
+                   expected.name, asm_filename.c_str(), actual.packets, actual.instructions,
+                   expected.packets, expected.instructions);
+            success = false;
+        }
+        if (actual.total_packets > with_margin(expected.total_packets)) {
+            printf("%s: the inner loops in %s have %d packets in total. %d were measured.\n",
+                   expected.name, asm_filename.c_str(), actual.total_packets, expected.total_packets);
+            success = false;
+        }
+    }
+
+    if (!success) {
+        return -1;
+    }
+
+    if (unmeasured == (int)(sizeof(measured) / sizeof(measured[0]))) {
+        printf("[SKIP] No HVX instruction counts have been measured yet. "
+               "Paste the lines printed above into the table in this test.\n");
+        return 0;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,152 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// With LargeBuffers, the index math in inner loops is split into a
+// 64-bit base computed outside the loop and a 32-bit offset, guarded
+// by a check that the offsets fit. Check the results match the
+// regular 32-bit indexing, for buffers whose coordinates and strides
+// only work with 64-bit indexing, and when the guard fails.
+
+// Count the loads of a buffer whose index has a 32-bit offset.
+class CountNarrowedLoads : public IRMutator {
+    using IRMutator::visit;
+
+    static bool has_32_bit_offset(Expr index) {
+        if (const Ramp *r = index.as<Ramp>()) {
+            index = r->base;
+        }
+        const Add *add = index.as<Add>();
+        if (add && is_const(add->b)) {
+            index = add->a;
+            add = index.as<Add>();
+        }
+        const Cast *c = add ? add->b.as<Cast>() : index.as<Cast>();
+        return c && c->type == Int(64) && c->value.type() == Int(32);
+    }
+
+    Expr visit(const Load *op) override {
+        if (op->name == buffer && has_32_bit_offset(op->index)) {
+            count++;
+        }
+        return IRMutator::visit(op);
+    }
+
+public:
+    std::string buffer;
+    int count = 0;
+    CountNarrowedLoads(const std::string &b)
+        : buffer(b) {
+    }
+};
+
+int main(int argc, char **argv) {
+    Target t = get_jit_target_from_environment();
+    if (t.bits != 64) {
+        printf("[SKIP] LargeBuffers only applies to 64-bit targets.\n");
+        return 0;
+    }
+    Target large = t.with_feature(Target::LargeBuffers);
+
+    Var x("x"), y("y");
+
+    // A vectorized stencil over a regular buffer.
+    {
+        const int W = 200, H = 50;
+        Buffer<uint16_t> input(W + 2, H + 2, "input");
+        input.set_min(-1, -1);
+        input.for_each_element([&](int x, int y) {
+            input(x, y) = (uint16_t)(x * 17 + y * 31);
+        });
+
+        Func f("f");
+        f(x, y) = (input(x - 1, y - 1) + input(x, y - 1) + input(x + 1, y - 1) +
+                   input(x - 1, y) + input(x, y) * 2 + input(x + 1, y) +
+                   input(x - 1, y + 1) + input(x, y + 1) + input(x + 1, y + 1));
+        f.vectorize(x, 8, TailStrategy::GuardWithIf);
+
+        CountNarrowedLoads *counter = new CountNarrowedLoads("input");
+        f.add_custom_lowering_pass(counter, [=]() { delete counter; });
+
+        Buffer<uint16_t> out = f.realize(W, H, large);
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W; x++) {
+                uint16_t correct = 0;
+                for (int dy = -1; dy <= 1; dy++) {
+                    for (int dx = -1; dx <= 1; dx++) {
+                        correct += input(x + dx, y + dy);
+                    }
+                }
+                correct += input(x, y);
+                if (out(x, y) != correct) {
+                    printf("stencil: out(%d, %d) = %d instead of %d\n", x, y, out(x, y), correct);
+                    return -1;
+                }
+            }
+        }
+        if (counter->count == 0) {
+            printf("stencil: no load of the input had a 32-bit offset\n");
+            return -1;
+        }
+    }
+
+    // A window of a buffer whose coordinates are far enough from zero
+    // that the products of coordinates and strides need 64 bits.
+    {
+        const int W = 4096, H = 16, min_y = 1 << 22;
+        Buffer<uint8_t> input(W, H);
+        input.set_min(0, min_y);
+        input.for_each_element([&](int x, int y) {
+            input(x, y) = (uint8_t)(x + y * 3);
+        });
+
+        ImageParam in(UInt(8), 2);
+        Func f;
+        f(x, y) = in(x, y) + in(x, y + 1);
+        f.vectorize(x, 16);
+
+        in.set(input);
+        Buffer<uint8_t> out(W, H - 1);
+        out.set_min(0, min_y);
+        f.realize(out, large);
+        for (int y = min_y; y < min_y + H - 1; y++) {
+            for (int x = 0; x < W; x++) {
+                uint8_t correct = input(x, y) + input(x, y + 1);
+                if (out(x, y) != correct) {
+                    printf("window: out(%d, %d) = %d instead of %d\n", x, y, out(x, y), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    // Strides so large that the offsets within the inner loop don't
+    // fit in 32 bits, though the accesses (on the diagonal) all land
+    // on the same byte. The original loop must be used.
+    {
+        uint8_t c = 42;
+        halide_dimension_t shape[] = {{0, 4, 1 << 30},
+                                      {0, 4, -(1 << 30)}};
+        Buffer<uint8_t> buf(&c, 2, shape);
+
+        ImageParam in(UInt(8), 2);
+        in.dim(0).set_stride(Expr());
+        in.set(buf);
+
+        Func f;
+        f(x) = in(x, x);
+
+        Buffer<uint8_t> out = f.realize(4, large);
+        for (int x = 0; x < 4; x++) {
+            if (out(x) != 42) {
+                printf("diagonal: out(%d) = %d instead of 42\n", x, out(x));
+                return -1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,166 @@
+#include "Halide.h"
+
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Division and mod by a runtime-valued, loop-invariant divisor get
+// replaced with a multiply and shifts during lowering. Check that the
+// result matches Halide's Euclidean semantics for all the awkward
+// divisors, for both scalar and vector code.
+
+// Make sure no vector division survives lowering.
+class CheckForVectorDivision : public IRMutator {
+    using IRMutator::visit;
+
+    Expr visit(const Div *op) override {
+        if (op->type.is_vector() && !op->type.is_float()) {
+            std::cerr << "Vector division was not lowered: " << Expr(op) << "\n";
+            exit(-1);
+        }
+        return IRMutator::visit(op);
+    }
+
+    Expr visit(const Mod *op) override {
+        if (op->type.is_vector() && !op->type.is_float()) {
+            std::cerr << "Vector mod was not lowered: " << Expr(op) << "\n";
+            exit(-1);
+        }
+        return IRMutator::visit(op);
+    }
+};
+
+// Check that no divisor was precomputed.
+class CheckNotHoisted : public IRMutator {
+    using IRMutator::visit;
+
+    Stmt visit(const LetStmt *op) override {
+        if (starts_with(op->name, "divisor")) {
+            std::cerr << "Divisor was hoisted: " << op->name << " = " << op->value << "\n";
+            exit(-1);
+        }
+        return IRMutator::visit(op);
+    }
+};
+
+std::mt19937 rng(0);
+
+template<typename T>
+bool test(int vector_width) {
+    const int W = 1024;
+    Buffer<T> input(W);
+    for (int x = 0; x < W; x++) {
+        input(x) = (T)rng();
+    }
+    // Make sure the extremes are in there.
+    input(0) = std::numeric_limits<T>::min();
+    input(1) = std::numeric_limits<T>::max();
+    input(2) = 0;
+    input(3) = (T)1;
+    input(4) = (T)-1;
+
+    Param<T> d;
+    Func f, g;
+    Var x;
+    f(x) = input(x) / d;
+    g(x) = input(x) % d;
+    if (vector_width > 1) {
+        f.vectorize(x, vector_width);
+        g.vectorize(x, vector_width);
+        f.add_custom_lowering_pass(new CheckForVectorDivision);
+        g.add_custom_lowering_pass(new CheckForVectorDivision);
+    }
+    f.compile_jit();
+    g.compile_jit();
+
+    std::vector<T> divisors = {0, 1, 2, 3, 7, 10, 127,
+                               std::numeric_limits<T>::max(),
+                               std::numeric_limits<T>::min(),
+                               (T)(std::numeric_limits<T>::max() / 2 + 1),
+                               (T)(std::numeric_limits<T>::max() / 2 + 2),
+                               (T)-1, (T)-2, (T)-3, (T)-7};
+    for (int i = 0; i < 32; i++) {
+        divisors.push_back((T)rng());
+    }
+
+    for (T divisor : divisors) {
+        d.set(divisor);
+        Buffer<T> quotient = f.realize(W);
+        Buffer<T> remainder = g.realize(W);
+        for (int x = 0; x < W; x++) {
+            T correct_q = div_imp(input(x), divisor);
+            T correct_r = mod_imp(input(x), divisor);
+            if (quotient(x) != correct_q) {
+                std::cerr << type_of<T>() << " x " << vector_width << ": ";
+                printf("%lld / %lld = %lld instead of %lld\n",
+                       (long long)input(x), (long long)divisor,
+                       (long long)quotient(x), (long long)correct_q);
+                return false;
+            }
+            if (remainder(x) != correct_r) {
+                std::cerr << type_of<T>() << " x " << vector_width << ": ";
+                printf("%lld %% %lld = %lld instead of %lld\n",
+                       (long long)input(x), (long long)divisor,
+                       (long long)remainder(x), (long long)correct_r);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template<typename T>
+bool test_all_widths() {
+    return test<T>(1) && test<T>(128 / (sizeof(T) * 8)) && test<T>(256 / (sizeof(T) * 8));
+}
+
+// A divisor loaded from memory under a condition inside the loop
+// must stay under that condition.
+bool test_guarded_load() {
+    const int W = 100;
+    Buffer<int> input(W), divisor(1);
+    for (int x = 0; x < W; x++) {
+        input(x) = (int)(rng() % 200) - 100;
+    }
+    divisor(0) = 7;
+
+    ImageParam in(Int(32), 1), d(Int(32), 1);
+    Func f;
+    Var x;
+    RDom r(0, W);
+    r.where(in(r) > 0);
+    f(x) = 0;
+    f(r) = in(r) / d(0);
+    f.add_custom_lowering_pass(new CheckNotHoisted);
+
+    in.set(input);
+    d.set(divisor);
+    Buffer<int> result = f.realize(W);
+    for (int x = 0; x < W; x++) {
+        int correct = input(x) > 0 ? input(x) / 7 : 0;
+        if (result(x) != correct) {
+            printf("result(%d) = %d instead of %d\n", x, result(x), correct);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (!test_all_widths<uint8_t>() ||
+        !test_all_widths<uint16_t>() ||
+        !test_all_widths<uint32_t>() ||
+        !test_all_widths<int8_t>() ||
+        !test_all_widths<int16_t>() ||
+        !test_all_widths<int32_t>() ||
+        !test_guarded_load()) {
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
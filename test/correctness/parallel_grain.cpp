@@ -0,0 +1,163 @@
+#include "Halide.h"
+#include <atomic>
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+#ifdef _WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT
+#endif
+
+// The thread pool hands out iterations of parallel loops in chunks.
+// Check that every iteration still runs exactly once, whatever the
+// chunking, for the simple do_par_for path, for loops with a grain
+// size, for nested loops, and for loops with async producers.
+
+const int max_size = 10000;
+std::atomic<int> visits[max_size];
+
+extern "C" DLLEXPORT int count_visit(int x) {
+    visits[x]++;
+    return x;
+}
+HalideExtern_1(int, count_visit, int);
+
+// Check the grain size makes it through lowering to the parallel loop.
+class CheckGrainSize : public IRMutator {
+    using IRMutator::visit;
+
+    Stmt visit(const For *op) override {
+        if (op->for_type == ForType::Parallel && op->grain_size == expected) {
+            found = true;
+        }
+        return IRMutator::visit(op);
+    }
+
+public:
+    int expected;
+    bool found = false;
+    CheckGrainSize(int e)
+        : expected(e) {
+    }
+};
+
+void reset_visits() {
+    for (int i = 0; i < max_size; i++) {
+        visits[i] = 0;
+    }
+}
+
+bool check_visits(const char *name, int size) {
+    for (int i = 0; i < size; i++) {
+        if (visits[i] != 1) {
+            printf("%s: iteration %d ran %d times\n", name, i, visits[i].load());
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (get_jit_target_from_environment().arch == Target::WebAssembly) {
+        printf("[SKIP] WebAssembly does not support threads yet.\n");
+        return 0;
+    }
+
+    Var x, y;
+
+    // A single parallel loop, with the default adaptive chunking and
+    // with a variety of grain sizes, including ones larger than the
+    // loop.
+    for (int grain : {0, 1, 7, 64, 20000}) {
+        for (int size : {1, 3, 100, max_size}) {
+            Func f;
+            f(x) = count_visit(x);
+            if (grain == 0) {
+                f.parallel(x);
+            } else {
+                f.parallel_grain(x, grain);
+            }
+
+            CheckGrainSize *checker = new CheckGrainSize(grain);
+            f.add_custom_lowering_pass(checker, [=]() { delete checker; });
+
+            reset_visits();
+            Buffer<int> out = f.realize(size);
+            if (!checker->found) {
+                printf("Did not find a parallel loop with grain size %d\n", grain);
+                return -1;
+            }
+            if (!check_visits("parallel_grain", size)) {
+                return -1;
+            }
+        }
+    }
+
+    // Nested parallel loops with different grain sizes.
+    {
+        const int W = 100, H = 80;
+        Func f;
+        f(x, y) = count_visit(y * W + x);
+        f.parallel_grain(y, 3).parallel(x);
+
+        reset_visits();
+        f.realize(W, H);
+        if (!check_visits("nested", W * H)) {
+            return -1;
+        }
+    }
+
+    // An update stage, and a grain size on a loop that came from a
+    // split.
+    {
+        Func f;
+        Var xo, xi;
+        f(x) = 0;
+        f(x) += count_visit(x);
+        f.update().split(x, xo, xi, 10).parallel_grain(xo, 5);
+
+        reset_visits();
+        Buffer<int> out = f.realize(1000);
+        if (!check_visits("update", 1000)) {
+            return -1;
+        }
+        for (int i = 0; i < 1000; i++) {
+            if (out(i) != i) {
+                printf("out(%d) = %d instead of %d\n", i, out(i), i);
+                return -1;
+            }
+        }
+    }
+
+    // A consumer with an async producer, so that each iteration of
+    // the chunked loop forks a task of its own and blocks on it.
+    {
+        const int W = 64, H = 200;
+        Func producer, consumer;
+        producer(x, y) = x + y;
+        consumer(x, y) = count_visit(y * W + x) + producer(x, y);
+        producer.compute_at(consumer, y).async();
+        consumer.parallel_grain(y, 16);
+
+        reset_visits();
+        Buffer<int> out = consumer.realize(W, H);
+        if (!check_visits("async", W * H)) {
+            return -1;
+        }
+        for (int j = 0; j < H; j++) {
+            for (int i = 0; i < W; i++) {
+                int correct = j * W + i + i + j;
+                if (out(i, j) != correct) {
+                    printf("out(%d, %d) = %d instead of %d\n", i, j, out(i, j), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
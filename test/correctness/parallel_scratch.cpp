@@ -0,0 +1,105 @@
+#include "Halide.h"
+#include <atomic>
+#include <stdio.h>
+
+using namespace Halide;
+
+// Dynamically-sized allocations inside parallel loops come from a
+// pool of scratch memory that lives for one call to the pipeline.
+// Check that the pool reuses memory across tasks, and gives it all
+// back, including when the pipeline fails part way through.
+
+std::atomic<int> mallocs, frees;
+
+void *my_malloc(void *user_context, size_t x) {
+    mallocs++;
+    void *orig = malloc(x + 64);
+    void *ptr = (void *)((((size_t)orig + 64) >> 6) << 6);
+    ((void **)ptr)[-1] = orig;
+    return ptr;
+}
+
+void my_free(void *user_context, void *ptr) {
+    frees++;
+    free(((void **)ptr)[-1]);
+}
+
+std::atomic<bool> error_occurred;
+
+void my_error_handler(void *user_context, const char *msg) {
+    error_occurred = true;
+}
+
+int main(int argc, char **argv) {
+    if (get_jit_target_from_environment().arch == Target::WebAssembly) {
+        printf("[SKIP] WebAssembly JIT does not support set_custom_allocator().\n");
+        return 0;
+    }
+
+    const int W = 256, H = 1024;
+    Param<int> rows, fail_at;
+
+    Func g, h, f;
+    Var x, y, yo, yi;
+    g(x, y) = x + y;
+    h(x, y) = g(x - 1, y) + g(x + 1, y);
+    f(x, y) = require(y < fail_at, h(x, y - 1) + h(x, y + 1), "Failed on purpose");
+
+    // The scratch for g and h has a size that depends on a Param,
+    // so can't go on the stack.
+    f.split(y, yo, yi, rows, TailStrategy::GuardWithIf).parallel(yo);
+    g.compute_at(f, yo);
+    h.compute_at(f, yo);
+
+    f.set_custom_allocator(my_malloc, my_free);
+    f.set_error_handler(my_error_handler);
+
+    rows.set(4);
+    const int tasks = H / 4;
+
+    // A successful run.
+    {
+        fail_at.set(H);
+        mallocs = frees = 0;
+        Buffer<int> out = f.realize(W, H);
+        if (mallocs != frees) {
+            printf("%d mallocs but %d frees\n", mallocs.load(), frees.load());
+            return -1;
+        }
+        // Each task needs two allocations, but should mostly reuse
+        // the ones from an earlier task.
+        if (mallocs >= tasks) {
+            printf("%d mallocs for %d tasks. Scratch memory is not being reused.\n",
+                   mallocs.load(), tasks);
+            return -1;
+        }
+        for (int j = 0; j < H; j++) {
+            for (int i = 0; i < W; i++) {
+                int correct = 2 * (2 * i + 2 * j);
+                if (out(i, j) != correct) {
+                    printf("out(%d, %d) = %d instead of %d\n", i, j, out(i, j), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    // A run that fails part way through.
+    {
+        fail_at.set(H / 2);
+        mallocs = frees = 0;
+        error_occurred = false;
+        f.realize(W, H);
+        if (!error_occurred) {
+            printf("Expected an error\n");
+            return -1;
+        }
+        if (mallocs != frees) {
+            printf("%d mallocs but %d frees after an error\n", mallocs.load(), frees.load());
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
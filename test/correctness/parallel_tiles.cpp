@@ -0,0 +1,154 @@
+#include "Halide.h"
+#include <atomic>
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+#ifdef _WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT
+#endif
+
+// Directly nested parallel loops get collapsed into a single 2-D
+// parallel loop that walks bands of rows, when their extents are
+// bounded well enough to count the iterations in 32 bits. Check every
+// site is still computed exactly once, for shapes that do and don't
+// divide evenly into tiles and bands.
+
+const int max_size = 200 * 200;
+std::atomic<int> visits[max_size];
+
+extern "C" DLLEXPORT int count_tile_visit(int x) {
+    visits[x]++;
+    return x;
+}
+HalideExtern_1(int, count_tile_visit, int);
+
+// Count the parallel loops, and those of them made by collapsing
+// nested ones.
+class CountParallelLoops : public IRMutator {
+    using IRMutator::visit;
+
+    Stmt visit(const For *op) override {
+        if (op->for_type == ForType::Parallel) {
+            count++;
+            if (ends_with(op->name, ".collapsed")) {
+                collapsed++;
+            }
+        }
+        return IRMutator::visit(op);
+    }
+
+public:
+    int count = 0, collapsed = 0;
+};
+
+bool test(int W, int H, int tile_w, int tile_h, bool use_grain, bool bounded) {
+    Func f;
+    Var x, y, xo, yo, xi, yi;
+    f(x, y) = count_tile_visit(y * W + x);
+    f.tile(x, y, xo, yo, xi, yi, tile_w, tile_h, TailStrategy::GuardWithIf);
+    if (use_grain) {
+        f.parallel_grain(yo, 2).parallel(xo);
+    } else {
+        f.parallel(yo).parallel(xo);
+    }
+    if (bounded) {
+        f.bound(x, 0, W).bound(y, 0, H);
+    }
+
+    CountParallelLoops *counter = new CountParallelLoops;
+    f.add_custom_lowering_pass(counter, [=]() { delete counter; });
+
+    for (int i = 0; i < max_size; i++) {
+        visits[i] = 0;
+    }
+    Buffer<int> out = f.realize(W, H);
+
+    // The grain size keeps the loops separate, and so do unbounded
+    // extents, which might have too many iterations to collapse.
+    // Otherwise the nest is replaced by a single collapsed loop.
+    bool ok;
+    if (use_grain) {
+        ok = counter->collapsed == 0;
+    } else if (bounded) {
+        ok = counter->collapsed == 1 && counter->count == 1;
+    } else {
+        ok = counter->collapsed == 0 && counter->count == 2;
+    }
+    if (!ok) {
+        printf("%dx%d with %dx%d tiles%s: got %d parallel loops, %d of them collapsed\n",
+               W, H, tile_w, tile_h, bounded ? " and known extents" : "",
+               counter->count, counter->collapsed);
+        return false;
+    }
+
+    for (int j = 0; j < H; j++) {
+        for (int i = 0; i < W; i++) {
+            int idx = j * W + i;
+            if (visits[idx] != 1 || out(i, j) != idx) {
+                printf("%dx%d with %dx%d tiles: site (%d, %d) visited %d times, with value %d\n",
+                       W, H, tile_w, tile_h, i, j, visits[idx].load(), out(i, j));
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (get_jit_target_from_environment().arch == Target::WebAssembly) {
+        printf("[SKIP] WebAssembly does not support threads yet.\n");
+        return 0;
+    }
+
+    for (bool bounded : {false, true}) {
+        // Evenly divisible, with a whole number of bands of tiles.
+        if (!test(128, 128, 8, 8, false, bounded) ||
+            // A short last band, and tiles that don't divide the image.
+            !test(200, 100, 16, 7, false, bounded) ||
+            // Fewer rows of tiles than a band.
+            !test(200, 20, 10, 10, false, bounded) ||
+            // A single column of tiles.
+            !test(8, 200, 8, 3, false, bounded) ||
+            // An explicit grain size keeps the loops separate.
+            !test(64, 64, 8, 8, true, bounded)) {
+            return -1;
+        }
+    }
+
+    // Three nested parallel loops collapse into one.
+    {
+        const int W = 20, H = 30, C = 3;
+        Func f;
+        Var x, y, c;
+        f(x, y, c) = count_tile_visit((c * H + y) * W + x);
+        f.reorder(x, y, c).parallel(c).parallel(y).parallel(x);
+        f.bound(x, 0, W).bound(y, 0, H).bound(c, 0, C);
+
+        CountParallelLoops *counter = new CountParallelLoops;
+        f.add_custom_lowering_pass(counter, [=]() { delete counter; });
+
+        for (int i = 0; i < max_size; i++) {
+            visits[i] = 0;
+        }
+        f.realize(W, H, C);
+        if (counter->collapsed != 1 || counter->count != 1) {
+            printf("Expected a single collapsed loop for a 3-D nest. "
+                   "Got %d collapsed loops of %d\n",
+                   counter->collapsed, counter->count);
+            return -1;
+        }
+        for (int i = 0; i < W * H * C; i++) {
+            if (visits[i] != 1) {
+                printf("3-D site %d visited %d times\n", i, visits[i].load());
+                return -1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
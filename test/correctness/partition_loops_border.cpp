@@ -0,0 +1,75 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Loop partitioning should split the loops over a 2-D boundary
+// condition into an interior, edges, and corners. Count the innermost
+// loops to check the border rows got their loop over x partitioned
+// too.
+class CountInnermostLoops : public IRMutator {
+    using IRMutator::visit;
+
+    bool contains_loop = false;
+
+    Stmt visit(const For *op) override {
+        contains_loop = false;
+        Stmt s = IRMutator::visit(op);
+        if (!contains_loop) {
+            count++;
+        }
+        contains_loop = true;
+        return s;
+    }
+
+public:
+    int count = 0;
+};
+
+int main(int argc, char **argv) {
+    const int W = 64, H = 48;
+    Buffer<int> input(W, H);
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            input(x, y) = x * 3 + y * 17;
+        }
+    }
+
+    Func clamped = BoundaryConditions::repeat_edge(input);
+    Func g("g");
+    Var x("x"), y("y");
+    g(x, y) = (clamped(x - 1, y) + clamped(x + 1, y) +
+               clamped(x, y - 1) + clamped(x, y + 1));
+    g.vectorize(x, 8);
+
+    CountInnermostLoops *counter = new CountInnermostLoops;
+    g.add_custom_lowering_pass(counter, [=]() { delete counter; });
+
+    Buffer<int> out = g.realize(W, H);
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            auto in = [&](int x, int y) {
+                return input(std::min(std::max(x, 0), W - 1),
+                             std::min(std::max(y, 0), H - 1));
+            };
+            int correct = in(x - 1, y) + in(x + 1, y) + in(x, y - 1) + in(x, y + 1);
+            if (out(x, y) != correct) {
+                printf("out(%d, %d) = %d instead of %d\n", x, y, out(x, y), correct);
+                return -1;
+            }
+        }
+    }
+
+    // Top and bottom border rows, and the interior rows, should each
+    // have a left edge, a middle, and a right edge.
+    if (counter->count < 9) {
+        printf("Expected the 2-D border to be partitioned into at least 9 regions. Got %d\n",
+               counter->count);
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
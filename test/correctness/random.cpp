@@ -173,6 +173,31 @@ int main(int argc, char **argv) {
         }
     }
 
+    // Several random variables in one definition are generated
+    // together, but should still be independent.
+    {
+        Expr r1 = cast<double>(random_float());
+        Expr r2 = cast<double>(random_float());
+        Expr r3 = cast<double>(random_float());
+        Expr r4 = cast<double>(random_float());
+        Expr r5 = cast<double>(random_float());
+
+        Func f;
+        f(x, y) = r1 + r2 + r3 + r4 + r5 - 2.5f;
+        f.vectorize(x, 8);
+
+        // The sum of five independent random variables has variance 5/12
+        const int S = 1024;
+        Buffer<double> im = f.realize(S, S);
+        RDom r(im);
+        double f_var = evaluate<double>(sum(im(r.x, r.y) * im(r.x, r.y))) / (S * S - 1);
+
+        if (fabs(f_var - 5.0 / 12) > tol) {
+            printf("Variance of f was supposed to be 5/12: %f\n", f_var);
+            return -1;
+        }
+    }
+
     printf("Success!\n");
 
     return 0;
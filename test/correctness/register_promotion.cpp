@@ -0,0 +1,95 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Small allocations accessed at constant indices from fully unrolled
+// code get replaced with lets. Check the results are still right, and
+// that the allocations are gone when they should be.
+
+class FindAllocation : public IRMutator {
+    using IRMutator::visit;
+
+    Stmt visit(const Allocate *op) override {
+        if (starts_with(op->name, prefix)) {
+            found = true;
+        }
+        return IRMutator::visit(op);
+    }
+
+public:
+    std::string prefix;
+    bool found = false;
+    FindAllocation(const std::string &p)
+        : prefix(p) {
+    }
+};
+
+const int W = 64, H = 32;
+
+bool test(const char *name, MemoryType memory_type, bool unroll_reduction, bool expect_promoted) {
+    Buffer<float> input(W + 2, H + 2);
+    for (int y = 0; y < input.height(); y++) {
+        for (int x = 0; x < input.width(); x++) {
+            input(x, y) = (float)((x * 7 + y * 13) % 17);
+        }
+    }
+
+    Func acc(name), out;
+    Var x, y, xo, yo, xi, yi;
+    RDom r(0, 3, 0, 3);
+    acc(x, y) = 0.0f;
+    acc(x, y) += input(x + r.x, y + r.y) * (r.x + 2 * r.y + 1);
+    out(x, y) = acc(x, y) * 2.0f;
+
+    out.tile(x, y, xo, yo, xi, yi, 8, 4).vectorize(xi).unroll(yi);
+    acc.compute_at(out, xo).store_in(memory_type).vectorize(x).unroll(y);
+    acc.update().vectorize(x).unroll(y);
+    if (unroll_reduction) {
+        acc.update().unroll(r.x).unroll(r.y);
+    }
+
+    FindAllocation *finder = new FindAllocation(name);
+    out.add_custom_lowering_pass(finder, [=]() { delete finder; });
+
+    Buffer<float> result = out.realize(W, H);
+
+    if (finder->found == expect_promoted) {
+        printf("%s: allocation was %s\n", name, finder->found ? "not promoted" : "unexpectedly promoted");
+        return false;
+    }
+
+    for (int j = 0; j < H; j++) {
+        for (int i = 0; i < W; i++) {
+            float correct = 0.0f;
+            for (int ry = 0; ry < 3; ry++) {
+                for (int rx = 0; rx < 3; rx++) {
+                    correct += input(i + rx, j + ry) * (rx + 2 * ry + 1);
+                }
+            }
+            correct *= 2.0f;
+            if (result(i, j) != correct) {
+                printf("%s: result(%d, %d) = %f instead of %f\n", name, i, j, result(i, j), correct);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (!test("acc_register", MemoryType::Register, true, true) ||
+        !test("acc_stack", MemoryType::Stack, true, true) ||
+        !test("acc_auto", MemoryType::Auto, true, true) ||
+        // The reduction loop carries the accumulators from one
+        // iteration to the next, so they have to stay in memory.
+        !test("acc_loop", MemoryType::Auto, false, false) ||
+        // Never promote things explicitly placed on the heap.
+        !test("acc_heap", MemoryType::Heap, true, false)) {
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -47,6 +47,7 @@ public:
         use_wasm_simd128 = target.has_feature(Target::WasmSimd128);
         use_wasm_sat_float_to_int = target.has_feature(Target::WasmSatFloatToInt);
         use_wasm_sign_ext = target.has_feature(Target::WasmSignExt);
+        use_wasm_relaxed_simd = target.has_feature(Target::WasmRelaxedSimd);
     }
 
     void add_tests() override {
@@ -1966,6 +1967,38 @@ public:
                 // Floating point to integer with saturation
                 check("i32x4.trunc_sat_f32x4_s", 8 * w, cast<int32_t>(f32_1));
                 check("i32x4.trunc_sat_f32x4_u", 8 * w, cast<uint32_t>(f32_1));
+
+                // Integer dot product
+                if (Halide::Internal::get_llvm_version() >= 120) {
+                    RDom r(0, 2);
+                    check("i32x4.dot_i16x8_s", 4 * w, sum(i32(in_i16(x * 2 + r)) * in_i16(x * 2 + r + 32)));
+                    check("i32x4.dot_i16x8_s", 4 * w, sum(i32(in_i8(x * 2 + r)) * in_u8(x * 2 + r + 32)));
+                }
+            }
+        }
+
+        if (use_wasm_relaxed_simd) {
+            for (int w = 1; w <= 4; w <<= 1) {
+                // Relaxed multiply-add
+                if (Halide::Internal::get_llvm_version() >= 160) {
+                    check("f32x4.relaxed_madd", 4 * w, f32_1 * f32_2 + f32_3);
+                    check("f64x2.relaxed_madd", 2 * w, f64_1 * f64_2 + f64_3);
+                    check("f32x4.relaxed_nmadd", 4 * w, f32_3 - f32_1 * f32_2);
+                    check("f64x2.relaxed_nmadd", 2 * w, f64_3 - f64_1 * f64_2);
+                } else {
+                    check("f32x4.*fma", 4 * w, f32_1 * f32_2 + f32_3);
+                    check("f64x2.*fma", 2 * w, f64_1 * f64_2 + f64_3);
+                    check("f32x4.*fms", 4 * w, f32_3 - f32_1 * f32_2);
+                    check("f64x2.*fms", 2 * w, f64_3 - f64_1 * f64_2);
+                }
+
+                // Relaxed dot products. One side must be known to fit
+                // in 7 bits.
+                if (Halide::Internal::get_llvm_version() >= 160) {
+                    RDom r2(0, 2), r4(0, 4);
+                    check("i16x8.relaxed_dot_i8x16_i7x16_s", 8 * w, sum(i16(in_i8(x * 2 + r2)) * (in_u8(x * 2 + r2 + 32) / 2)));
+                    check("i32x4.relaxed_dot_i8x16_i7x16_add_s", 4 * w, sum(i32(in_i8(x * 4 + r4)) * (in_u8(x * 4 + r4 + 32) / 2)));
+                }
             }
         }
     }
@@ -1982,6 +2015,7 @@ private:
     bool use_wasm_simd128{false};
     bool use_wasm_sat_float_to_int{false};
     bool use_wasm_sign_ext{false};
+    bool use_wasm_relaxed_simd{false};
     const Var x{"x"}, y{"y"};
 };
 }  // namespace
@@ -63,9 +63,10 @@ public:
 
     virtual bool can_run_code() const {
         // Assume we are configured to run wasm if requested
-        // (we'll fail further downstream if not)
+        // (we'll fail further downstream if not), except for relaxed
+        // simd, which the wasm executor can't run.
         if (target.arch == Target::WebAssembly) {
-            return true;
+            return !target.has_feature(Target::WasmRelaxedSimd);
         }
         // If we can (target matches host), run the error checking Halide::Func.
         Target host_target = get_host_target();
@@ -80,7 +81,7 @@ public:
                                   Target::FMA, Target::FMA4, Target::F16C,
                                   Target::VSX, Target::POWER_ARCH_2_07,
                                   Target::ARMv7s, Target::NoNEON,
-                                  Target::WasmSimd128}) {
+                                  Target::WasmSimd128, Target::RVV}) {
             if (target.has_feature(f) != host_target.has_feature(f)) {
                 can_run_the_code = false;
             }
@@ -0,0 +1,214 @@
+#include "Halide.h"
+#include "simd_op_check.h"
+
+// This test checks that the RISC-V backend generates vector
+// instructions when the RVV feature is enabled. Like
+// simd_op_check_hvx.cpp, it runs only when HL_TARGET asks for it,
+// e.g. HL_TARGET=riscv-64-linux-rvv or
+// HL_TARGET=riscv-64-linux-rvv-vector_bits_256. With LLVM older than
+// 15, also set HL_LLVM_ARGS=-riscv-v-vector-bits-min=<VLEN>, or LLVM
+// won't use vector registers for fixed-length vectors. The generated code is
+// only run when the host can run it, e.g. when this test was
+// cross-compiled for riscv64 and runs under QEMU user-mode emulation
+// (see cmake/toolchain.linux-riscv64.cmake).
+
+using namespace Halide;
+using namespace Halide::ConciseCasts;
+
+class SimdOpCheckRISCV : public SimdOpCheckTest {
+public:
+    SimdOpCheckRISCV(Target t, int w = 768, int h = 128)
+        : SimdOpCheckTest(t, w, h) {
+    }
+
+    bool can_run_code() const override {
+        // The host's VLEN isn't known, so only run code that doesn't
+        // assume a VLEN wider than the minimum.
+        return SimdOpCheckTest::can_run_code() &&
+               get_host_target().has_feature(Target::RVV) &&
+               target.vector_bits == 0;
+    }
+
+    void add_tests() override {
+        Expr f32_1 = in_f32(x), f32_2 = in_f32(x + 16), f32_3 = in_f32(x + 32);
+        Expr f64_1 = in_f64(x), f64_2 = in_f64(x + 16);
+        Expr i8_1 = in_i8(x), i8_2 = in_i8(x + 16);
+        Expr u8_1 = in_u8(x), u8_2 = in_u8(x + 16);
+        Expr i16_1 = in_i16(x), i16_2 = in_i16(x + 16);
+        Expr u16_1 = in_u16(x), u16_2 = in_u16(x + 16);
+        Expr i32_1 = in_i32(x), i32_2 = in_i32(x + 16);
+        Expr u32_1 = in_u32(x), u32_2 = in_u32(x + 16);
+        Expr i64_1 = in_i64(x), i64_2 = in_i64(x + 16);
+
+        // The number of lanes of each element size in one vector
+        // register.
+        const int vlen = target.vector_bits ? target.vector_bits : 128;
+        const int lanes8 = vlen / 8, lanes16 = vlen / 16, lanes32 = vlen / 32, lanes64 = vlen / 64;
+
+        // Each vector op is preceded by a vsetvli or vsetivli to set
+        // the vector length and element width.
+        check("vset*vli", lanes8, u8_1 + u8_2);
+
+        // Loads and stores
+        check("vle8.v", lanes8, u8_1);
+        check("vse8.v", lanes8, u8_1);
+        check("vle16.v", lanes16, u16_1);
+        check("vse16.v", lanes16, u16_1);
+        check("vle32.v", lanes32, f32_1);
+        check("vse32.v", lanes32, f32_1);
+        check("vle64.v", lanes64, i64_1);
+        check("vse64.v", lanes64, i64_1);
+
+        // Integer arithmetic
+        check("vadd.vv", lanes8, u8_1 + u8_2);
+        check("vadd.vv", lanes16, i16_1 + i16_2);
+        check("vadd.vv", lanes32, i32_1 + i32_2);
+        check("vadd.vv", lanes64, i64_1 + i64_2);
+        check("vsub.vv", lanes8, i8_1 - i8_2);
+        check("vsub.vv", lanes32, u32_1 - u32_2);
+        check("vmul.vv", lanes16, i16_1 * i16_2);
+        check("vmul.vv", lanes32, i32_1 * i32_2);
+        check("vand.vv", lanes8, u8_1 & u8_2);
+        check("vor.vv", lanes16, u16_1 | u16_2);
+        check("vxor.vv", lanes32, i32_1 ^ i32_2);
+        check("vmaxu.vv", lanes8, max(u8_1, u8_2));
+        check("vminu.vv", lanes16, min(u16_1, u16_2));
+        check("vmax.vv", lanes16, max(i16_1, i16_2));
+        check("vmin.vv", lanes32, min(i32_1, i32_2));
+        check("vsll.vi", lanes16, u16_1 << 3);
+        check("vsrl.vi", lanes16, u16_1 >> 3);
+        check("vsra.vi", lanes32, i32_1 >> 3);
+
+        // Saturating arithmetic
+        check("vsaddu.vv", lanes8, u8_sat(u16(u8_1) + u16(u8_2)));
+        check("vsadd.vv", lanes8, i8_sat(i16(i8_1) + i16(i8_2)));
+        check("vssubu.vv", lanes8, u8_sat(i16(u8_1) - i16(u8_2)));
+        check("vssub.vv", lanes16, i16_sat(i32(i16_1) - i32(i16_2)));
+
+        // Widening arithmetic
+        check("vwaddu.vv", lanes8, u16(u8_1) + u16(u8_2));
+        check("vwadd.vv", lanes8, i16(i8_1) + i16(i8_2));
+        check("vwaddu.vv", lanes16, u32(u16_1) + u32(u16_2));
+        check("vwadd.vv", lanes16, i32(i16_1) + i32(i16_2));
+        check("vwsubu.vv", lanes8, i16(u8_1) - i16(u8_2));
+        check("vwsub.vv", lanes16, i32(i16_1) - i32(i16_2));
+        check("vwmulu.vv", lanes8, u16(u8_1) * u16(u8_2));
+        check("vwmul.vv", lanes8, i16(i8_1) * i16(i8_2));
+        check("vwmulu.vv", lanes16, u32(u16_1) * u32(u16_2));
+        check("vwmul.vv", lanes16, i32(i16_1) * i32(i16_2));
+        check("vwmul.vv", lanes32, i64(i32_1) * i64(i32_2));
+        check("vwaddu.wv", lanes8, u16_1 + u16(u8_1));
+        check("vzext.vf2", lanes8, u16(u8_1));
+        check("vsext.vf2", lanes8, i16(i8_1));
+        check("vzext.vf4", lanes8, u32(u8_1));
+
+        // Narrowing
+        check("vnsrl.wi", lanes8, u8(u16_1 >> 8));
+        check("vnsrl.wi", lanes16, u16(u32_1 >> 16));
+        check("vnsra.wi", lanes8, i8(i16_1 >> 4));
+        check("vnsrl.wi", lanes8, u8(u16_1));
+        check("vnsrl.wi", lanes16, i16(i32_1));
+        // Averaging is widened then narrowed again.
+        check("vnsrl.wi", lanes8, u8((u16(u8_1) + u16(u8_2)) >> 1));
+
+        // High half of a multiply
+        check("vmulhu.vv", lanes16, u16((u32(u16_1) * u32(u16_2)) >> 16));
+        check("vmulh.vv", lanes16, i16((i32(i16_1) * i32(i16_2)) >> 16));
+        check("vmulhu.vv", lanes32, u32((u64(u32_1) * u64(u32_2)) >> 32));
+
+        // Comparisons and selects
+        check("vmslt*", lanes32, select(i32_1 < i32_2, i32_1, i32_2 * 3));
+        check("vmerge.vvm", lanes16, select(u16_1 == u16_2, u16_1, u16_2 * 3));
+
+        // Floating point
+        check("vfadd.vv", lanes32, f32_1 + f32_2);
+        check("vfsub.vv", lanes32, f32_1 - f32_2);
+        check("vfmul.vv", lanes32, f32_1 * f32_2);
+        check("vfdiv.vv", lanes32, f32_1 / f32_2);
+        check("vfmax.vv", lanes32, max(f32_1, f32_2));
+        check("vfmin.vv", lanes32, min(f32_1, f32_2));
+        check("vfsqrt.v", lanes32, sqrt(f32_1));
+        check("vfma*.vv", lanes32, f32_1 * f32_2 + f32_3);
+        check("vfadd.vv", lanes64, f64_1 + f64_2);
+        check("vfmul.vv", lanes64, f64_1 * f64_2);
+
+        // Conversions
+        check("vfcvt.f.x.v", lanes32, f32(i32_1));
+        check("vfcvt.f.xu.v", lanes32, f32(u32_1));
+        check("vfcvt.rtz.x.f.v", lanes32, i32(f32_1));
+        check("vfwcvt.f.f.v", lanes32, f64(f32_1));
+        check("vfncvt.f.f.w", lanes32, f32(f64_1));
+    }
+
+    // A vectorized loop whose tail is guarded should have the tail
+    // strip-mined into one masked vector iteration, rather than a
+    // scalar loop.
+    bool check_strip_mined_tail() {
+        const int lanes32 = (target.vector_bits ? target.vector_bits : 128) / 32;
+        Func f("strip_mined_tail");
+        f(x) = in_f32(x) * 2.0f + 1.0f;
+        f.vectorize(x, lanes32, TailStrategy::GuardWithIf);
+
+        std::string asm_filename = output_directory + "check_strip_mined_tail.s";
+        f.compile_to_assembly(asm_filename, arg_types, target);
+
+        std::ifstream asm_file(asm_filename);
+        bool masked_load = false, masked_store = false;
+        std::string line;
+        while (getline(asm_file, line)) {
+            masked_load |= wildcard_search("vle32.v*v0.t", line);
+            masked_store |= wildcard_search("vse32.v*v0.t", line);
+        }
+        if (!masked_load || !masked_store) {
+            printf("The tail of a vectorized loop was not strip-mined into masked vector loads and stores. See %s\n",
+                   asm_filename.c_str());
+            return false;
+        }
+        return true;
+    }
+
+private:
+    const Var x{"x"}, y{"y"};
+};
+
+int main(int argc, char **argv) {
+    Target host = get_host_target();
+    Target hl_target = get_target_from_environment();
+    printf("host is:      %s\n", host.to_string().c_str());
+    printf("HL_TARGET is: %s\n", hl_target.to_string().c_str());
+
+    if (hl_target.arch != Target::RISCV || !hl_target.has_feature(Target::RVV)) {
+        printf("[SKIP] No RISC-V vector target enabled.\n");
+        return 0;
+    }
+
+    Target t(hl_target.os, Target::RISCV, hl_target.bits, {Target::RVV});
+    t.vector_bits = hl_target.vector_bits;
+
+    SimdOpCheckRISCV test_riscv(t);
+
+    if (argc > 1) {
+        test_riscv.filter = argv[1];
+        test_riscv.set_num_threads(1);
+    }
+
+    if (getenv("HL_SIMD_OP_CHECK_FILTER")) {
+        test_riscv.filter = getenv("HL_SIMD_OP_CHECK_FILTER");
+    }
+
+    // See the comment in simd_op_check_hvx.cpp about why this is
+    // single-threaded.
+    test_riscv.set_num_threads(1);
+
+    if (argc > 2) {
+        test_riscv.output_directory = argv[2];
+    }
+    bool success = test_riscv.test_all() && test_riscv.check_strip_mined_tail();
+
+    if (!success) {
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
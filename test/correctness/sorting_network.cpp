@@ -0,0 +1,124 @@
+#include "Halide.h"
+#include <algorithm>
+#include <stdio.h>
+
+using namespace Halide;
+
+// Check the sorting network helpers, and sorting a Func along a
+// dimension, against std::sort.
+
+const int rows = 100;
+
+template<typename T>
+Buffer<T> random_buffer(int w, int h) {
+    Buffer<T> buf(w, h);
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            // Small values, so that there are plenty of ties.
+            buf(x, y) = (T)(rand() % 50);
+        }
+    }
+    return buf;
+}
+
+template<typename T>
+std::vector<T> sorted_row(const Buffer<T> &buf, int y) {
+    std::vector<T> row;
+    for (int x = 0; x < buf.width(); x++) {
+        row.push_back(buf(x, y));
+    }
+    std::sort(row.begin(), row.end());
+    return row;
+}
+
+template<typename T>
+bool test_sorting_network(int n) {
+    Buffer<T> input = random_buffer<T>(n, rows);
+    Var y;
+    std::vector<Expr> values;
+    for (int i = 0; i < n; i++) {
+        values.push_back(input(i, y));
+    }
+
+    Func sort_all, med, top;
+    sort_all(y) = Tuple(sorting_network(values));
+    med(y) = median(values);
+    const int k = std::max(1, n / 3);
+    top(y) = Tuple(top_k(values, k));
+    sort_all.vectorize(y, 8);
+    med.vectorize(y, 8);
+    top.vectorize(y, 8);
+
+    Realization sort_result = sort_all.realize(rows);
+    Buffer<T> med_result = med.realize(rows);
+    Realization top_result = top.realize(rows);
+
+    for (int r = 0; r < rows; r++) {
+        std::vector<T> correct = sorted_row(input, r);
+        for (int i = 0; i < n; i++) {
+            Buffer<T> out = sort_result[i];
+            if (out(r) != correct[i]) {
+                printf("sorting_network of size %d: element %d of row %d is %f instead of %f\n",
+                       n, i, r, (double)out(r), (double)correct[i]);
+                return false;
+            }
+        }
+        if (med_result(r) != correct[n / 2]) {
+            printf("median of size %d: row %d is %f instead of %f\n",
+                   n, r, (double)med_result(r), (double)correct[n / 2]);
+            return false;
+        }
+        for (int i = 0; i < k; i++) {
+            Buffer<T> out = top_result[i];
+            if (out(r) != correct[n - 1 - i]) {
+                printf("top_k of size %d: element %d of row %d is %f instead of %f\n",
+                       n, i, r, (double)out(r), (double)correct[n - 1 - i]);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template<typename T>
+bool test_sorted(int extent) {
+    Buffer<T> input = random_buffer<T>(extent, 3);
+    Func in;
+    Var x, y;
+    in(x, y) = input(x, y);
+    Func s = sorted(in, extent);
+    Buffer<T> out = s.realize(extent, 3);
+
+    for (int r = 0; r < 3; r++) {
+        std::vector<T> correct = sorted_row(input, r);
+        for (int i = 0; i < extent; i++) {
+            if (out(i, r) != correct[i]) {
+                printf("sorted of extent %d: element %d of row %d is %f instead of %f\n",
+                       extent, i, r, (double)out(i, r), (double)correct[i]);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    for (int n = 1; n <= 17; n++) {
+        if (!test_sorting_network<int>(n) ||
+            !test_sorting_network<float>(n) ||
+            !test_sorting_network<uint8_t>(n)) {
+            return -1;
+        }
+    }
+
+    for (int extent : {1, 2, 5, 8, 13, 100, 1024, 5000}) {
+        if (!test_sorted<int>(extent) ||
+            !test_sorted<float>(extent) ||
+            !test_sorted<uint8_t>(extent)) {
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// With the specialize_strides feature, loop nests that use buffers
+// with an unconstrained innermost stride get a fast path for dense
+// buffers and a generic fallback. Check both paths get generated, and
+// that both compute the right thing.
+
+// Look for vector loads of the input with a dense index and with a
+// runtime stride.
+class CheckLoadStrides : public IRMutator {
+    using IRMutator::visit;
+
+    Expr visit(const Load *op) override {
+        if (op->name == "in") {
+            if (const Ramp *r = op->index.as<Ramp>()) {
+                if (is_const_one(r->stride)) {
+                    dense = true;
+                } else if (!is_const(r->stride)) {
+                    strided = true;
+                }
+            }
+        }
+        return IRMutator::visit(op);
+    }
+
+public:
+    bool dense = false, strided = false;
+};
+
+bool check(const Buffer<float> &input, const Buffer<float> &out) {
+    for (int y = out.dim(1).min(); y <= out.dim(1).max(); y++) {
+        for (int x = out.dim(0).min(); x <= out.dim(0).max(); x++) {
+            float correct = input(x, y) * 2 + input(x + 1, y);
+            if (out(x, y) != correct) {
+                printf("out(%d, %d) = %f instead of %f\n", x, y, out(x, y), correct);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    const int W = 67, H = 23;
+
+    ImageParam in(Float(32), 2, "in");
+    in.dim(0).set_stride(Expr());
+
+    Func f("f");
+    Var x("x"), y("y");
+    f(x, y) = in(x, y) * 2 + in(x + 1, y);
+    f.output_buffer().dim(0).set_stride(Expr());
+    f.vectorize(x, 8, TailStrategy::GuardWithIf);
+
+    CheckLoadStrides *checker = new CheckLoadStrides;
+    f.add_custom_lowering_pass(checker, [=]() { delete checker; });
+
+    Target t = get_jit_target_from_environment().with_feature(Target::SpecializeStrides);
+    f.compile_jit(t);
+
+    if (!checker->dense || !checker->strided) {
+        printf("Expected both dense and strided loads of the input. Got dense: %d, strided: %d\n",
+               checker->dense, checker->strided);
+        return -1;
+    }
+
+    Buffer<float> dense(W + 1, H);
+    dense.for_each_element([&](int x, int y) { dense(x, y) = x * 0.5f + y; });
+
+    // Dense input and output.
+    in.set(dense);
+    {
+        Buffer<float> out(W, H);
+        f.realize(out, t);
+        if (!check(dense, out)) {
+            return -1;
+        }
+    }
+
+    // Transposed input and output.
+    Buffer<float> transposed = Buffer<float>(H, W + 1).transposed(0, 1);
+    transposed.copy_from(dense);
+    in.set(transposed);
+    {
+        Buffer<float> out = Buffer<float>(H, W).transposed(0, 1);
+        f.realize(out, t);
+        if (!check(transposed, out)) {
+            return -1;
+        }
+    }
+
+    // A dense input with an output that is one channel of an
+    // interleaved image.
+    in.set(dense);
+    {
+        Buffer<float> rgb = Buffer<float>::make_interleaved(W, H, 3);
+        Buffer<float> out = rgb.sliced(2, 1);
+        f.realize(out, t);
+        if (!check(dense, out)) {
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,112 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Tuple-valued Funcs scheduled with store_tuple_interleaved should
+// get a single allocation for all their elements, and produce the
+// same results as the default of one allocation per element.
+class CountAllocations : public IRMutator {
+    using IRMutator::visit;
+
+    Stmt visit(const Allocate *op) override {
+        if (starts_with(op->name, prefix)) {
+            count++;
+        }
+        return IRMutator::visit(op);
+    }
+
+public:
+    std::string prefix;
+    int count = 0;
+    CountAllocations(const std::string &p)
+        : prefix(p) {
+    }
+};
+
+int main(int argc, char **argv) {
+    const int W = 67, H = 33;
+    Buffer<float> re(W, H), im(W, H);
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            re(x, y) = (float)((x * 7 + y * 3) % 17) - 8;
+            im(x, y) = (float)((x * 5 + y * 11) % 13) - 6;
+        }
+    }
+
+    for (int vectorize = 0; vectorize < 2; vectorize++) {
+        for (int interleave = 0; interleave < 2; interleave++) {
+            Var x("x"), y("y");
+
+            // A complex multiply, whose result is consumed a few
+            // times per pixel.
+            Func product("product");
+            product(x, y) = Tuple(re(x, y) * re(x, y) - im(x, y) * im(x, y),
+                                  2 * re(x, y) * im(x, y));
+
+            // An RGBA-style tuple with an update definition.
+            Func rgba("rgba");
+            rgba(x, y) = Tuple(cast<int>(re(x, y)), cast<int>(im(x, y)), x, y);
+            rgba(x, y) = Tuple(rgba(x, y)[0] + 1, rgba(x, y)[1] * 2, rgba(x, y)[2], rgba(x, y)[3] - 1);
+
+            Func out("out");
+            Expr a = product(x, y)[0] + product(x + 1, y)[0];
+            Expr b = product(x, y)[1] - product(x, y + 1)[1];
+            out(x, y) = a * b + cast<float>(rgba(x, y)[0] + rgba(x, y)[1] + rgba(x, y)[2] * rgba(x, y)[3]);
+
+            product.compute_at(out, y);
+            rgba.compute_at(out, y);
+            if (vectorize) {
+                out.vectorize(x, 8, TailStrategy::GuardWithIf);
+                product.vectorize(x, 8, TailStrategy::RoundUp);
+                rgba.vectorize(x, 8, TailStrategy::RoundUp);
+                rgba.update().vectorize(x, 8, TailStrategy::RoundUp);
+            }
+            if (interleave) {
+                product.store_tuple_interleaved();
+                rgba.store_tuple_interleaved();
+            }
+
+            CountAllocations *product_allocations = new CountAllocations("product");
+            CountAllocations *rgba_allocations = new CountAllocations("rgba");
+            out.add_custom_lowering_pass(product_allocations, [=]() { delete product_allocations; });
+            out.add_custom_lowering_pass(rgba_allocations, [=]() { delete rgba_allocations; });
+
+            Buffer<float> result = out.realize(W - 1, H - 1);
+
+            int expected_product = interleave ? 1 : 2;
+            int expected_rgba = interleave ? 1 : 4;
+            if (product_allocations->count != expected_product ||
+                rgba_allocations->count != expected_rgba) {
+                printf("Expected %d and %d allocations for product and rgba. Got %d and %d\n",
+                       expected_product, expected_rgba,
+                       product_allocations->count, rgba_allocations->count);
+                return -1;
+            }
+
+            for (int y = 0; y < H - 1; y++) {
+                for (int x = 0; x < W - 1; x++) {
+                    auto p_re = [&](int x, int y) {
+                        return re(x, y) * re(x, y) - im(x, y) * im(x, y);
+                    };
+                    auto p_im = [&](int x, int y) {
+                        return 2 * re(x, y) * im(x, y);
+                    };
+                    int r = (int)re(x, y) + 1;
+                    int g = (int)im(x, y) * 2;
+                    float correct = ((p_re(x, y) + p_re(x + 1, y)) * (p_im(x, y) - p_im(x, y + 1)) +
+                                     (float)(r + g + x * (y - 1)));
+                    if (result(x, y) != correct) {
+                        printf("result(%d, %d) = %f instead of %f (vectorize = %d, interleave = %d)\n",
+                               x, y, result(x, y), correct, vectorize, interleave);
+                        return -1;
+                    }
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include "Halide.h"
+#include "halide_test_dirs.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace Halide;
+
+// Check the instruction selection for WebAssembly relaxed SIMD by
+// reading the assembly. The wasm JIT can't run relaxed SIMD, so this
+// runs on any host with the WebAssembly LLVM backend, and checks both
+// that the relaxed instructions are used, and that they aren't used
+// where they could change the results: under strict_float, or
+// without the wasm_relaxed_simd feature.
+
+// Does any line of the assembly for f contain all of the given
+// substrings?
+bool asm_contains(Func f, const std::vector<Argument> &args, const Target &t,
+                  const std::string &name, const std::vector<std::string> &patterns) {
+    std::string asm_filename = Internal::get_test_tmp_dir() + "wasm_relaxed_simd_" + name + ".s";
+    f.compile_to_assembly(asm_filename, args, name, t);
+
+    std::ifstream asm_file(asm_filename);
+    std::string line;
+    while (std::getline(asm_file, line)) {
+        bool all = true;
+        for (const std::string &p : patterns) {
+            all = all && line.find(p) != std::string::npos;
+        }
+        if (all) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char **argv) {
+    const Target simd("wasm-32-wasmrt-wasm_simd128");
+    const Target relaxed = simd.with_feature(Target::WasmRelaxedSimd);
+    if (!relaxed.supported()) {
+        printf("[SKIP] WebAssembly target not enabled.\n");
+        return 0;
+    }
+    const int llvm_version = Internal::get_llvm_version();
+    if (llvm_version < 140) {
+        printf("[SKIP] Relaxed SIMD requires LLVM 14 or later.\n");
+        return 0;
+    }
+
+    ImageParam a(Float(32), 1, "a"), b(Float(32), 1, "b"), c(Float(32), 1, "c");
+    ImageParam i8(Int(8), 1, "i8"), u8(UInt(8), 1, "u8");
+    const std::vector<Argument> float_args = {a, b, c};
+    const std::vector<Argument> int_args = {i8, u8};
+    Var x("x");
+
+    // The relaxed multiply-adds. Before LLVM 16, LLVM called them
+    // fma and fms.
+    const std::string madd = llvm_version >= 160 ? "relaxed_madd" : "fma";
+    const std::string nmadd = llvm_version >= 160 ? "relaxed_nmadd" : "fms";
+
+    {
+        Func f("madd");
+        f(x) = a(x) * b(x) + c(x);
+        f.vectorize(x, 4);
+        if (!asm_contains(f, float_args, relaxed, "madd", {"f32x4.", madd})) {
+            printf("f32x4 %s was not used for a multiply-add\n", madd.c_str());
+            return -1;
+        }
+        if (asm_contains(f, float_args, simd, "madd_no_relaxed", {"f32x4.", madd})) {
+            printf("f32x4 %s was used without wasm_relaxed_simd\n", madd.c_str());
+            return -1;
+        }
+    }
+
+    {
+        Func f("nmadd");
+        f(x) = c(x) - a(x) * b(x);
+        f.vectorize(x, 4);
+        if (!asm_contains(f, float_args, relaxed, "nmadd", {"f32x4.", nmadd})) {
+            printf("f32x4 %s was not used for a negated multiply-add\n", nmadd.c_str());
+            return -1;
+        }
+    }
+
+    {
+        // A relaxed multiply-add may or may not round the product, so
+        // it mustn't be used when the results must be exact.
+        Func f("strict_madd");
+        f(x) = strict_float(a(x) * b(x) + c(x));
+        f.vectorize(x, 4);
+        if (asm_contains(f, float_args, relaxed, "strict_madd", {"f32x4.", madd})) {
+            printf("f32x4 %s was used under strict_float\n", madd.c_str());
+            return -1;
+        }
+    }
+
+    if (llvm_version >= 160) {
+        // The relaxed dot product needs one side to fit in 7 bits.
+        RDom r(0, 4);
+        Func f("dot"), g("dot_unbounded");
+        f(x) = sum(cast<int32_t>(i8(x * 4 + r)) * (u8(x * 4 + r) / 2));
+        f.vectorize(x, 4);
+        if (!asm_contains(f, int_args, relaxed, "dot", {"i32x4.relaxed_dot_i8x16_i7x16_add_s"})) {
+            printf("i32x4.relaxed_dot_i8x16_i7x16_add_s was not used for a dot product\n");
+            return -1;
+        }
+        g(x) = sum(cast<int32_t>(i8(x * 4 + r)) * u8(x * 4 + r));
+        g.vectorize(x, 4);
+        if (asm_contains(g, int_args, relaxed, "dot_unbounded", {"relaxed_dot"})) {
+            printf("A relaxed dot product was used for an operand that doesn't fit in 7 bits\n");
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,25 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    ImageParam in(Int(32), 2, "in");
+    Var x("x"), y("y");
+    Func reader("reader"), f("f");
+    reader.define_extern("read_input", {in}, Int(32), {x, y});
+
+    // A stencil can't be computed in place, so the input gets copied,
+    // but the extern stage is passed the input itself, and reads it
+    // inside the loop nest of f.
+    Func clamped = BoundaryConditions::repeat_edge(in);
+    f(x, y) = clamped(x - 1, y) + clamped(x + 1, y) + reader(x, y);
+    reader.compute_at(f, y);
+
+    // Should result in an error
+    f.aliases(in);
+    f.compile_jit();
+
+    printf("Success!\n");
+    return 0;
+}
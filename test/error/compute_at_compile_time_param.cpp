@@ -0,0 +1,22 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    Param<float> gamma_exponent;
+    Func gamma("gamma"), out("out");
+    Var x("x");
+
+    gamma(x) = pow(x / 255.0f, gamma_exponent);
+    gamma.bound(x, 0, 256).compute_at_compile_time();
+
+    ImageParam input(UInt(8), 1);
+    out(x) = gamma(input(x));
+
+    // Should result in an error, because gamma depends on a Param
+    out.compile_jit();
+
+    printf("Success!\n");
+    return 0;
+}
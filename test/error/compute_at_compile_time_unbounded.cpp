@@ -0,0 +1,21 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    Func table("table"), out("out");
+    Var x("x");
+
+    table(x) = x * x;
+    table.compute_at_compile_time();
+
+    out(x) = table(x % 16);
+
+    // Should result in an error, because table has no bounds to
+    // evaluate it over
+    out.compile_jit();
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,20 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    Func a("a"), b("b"), blended("blended");
+    Var x("x"), y("y");
+    a(x, y) = x + y;
+    b(x, y) = x - y;
+
+    blended.define_extern("blend", {a, b}, Int(32), {x, y});
+
+    // Should result in an error, because the footprint says nothing
+    // about which sites of b are read.
+    blended.extern_footprint({a(x, y)});
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,20 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    Func input("input"), other("other"), blurred("blurred");
+    Var x("x"), y("y");
+    input(x, y) = x + y;
+    other(x, y) = x - y;
+
+    blurred.define_extern("blur_x", {input}, Int(32), {x, y});
+
+    // Should result in an error, because other is not an input of
+    // the extern stage.
+    blurred.extern_footprint({input(x - 1, y), other(x + 1, y)});
+
+    printf("Success!\n");
+    return 0;
+}
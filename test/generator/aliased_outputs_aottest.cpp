@@ -0,0 +1,77 @@
+#include "HalideBuffer.h"
+#include "HalideRuntime.h"
+
+#include <stdio.h>
+
+#include "aliased_outputs.h"
+
+using namespace Halide::Runtime;
+
+int allocations = 0;
+
+void *my_malloc(void *user_context, size_t sz) {
+    allocations++;
+    return halide_default_malloc(user_context, sz);
+}
+
+int main(int argc, char **argv) {
+    halide_set_custom_malloc(my_malloc);
+
+    // A width that isn't a multiple of the vector size.
+    const int W = 123, H = 45;
+    Buffer<float> original(W, H);
+    original.for_each_element([&](int x, int y) { original(x, y) = x * 0.5f - y; });
+
+    // In place: the same buffer as input and output.
+    Buffer<float> buf = original.copy();
+    int result = aliased_outputs(buf, buf);
+    if (result != 0) {
+        printf("In-place pipeline returned %d\n", result);
+        return -1;
+    }
+    if (allocations != 0) {
+        printf("In-place pipeline made %d allocations\n", allocations);
+        return -1;
+    }
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            float correct = original(x, y) * 2.0f + 1.0f;
+            if (buf(x, y) != correct) {
+                printf("buf(%d, %d) = %f instead of %f\n", x, y, buf(x, y), correct);
+                return -1;
+            }
+        }
+    }
+
+    // Separate buffers.
+    Buffer<float> output(W, H);
+    result = aliased_outputs(original, output);
+    if (result != 0) {
+        printf("Pipeline with separate buffers returned %d\n", result);
+        return -1;
+    }
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            float correct = original(x, y) * 2.0f + 1.0f;
+            if (output(x, y) != correct) {
+                printf("output(%d, %d) = %f instead of %f\n", x, y, output(x, y), correct);
+                return -1;
+            }
+        }
+    }
+
+    // The same memory, but with the rows of the output offset from
+    // those of the input, can't be done in place.
+    Buffer<float> larger(W, H + 1);
+    halide_dimension_t shape[] = {{0, W, 1}, {1, H, W}};
+    Buffer<float> shifted(larger.data(), 2, shape);
+    result = aliased_outputs(larger, shifted);
+    if (result != halide_error_code_aliased_buffer_mismatch) {
+        printf("Mismatched aliased buffers returned %d instead of %d\n",
+               result, halide_error_code_aliased_buffer_mismatch);
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
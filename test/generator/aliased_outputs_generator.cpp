@@ -0,0 +1,25 @@
+#include "Halide.h"
+
+namespace {
+
+class AliasedOutputs : public Halide::Generator<AliasedOutputs> {
+public:
+    Input<Buffer<float>> input{"input", 2};
+    Output<Buffer<float>> output{"output", 2};
+
+    void generate() {
+        Var x, y;
+
+        Func scaled;
+        scaled(x, y) = input(x, y) * 2.0f;
+        output(x, y) = scaled(x, y) + 1.0f;
+
+        // The output may be passed the same buffer as the input.
+        output.aliases(input);
+        output.vectorize(x, natural_vector_size<float>()).parallel(y);
+    }
+};
+
+}  // namespace
+
+HALIDE_REGISTER_GENERATOR(AliasedOutputs, aliased_outputs)
@@ -0,0 +1,110 @@
+#include "HalideBuffer.h"
+#include "HalideRuntime.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "cancellation.h"
+
+using namespace Halide::Runtime;
+
+std::atomic<int> allocations{0};
+std::atomic<int> checks{0};
+std::atomic<int> checks_until_cancel{0};
+
+void *my_malloc(void *user_context, size_t sz) {
+    allocations++;
+    return halide_default_malloc(user_context, sz);
+}
+
+void my_free(void *user_context, void *ptr) {
+    allocations--;
+    halide_default_free(user_context, ptr);
+}
+
+// Cancel once we've been asked a given number of times, and stay
+// cancelled.
+int cancel_after_some_checks(void *user_context) {
+    checks++;
+    return --checks_until_cancel <= 0;
+}
+
+// Cancel once the deadline stored in the user context has passed.
+struct Deadline {
+    std::chrono::steady_clock::time_point time;
+};
+
+int cancel_after_deadline(void *user_context) {
+    const Deadline *deadline = (const Deadline *)user_context;
+    return deadline && std::chrono::steady_clock::now() > deadline->time;
+}
+
+int main(int argc, char **argv) {
+    halide_set_custom_malloc(my_malloc);
+    halide_set_custom_free(my_free);
+
+    const int W = 256, H = 256;
+    Buffer<float> input(W, H), output(W, H);
+    input.for_each_value([](float &v) { v = (float)rand() / RAND_MAX; });
+
+    // With the default handler, the pipeline runs to completion.
+    int result = cancellation(nullptr, input, output);
+    if (result != 0) {
+        printf("Uncancelled pipeline returned %d\n", result);
+        return -1;
+    }
+
+    // Cancel partway through. The pipeline should stop with the
+    // cancellation error code, and free its scratch memory.
+    halide_set_custom_cancel_requested(cancel_after_some_checks);
+    checks_until_cancel = 20;
+    result = cancellation(nullptr, input, output);
+    if (result != halide_error_code_cancelled) {
+        printf("Cancelled pipeline returned %d instead of %d\n", result, halide_error_code_cancelled);
+        return -1;
+    }
+    if (allocations != 0) {
+        printf("Cancelled pipeline leaked %d allocations\n", allocations.load());
+        return -1;
+    }
+
+    // Stop promptly once asked: there may be one check in flight per
+    // thread, but not many more.
+    int checks_at_cancel = checks;
+    checks = 0;
+    checks_until_cancel = 1;
+    result = cancellation(nullptr, input, output);
+    if (result != halide_error_code_cancelled) {
+        printf("Pipeline returned %d when it should have been cancelled from the start\n", result);
+        return -1;
+    }
+    if (checks > 256) {
+        printf("Pipeline checked for cancellation %d times after being cancelled\n", checks.load());
+        return -1;
+    }
+
+    // A deadline that has already passed, and one that's far away.
+    halide_set_custom_cancel_requested(cancel_after_deadline);
+    Deadline past{std::chrono::steady_clock::now()};
+    result = cancellation(&past, input, output);
+    if (result != halide_error_code_cancelled) {
+        printf("Pipeline past its deadline returned %d\n", result);
+        return -1;
+    }
+    Deadline future{std::chrono::steady_clock::now() + std::chrono::hours(1)};
+    result = cancellation(&future, input, output);
+    if (result != 0) {
+        printf("Pipeline with a distant deadline returned %d\n", result);
+        return -1;
+    }
+    if (allocations != 0) {
+        printf("Leaked %d allocations\n", allocations.load());
+        return -1;
+    }
+
+    printf("Checked for cancellation %d times before cancelling\n", checks_at_cancel);
+    printf("Success!\n");
+    return 0;
+}
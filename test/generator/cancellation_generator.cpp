@@ -0,0 +1,33 @@
+#include "Halide.h"
+
+namespace {
+
+class Cancellation : public Halide::Generator<Cancellation> {
+public:
+    Input<Buffer<float>> input{"input", 2};
+    Output<Buffer<float>> output{"output", 2};
+
+    void generate() {
+        Var x, y;
+
+        // Make each pixel expensive enough that the pipeline takes a
+        // while, so that there's something to cancel.
+        Func clamped = Halide::BoundaryConditions::repeat_edge(input);
+        Func slow("slow");
+        RDom r(0, 64);
+        slow(x, y) = clamped(x, y);
+        slow(x, y) = sin(slow(x, y)) + cos(cast<float>(r));
+
+        output(x, y) = slow(x, y - 1) + slow(x, y) + slow(x, y + 1);
+
+        // A parallel loop over an internal allocation, and a serial
+        // outer loop in the output.
+        slow.compute_root().parallel(y);
+        slow.update().parallel(y);
+        output.vectorize(x, natural_vector_size<float>());
+    }
+};
+
+}  // namespace
+
+HALIDE_REGISTER_GENERATOR(Cancellation, cancellation)
@@ -0,0 +1,37 @@
+#include "HalideBuffer.h"
+#include "HalideRuntime.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <stdio.h>
+
+#include "compute_at_compile_time.h"
+
+using namespace Halide::Runtime;
+
+int main(int argc, char **argv) {
+    const int W = 256, H = 16;
+    Buffer<uint8_t> input(W, H), output(W, H);
+    input.for_each_element([&](int x, int y) { input(x, y) = (uint8_t)(x + y * 17); });
+
+    int result = compute_at_compile_time(input, output);
+    if (result != 0) {
+        printf("Pipeline returned %d\n", result);
+        return -1;
+    }
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            float v = 255.0f * std::pow(input(x, y) / 255.0f, 1 / 2.2f) + 0.5f;
+            int correct = (int)std::min(std::max(v, 0.0f), 255.0f);
+            if (std::abs(output(x, y) - correct) > 1) {
+                printf("output(%d, %d) = %d instead of %d\n", x, y, output(x, y), correct);
+                return -1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,26 @@
+#include "Halide.h"
+
+namespace {
+
+class ComputeAtCompileTime : public Halide::Generator<ComputeAtCompileTime> {
+public:
+    Input<Buffer<uint8_t>> input{"input", 2};
+    Output<Buffer<uint8_t>> output{"output", 2};
+
+    void generate() {
+        Var x, y;
+
+        // A gamma curve, evaluated while compiling and embedded in
+        // the object file as a constant table.
+        Func gamma;
+        gamma(x) = cast<uint8_t>(clamp(255.0f * pow(x / 255.0f, 1 / 2.2f) + 0.5f, 0, 255));
+        gamma.bound(x, 0, 256).compute_at_compile_time();
+
+        output(x, y) = gamma(input(x, y));
+        output.vectorize(x, natural_vector_size<uint8_t>());
+    }
+};
+
+}  // namespace
+
+HALIDE_REGISTER_GENERATOR(ComputeAtCompileTime, compute_at_compile_time)
@@ -0,0 +1,93 @@
+#include "HalideBuffer.h"
+#include "HalideRuntime.h"
+
+#include <map>
+#include <mutex>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "scratch_bytes_query.h"
+
+using namespace Halide::Runtime;
+
+// Track the peak number of bytes allocated by the pipeline. It
+// allocates from more than one thread.
+std::mutex mutex;
+std::map<void *, size_t> live;
+size_t live_bytes = 0, peak_bytes = 0;
+
+void *my_malloc(void *user_context, size_t sz) {
+    void *ptr = halide_default_malloc(user_context, sz);
+    std::lock_guard<std::mutex> lock(mutex);
+    live[ptr] = sz;
+    live_bytes += sz;
+    if (live_bytes > peak_bytes) {
+        peak_bytes = live_bytes;
+    }
+    return ptr;
+}
+
+void my_free(void *user_context, void *ptr) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        live_bytes -= live[ptr];
+        live.erase(ptr);
+    }
+    halide_default_free(user_context, ptr);
+}
+
+int main(int argc, char **argv) {
+    halide_set_custom_malloc(my_malloc);
+    halide_set_custom_free(my_free);
+
+    uint64_t last_prediction = 0;
+    for (int size : {300, 1000, 2000}) {
+        const int W = size, H = size * 3 / 4;
+
+        // The query only needs the shapes of the buffers.
+        Buffer<float> input_shape(nullptr, W, H), output_shape(nullptr, W, H);
+        Buffer<uint64_t> predicted = Buffer<uint64_t>::make_scalar();
+        int result = scratch_bytes_query_scratch_bytes(input_shape, output_shape, predicted);
+        if (result != 0) {
+            printf("Scratch bytes query returned %d\n", result);
+            return -1;
+        }
+
+        // Now run it for real.
+        Buffer<float> input(W, H), output(W, H);
+        input.fill(1.0f);
+        peak_bytes = 0;
+        result = scratch_bytes_query(input, output);
+        if (result != 0) {
+            printf("Pipeline returned %d\n", result);
+            return -1;
+        }
+
+        printf("%d x %d: predicted %llu bytes, used %llu bytes\n", W, H,
+               (unsigned long long)predicted(), (unsigned long long)peak_bytes);
+
+        // The prediction must be an upper bound. It assumes every
+        // parallel task is live at once, and that the scratch pool
+        // keeps every block requested from it, so it's allowed to be
+        // loose, but should still be a small multiple of the size of
+        // the image: a root blur_x, a pooled blur_y per strip and a
+        // pseudostack sharpen per strip.
+        if (predicted() < peak_bytes) {
+            printf("The prediction is smaller than the peak usage\n");
+            return -1;
+        }
+        const uint64_t image_bytes = (uint64_t)W * H * sizeof(float);
+        if (predicted() > 8 * image_bytes + 1024 * 1024) {
+            printf("The prediction is too large\n");
+            return -1;
+        }
+        if (predicted() <= last_prediction) {
+            printf("The prediction should grow with the size of the output\n");
+            return -1;
+        }
+        last_prediction = predicted();
+    }
+
+    printf("Success!\n");
+    return 0;
+}
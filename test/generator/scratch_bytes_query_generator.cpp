@@ -0,0 +1,33 @@
+#include "Halide.h"
+
+namespace {
+
+class ScratchBytesQuery : public Halide::Generator<ScratchBytesQuery> {
+public:
+    Input<Buffer<float>> input{"input", 2};
+    Output<Buffer<float>> output{"output", 2};
+
+    void generate() {
+        Var x, y, yo, yi;
+
+        Func clamped = Halide::BoundaryConditions::repeat_edge(input);
+        Func blur_x("blur_x"), blur_y("blur_y"), sharpen("sharpen");
+        blur_x(x, y) = clamped(x - 1, y) + clamped(x, y) + clamped(x + 1, y);
+        blur_y(x, y) = blur_x(x, y - 1) + blur_x(x, y) + blur_x(x, y + 1);
+        sharpen(x, y) = 2 * clamped(x, y) - blur_y(x, y) / 9;
+        output(x, y) = sharpen(x, y - 1) + sharpen(x, y) + sharpen(x, y + 1);
+
+        // A root allocation on the heap whose size depends on the
+        // output size. Inside a parallel loop, a dynamically sized
+        // allocation that comes from the scratch pool, and one on the
+        // stack that is too large for it, so goes to the pseudostack.
+        output.split(y, yo, yi, 16).parallel(yo);
+        blur_x.compute_root();
+        blur_y.compute_at(output, yo);
+        sharpen.compute_at(output, yo).store_in(MemoryType::Stack);
+    }
+};
+
+}  // namespace
+
+HALIDE_REGISTER_GENERATOR(ScratchBytesQuery, scratch_bytes_query)
@@ -0,0 +1,52 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+#include <cstdio>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+// A pointwise pipeline whose output aliases its input can be run in
+// place, which touches half as much memory as writing to a separate
+// output buffer. Compare the two.
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+
+    const int W = 4096, H = 4096;
+
+    ImageParam in(Float(32), 2);
+    Var x, y;
+    Func f;
+    f(x, y) = in(x, y) * 0.5f + 0.5f;
+    f.vectorize(x, target.natural_vector_size<float>()).parallel(y, 16);
+    f.aliases(in);
+    f.compile_jit();
+
+    Buffer<float> input(W, H), output(W, H);
+    input.fill(1.0f);
+
+    in.set(input);
+    double separate = benchmark([&]() { f.realize(output); });
+
+    // Each run maps 1 to 1, so the input is unchanged.
+    double in_place = benchmark([&]() { f.realize(input); });
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            if (input(x, y) != 1.0f) {
+                printf("input(%d, %d) = %f instead of 1\n", x, y, input(x, y));
+                return -1;
+            }
+        }
+    }
+
+    printf("Separate output buffer: %0.3f ms\n", separate * 1e3);
+    printf("In place:               %0.3f ms\n", in_place * 1e3);
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+#include <cstdio>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+// Several outputs computed from one large input, each scheduled on its
+// own, stream the input through the cache once per output. With the
+// AutoComputeWith target feature their loop nests are fused, so the
+// input is read from memory once. Compare the two.
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+
+    const int W = 4096, H = 2048;
+    Buffer<float> input(W, H, 3);
+    for (int c = 0; c < 3; c++) {
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W; x++) {
+                input(x, y, c) = (float)((x * 7 + y * 13 + c * 31) % 256);
+            }
+        }
+    }
+
+    double times[2];
+    Buffer<float> reference[3];
+    for (int fuse = 0; fuse < 2; fuse++) {
+        Var x, y;
+        Func r, g, b;
+        r(x, y) = input(x, y, 0);
+        g(x, y) = input(x, y, 1);
+        b(x, y) = input(x, y, 2);
+
+        Func luma, chroma_u, chroma_v;
+        luma(x, y) = 0.299f * r(x, y) + 0.587f * g(x, y) + 0.114f * b(x, y);
+        chroma_u(x, y) = 0.492f * (b(x, y) - luma(x, y));
+        chroma_v(x, y) = 0.877f * (r(x, y) - luma(x, y));
+
+        for (Func f : {luma, chroma_u, chroma_v}) {
+            f.vectorize(x, target.natural_vector_size<float>()).parallel(y, 16);
+        }
+
+        Pipeline p({luma, chroma_u, chroma_v});
+        Target t = fuse ? target.with_feature(Target::AutoComputeWith) : target;
+        p.compile_jit(t);
+
+        Realization out = p.realize(W, H, t);
+        times[fuse] = benchmark([&]() { p.realize(out); });
+
+        for (int i = 0; i < 3; i++) {
+            Buffer<float> o = out[i];
+            if (!fuse) {
+                reference[i] = o;
+                continue;
+            }
+            for (int y = 0; y < H; y++) {
+                for (int x = 0; x < W; x++) {
+                    if (o(x, y) != reference[i](x, y)) {
+                        printf("Output %d differs at (%d, %d): %f instead of %f\n",
+                               i, x, y, o(x, y), reference[i](x, y));
+                        return -1;
+                    }
+                }
+            }
+        }
+    }
+
+    printf("Separate loop nests: %0.3f ms\n", times[0] * 1e3);
+    printf("Fused loop nests:    %0.3f ms\n", times[1] * 1e3);
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+#include <cstdio>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+// Apply a gamma curve to a small image via a lookup table. Compare
+// computing the table inline at every use, computing it at root on
+// every run of the pipeline, and computing it once at compile time.
+
+enum Schedule {
+    Inline,
+    Root,
+    CompileTime,
+};
+
+double run(Schedule s, const Buffer<uint8_t> &input, Buffer<uint8_t> &output) {
+    Var x, y;
+    Func gamma;
+    gamma(x) = cast<uint8_t>(clamp(255.0f * pow(x / 255.0f, 1 / 2.2f) + 0.5f, 0, 255));
+
+    Func out;
+    out(x, y) = gamma(input(x, y));
+    out.vectorize(x, 16);
+
+    if (s == Root) {
+        gamma.bound(x, 0, 256).compute_root().vectorize(x, 16);
+    } else if (s == CompileTime) {
+        gamma.bound(x, 0, 256).compute_at_compile_time();
+    }
+
+    out.compile_jit();
+    return benchmark([&]() { out.realize(output); });
+}
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+
+    for (int size : {16, 64, 512}) {
+        Buffer<uint8_t> input(size, size);
+        input.for_each_element([&](int x, int y) { input(x, y) = (uint8_t)(x * 3 + y * 5); });
+
+        Buffer<uint8_t> reference(size, size), output(size, size);
+        double t_inline = run(Inline, input, reference);
+        double t_root = run(Root, input, output);
+        double t_compile_time = run(CompileTime, input, output);
+
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                if (output(x, y) != reference(x, y)) {
+                    printf("output(%d, %d) = %d instead of %d\n", x, y, output(x, y), reference(x, y));
+                    return -1;
+                }
+            }
+        }
+
+        printf("%4dx%-4d inline: %10.3f us  root: %10.3f us  compile time: %10.3f us\n",
+               size, size, t_inline * 1e6, t_root * 1e6, t_compile_time * 1e6);
+    }
+
+    printf("Success!\n");
+    return 0;
+}
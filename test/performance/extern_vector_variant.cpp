@@ -0,0 +1,118 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+#include <cstdio>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+#ifdef _WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT
+#endif
+
+// Vectorized calls to a pure extern function get scalarized into one
+// call per lane, unless a vector variant of the function has been
+// declared with Func::vector_extern. The declaration only applies to
+// the pipeline of the Func it was made on.
+
+#if defined(__GNUC__) || defined(__clang__)
+
+typedef float float4 __attribute__((vector_size(16)));
+
+int scalar_calls = 0, vector_calls = 0;
+
+extern "C" DLLEXPORT float poly(float x) {
+    scalar_calls++;
+    return ((x * 0.5f + 1.0f) * x + 2.0f) * x + 3.0f;
+}
+
+extern "C" DLLEXPORT float4 polyx4(float4 x) {
+    vector_calls++;
+    return ((x * 0.5f + 1.0f) * x + 2.0f) * x + 3.0f;
+}
+
+HalidePureExtern_1(float, poly, float);
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+    // Passing 128-bit vectors to C functions in registers is only
+    // part of the baseline calling convention on these.
+    if (target.bits != 64 || (target.arch != Target::X86 && target.arch != Target::ARM)) {
+        printf("[SKIP] Test requires a 64-bit x86 or ARM target.\n");
+        return 0;
+    }
+
+    const int N = 1 << 20;
+    Buffer<float> input(N);
+    for (int i = 0; i < N; i++) {
+        input(i) = (float)(i % 1000) / 1000.0f;
+    }
+
+    Var x;
+    Func scalarized, vectorized;
+    scalarized(x) = poly(input(x));
+    vectorized(x) = poly(input(x));
+    scalarized.vectorize(x, 8);
+    vectorized.vectorize(x, 8);
+
+    vectorized.vector_extern("poly", "polyx4", 4);
+    vectorized.compile_jit(target);
+    // Compiled after the declaration on the other pipeline, so this
+    // checks that the declaration doesn't leak into it.
+    scalarized.compile_jit(target);
+
+    Buffer<float> out_scalarized(N), out_vectorized(N);
+
+    scalar_calls = vector_calls = 0;
+    scalarized.realize(out_scalarized);
+    if (scalar_calls != N || vector_calls != 0) {
+        printf("Expected %d scalar calls and no vector calls. Got %d and %d\n",
+               N, scalar_calls, vector_calls);
+        return -1;
+    }
+
+    scalar_calls = vector_calls = 0;
+    vectorized.realize(out_vectorized);
+    if (scalar_calls != 0 || vector_calls != N / 4) {
+        printf("Expected no scalar calls and %d vector calls. Got %d and %d\n",
+               N / 4, scalar_calls, vector_calls);
+        return -1;
+    }
+
+    for (int i = 0; i < N; i++) {
+        if (out_scalarized(i) != out_vectorized(i)) {
+            printf("out_vectorized(%d) = %f instead of %f\n",
+                   i, out_vectorized(i), out_scalarized(i));
+            return -1;
+        }
+    }
+
+    double t_scalarized = benchmark([&]() { scalarized.realize(out_scalarized); });
+    double t_vectorized = benchmark([&]() { vectorized.realize(out_vectorized); });
+
+    printf("Scalarized calls: %f ms\n"
+           "Vector variant:   %f ms\n",
+           t_scalarized * 1e3, t_vectorized * 1e3);
+
+    if (t_vectorized > t_scalarized) {
+        printf("Calling the vector variant was slower than scalarizing.\n");
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
+
+#else
+
+int main(int argc, char **argv) {
+    printf("[SKIP] Test requires GCC-style vector extensions.\n");
+    return 0;
+}
+
+#endif
@@ -0,0 +1,111 @@
+#include "Halide.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace Halide;
+
+// Introspection reads the DWARF debug info of the running binary to
+// name Funcs and Vars after the C++ variables they are assigned to. It
+// indexes the compilation units at startup and only parses the ones
+// it needs, when it needs them. Compare the startup time and memory
+// use of this binary with introspection enabled and disabled via
+// HL_DISABLE_INTROSPECTION. The difference grows with the amount of
+// debug info in the binary.
+
+#ifndef _WIN32
+struct ChildStats {
+    double seconds;
+    long max_rss_kb;
+    bool ok;
+};
+
+ChildStats run_child(const char *self, bool disable) {
+    ChildStats stats = {0, 0, false};
+    auto t1 = std::chrono::high_resolution_clock::now();
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (disable) {
+            setenv("HL_DISABLE_INTROSPECTION", "1", 1);
+        } else {
+            unsetenv("HL_DISABLE_INTROSPECTION");
+        }
+        execl(self, self, disable ? "disabled" : "enabled", (char *)nullptr);
+        _exit(-1);
+    }
+    int status = 0;
+    struct rusage usage;
+    if (pid < 0 || wait4(pid, &status, 0, &usage) != pid) {
+        return stats;
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    stats.seconds = std::chrono::duration<double>(t2 - t1).count();
+#ifdef __APPLE__
+    // ru_maxrss is in bytes on OS X
+    stats.max_rss_kb = usage.ru_maxrss / 1024;
+#else
+    stats.max_rss_kb = usage.ru_maxrss;
+#endif
+    stats.ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    return stats;
+}
+#endif
+
+int main(int argc, char **argv) {
+    if (argc > 1) {
+        // We're the child. Name a Func, which is what consults the
+        // debug info.
+        auto t1 = std::chrono::high_resolution_clock::now();
+        Func some_func;
+        auto t2 = std::chrono::high_resolution_clock::now();
+        bool named = some_func.name().compare(0, 9, "some_func") == 0;
+        if (std::string(argv[1]) == "disabled" && named) {
+            printf("Func was named via introspection despite HL_DISABLE_INTROSPECTION\n");
+            return -1;
+        }
+        printf("  %s: first Func named %s in %f ms\n",
+               argv[1], some_func.name().c_str(),
+               std::chrono::duration<double>(t2 - t1).count() * 1e3);
+        return 0;
+    }
+
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+
+#ifdef _WIN32
+    printf("[SKIP] Introspection is not supported on Windows.\n");
+    return 0;
+#else
+    const int trials = 5;
+    ChildStats best[2] = {};
+    for (int disable = 0; disable < 2; disable++) {
+        for (int i = 0; i < trials; i++) {
+            ChildStats stats = run_child(argv[0], disable != 0);
+            if (!stats.ok) {
+                printf("Child process failed\n");
+                return -1;
+            }
+            if (i == 0 || stats.seconds < best[disable].seconds) {
+                best[disable] = stats;
+            }
+        }
+    }
+
+    printf("Introspection enabled:  %f ms to start, %ld KB max RSS\n",
+           best[0].seconds * 1e3, best[0].max_rss_kb);
+    printf("Introspection disabled: %f ms to start, %ld KB max RSS\n",
+           best[1].seconds * 1e3, best[1].max_rss_kb);
+
+    printf("Success!\n");
+    return 0;
+#endif
+}
@@ -0,0 +1,92 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+#include <cstdio>
+#include <cstdlib>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+// Blur a band of rows at the end of a buffer larger than 4 GB with the
+// LargeBuffers feature, and compare it to blurring the same rows from
+// a small buffer with regular 32-bit indexing. The index math in the
+// inner loop is done in 32 bits relative to a 64-bit base, so the two
+// should run at about the same speed.
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+    if (target.bits != 64) {
+        printf("[SKIP] LargeBuffers only applies to 64-bit targets.\n");
+        return 0;
+    }
+
+    const int W = 1 << 16, H = (1 << 16) + 512;
+    const int band = 256;
+
+    // Only the pages of the band get touched, so this doesn't need
+    // 4 GB of memory.
+    uint8_t *data = (uint8_t *)calloc((size_t)W * H, 1);
+    if (!data) {
+        printf("[SKIP] Could not reserve a buffer larger than 4 GB.\n");
+        return 0;
+    }
+    Buffer<uint8_t> large_input(data, W, H);
+    Buffer<uint8_t> small_input(W, band + 2);
+    small_input.set_min(0, H - band - 2);
+    for (int y = H - band - 2; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            large_input(x, y) = small_input(x, y) = (uint8_t)(x * 7 + y * 13);
+        }
+    }
+    // Use coordinates relative to the band for the small buffer, so
+    // that its index math fits in 32 bits.
+    small_input.set_min(0, 0);
+
+    double times[2];
+    Buffer<uint8_t> outputs[2];
+    for (int i = 0; i < 2; i++) {
+        ImageParam in(UInt(8), 2);
+        Var x, y, xi, yi;
+        Func clamped = BoundaryConditions::repeat_edge(in);
+        Func blur;
+        blur(x, y) = cast<uint8_t>((cast<uint16_t>(clamped(x - 1, y)) + clamped(x, y) + clamped(x + 1, y) +
+                                    clamped(x, y + 1) + clamped(x, y + 2)) /
+                                   5);
+        blur.vectorize(x, target.natural_vector_size<uint16_t>()).parallel(y, 8);
+
+        Buffer<uint8_t> out(W, band);
+        if (i == 0) {
+            in.set(small_input);
+            blur.compile_jit(target);
+        } else {
+            in.set(large_input);
+            out.set_min(0, H - band - 2);
+            blur.compile_jit(target.with_feature(Target::LargeBuffers));
+        }
+        blur.realize(out);
+        times[i] = benchmark([&]() { blur.realize(out); });
+        outputs[i] = out;
+    }
+
+    for (int y = 0; y < band; y++) {
+        for (int x = 0; x < W; x++) {
+            uint8_t a = outputs[0](x, y);
+            uint8_t b = outputs[1](x, y + H - band - 2);
+            if (a != b) {
+                printf("Output differs at (%d, %d): %d vs %d\n", x, y, a, b);
+                return -1;
+            }
+        }
+    }
+
+    printf("32-bit indices, small buffer:  %0.3f ms\n", times[0] * 1e3);
+    printf("LargeBuffers, 4 GB+ buffer:    %0.3f ms\n", times[1] * 1e3);
+
+    free(data);
+
+    printf("Success!\n");
+    return 0;
+}
@@ -12,10 +12,15 @@ int main(int argc, char **argv) {
 
     Param<int> p;
 
-    const char *names[3] = {"heap", "pseudostack", "stack"};
+    // Dynamically-sized allocations inside a parallel loop can go on
+    // the heap, in the pool of scratch memory shared by the parallel
+    // tasks (the default), on the pseudostack, or, once bounded, on
+    // the stack.
+    const char *names[4] = {"heap", "pool", "pseudostack", "stack"};
+    enum { Heap, Pool, Pseudostack, Stack };
 
-    double t[3];
-    for (int i = 0; i < 3; i++) {
+    double t[4];
+    for (int i = 0; i < 4; i++) {
         Var x("x");
 
         Func in;
@@ -35,10 +40,12 @@ int main(int argc, char **argv) {
         chain.back().split(x, xo, xi, p, TailStrategy::RoundUp);
         for (size_t j = 0; j < chain.size() - 1; j++) {
             chain[j].compute_at(chain.back(), xo);
-            if (i != 0) {
+            if (i == Heap) {
+                chain[j].store_in(MemoryType::Heap);
+            } else if (i != Pool) {
                 chain[j].store_in(MemoryType::Stack);
             }
-            if (i == 2) {
+            if (i == Stack) {
                 chain[j].bound_extent(x, p);
             }
             // Vectorize. Otherwise llvm autovectorizes the stack version, confusing the results
@@ -48,7 +55,7 @@ int main(int argc, char **argv) {
         // they can serialize in the allocator, so we should
         // parallelize things too.
         Var xoo;
-        if (i == 2) {
+        if (i == Stack) {
             chain.back().specialize(p == 200).split(xo, xoo, xo, 100, TailStrategy::RoundUp).parallel(xoo);
             chain.back().specialize_fail("Expected p == 200");
         } else {
@@ -67,11 +74,16 @@ int main(int argc, char **argv) {
         printf("Time using %s: %f\n", names[i], t[i]);
     }
 
-    if (t[0] < t[1]) {
+    if (t[Heap] < t[Pseudostack]) {
         printf("Heap allocation was faster than pseudostack!\n");
         return -1;
     }
 
+    if (t[Heap] < t[Pool]) {
+        printf("Heap allocation was faster than the scratch pool!\n");
+        return -1;
+    }
+
     printf("Success!\n");
     return 0;
 }
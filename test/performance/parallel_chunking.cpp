@@ -0,0 +1,112 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+#include <cstdio>
+#include <functional>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+// Compare the ways of scheduling a parallel loop with many iterations,
+// over a range of costs per iteration: a manual split into coarse
+// tasks, the default adaptive claiming of chunks, and an explicit
+// grain size. The last case has iterations of very different costs,
+// which is where coarse static tasks lose out.
+
+const int N = 1 << 16;
+
+enum Schedule {
+    Serial,
+    Coarse,
+    Adaptive,
+    Grain,
+};
+
+Func make_uniform(int cost) {
+    Var x;
+    Func f;
+    Expr math = cast<float>(x);
+    for (int i = 0; i < cost; i++) {
+        math = sqrt(cos(sin(math)));
+    }
+    f(x) = math;
+    return f;
+}
+
+Func make_skewed() {
+    // Early iterations cost much more than later ones.
+    Var x;
+    Func f;
+    RDom r(0, 256);
+    r.where(r < (N - x) / (N / 256));
+    f(x) = cast<float>(x);
+    f(x) = sqrt(cos(sin(f(x) + cast<float>(r))));
+    return f;
+}
+
+void schedule(Func f, Schedule s) {
+    Var x = f.args()[0];
+    Stage stage = f.has_update_definition() ? f.update() : Stage(f);
+    switch (s) {
+    case Serial:
+        break;
+    case Coarse:
+        stage.parallel(x, N / 64);
+        break;
+    case Adaptive:
+        stage.parallel(x);
+        break;
+    case Grain:
+        stage.parallel_grain(x, 256);
+        break;
+    }
+}
+
+bool run(const char *label, std::function<Func()> make) {
+    Buffer<float> reference;
+    double times[4];
+    for (int s = Serial; s <= Grain; s++) {
+        Func f = make();
+        schedule(f, (Schedule)s);
+        f.compile_jit();
+        Buffer<float> out = f.realize(N);
+        times[s] = benchmark([&]() { f.realize(out); });
+        if (s == Serial) {
+            reference = out;
+        } else {
+            for (int i = 0; i < N; i++) {
+                if (out(i) != reference(i)) {
+                    printf("%s: out(%d) = %f instead of %f\n", label, i, out(i), reference(i));
+                    return false;
+                }
+            }
+        }
+    }
+    printf("%-12s %10.3f %10.3f %10.3f %10.3f\n", label,
+           times[Serial] * 1e3, times[Coarse] * 1e3,
+           times[Adaptive] * 1e3, times[Grain] * 1e3);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+
+    printf("Times in ms for %d iterations\n", N);
+    printf("%-12s %10s %10s %10s %10s\n", "cost", "serial", "coarse", "adaptive", "grain 256");
+    for (int cost : {1, 8, 64, 256}) {
+        char label[32];
+        snprintf(label, sizeof(label), "uniform %d", cost);
+        if (!run(label, [=]() { return make_uniform(cost); })) {
+            return -1;
+        }
+    }
+    if (!run("skewed", make_skewed)) {
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
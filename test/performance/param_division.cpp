@@ -0,0 +1,130 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+#include <cstdint>
+#include <cstdio>
+#include <random>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+// Division by a runtime value that is invariant in the inner loop
+// (e.g. a Param) is lowered to a multiply and shifts, with the
+// multiplier precomputed outside the loop. Compare that to native
+// division done by a C++ loop, and to fast_integer_divide, which only
+// handles uint8 divisors.
+
+std::mt19937 rng(0);
+
+template<typename T>
+bool test(int w, bool div) {
+    const int W = 1024, H = 256;
+
+    size_t bits = sizeof(T) * 8;
+    bool is_signed = (T)(-1) < (T)(0);
+
+    printf("%sInt(%2d, %2d)    ",
+           is_signed ? " " : "U",
+           (int)bits, w);
+
+    Buffer<T> input(W, H);
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            input(x, y) = (T)rng();
+        }
+    }
+
+    // Keep the divisor positive and representable as a uint8 so that
+    // fast_integer_divide is a fair comparison.
+    T divisor = (T)(3 + rng() % 120);
+
+    Param<T> p;
+    p.set(divisor);
+
+    Func f, h;
+    Var x, y;
+    if (div) {
+        f(x, y) = input(x, y) / p;
+        h(x, y) = Halide::fast_integer_divide(input(x, y), cast<uint8_t>(p));
+    } else {
+        f(x, y) = input(x, y) % p;
+        h(x, y) = Halide::fast_integer_modulo(input(x, y), cast<uint8_t>(p));
+    }
+    if (w > 1) {
+        f.vectorize(x, w);
+        h.vectorize(x, w);
+    }
+    f.compile_jit();
+    h.compile_jit();
+
+    Buffer<T> correct(W, H);
+    double t_native = benchmark([&]() {
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W; x++) {
+                correct(x, y) = div ? Internal::div_imp(input(x, y), divisor) : Internal::mod_imp(input(x, y), divisor);
+            }
+        }
+    });
+
+    Buffer<T> fast = f.realize(W, H);
+    double t_fast = benchmark([&]() { f.realize(fast); });
+
+    Buffer<T> fast_table = h.realize(W, H);
+    double t_fast_table = benchmark([&]() { h.realize(fast_table); });
+
+    printf("%6.3f                  %6.3f\n", t_native / t_fast, t_native / t_fast_table);
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            if (fast(x, y) != correct(x, y)) {
+                printf("fast(%d, %d) = %lld instead of %lld (%lld/%lld)\n",
+                       x, y,
+                       (long long int)fast(x, y),
+                       (long long int)correct(x, y),
+                       (long long int)input(x, y),
+                       (long long int)divisor);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+
+    int seed = argc > 1 ? atoi(argv[1]) : time(nullptr);
+    rng.seed(seed);
+    std::cout << "param_division test seed: " << seed << std::endl;
+
+    bool success = true;
+    for (int i = 0; i < 2; i++) {
+        const char *name = (i == 0 ? "divisor" : "modulus");
+        printf("type            param-%s speed-up  table-%s speed-up\n", name, name);
+        // Scalar
+        success = success && test<int32_t>(1, i == 0);
+        success = success && test<int16_t>(1, i == 0);
+        success = success && test<int8_t>(1, i == 0);
+        success = success && test<uint32_t>(1, i == 0);
+        success = success && test<uint16_t>(1, i == 0);
+        success = success && test<uint8_t>(1, i == 0);
+        // Vector
+        success = success && test<int32_t>(8, i == 0);
+        success = success && test<int16_t>(16, i == 0);
+        success = success && test<int8_t>(32, i == 0);
+        success = success && test<uint32_t>(8, i == 0);
+        success = success && test<uint16_t>(16, i == 0);
+        success = success && test<uint8_t>(32, i == 0);
+    }
+
+    if (!success) {
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,60 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+#include <cstdio>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+// random_float and random_uint lower to the counter-based Philox-4x32
+// generator, which produces four words per evaluation. Compare it to
+// the hash chain they used to lower to, which is still available as
+// Internal::random_float, for a stage that needs one random number per
+// pixel and a stage that needs four.
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+
+    const int W = 1024, H = 1024;
+    Var x, y;
+
+    printf("values per pixel  hash chain (ms)  philox (ms)  speed-up\n");
+    for (int n : {1, 4}) {
+        Func hash_chain, philox;
+        Expr hash_sum = 0.0f, philox_sum = 0.0f;
+        for (int i = 0; i < n; i++) {
+            // The hash chain version of what random_float() used to lower to.
+            hash_sum += Internal::random_float({i * 2, 0, x, y});
+            philox_sum += random_float();
+        }
+        hash_chain(x, y) = hash_sum;
+        philox(x, y) = philox_sum;
+
+        hash_chain.vectorize(x, 8).parallel(y);
+        philox.vectorize(x, 8).parallel(y);
+
+        hash_chain.compile_jit();
+        philox.compile_jit();
+
+        Buffer<float> out(W, H);
+        double t_hash_chain = benchmark([&]() { hash_chain.realize(out); });
+        double t_philox = benchmark([&]() { philox.realize(out); });
+
+        // The output should still be uniformly distributed.
+        RDom r(out);
+        double mean = evaluate<double>(sum(cast<double>(out(r.x, r.y)))) / (W * H);
+        if (fabs(mean - 0.5 * n) > 0.01 * n) {
+            printf("Bad mean for %d values per pixel: %f\n", n, mean);
+            return -1;
+        }
+
+        printf("%16d  %15.3f  %11.3f  %8.3f\n",
+               n, t_hash_chain * 1e3, t_philox * 1e3, t_hash_chain / t_philox);
+    }
+
+    printf("Success!\n");
+    return 0;
+}
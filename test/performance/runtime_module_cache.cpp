@@ -0,0 +1,72 @@
+#include "Halide.h"
+#include "halide_test_dirs.h"
+#include <chrono>
+#include <cstdio>
+#include <functional>
+
+using namespace Halide;
+
+// Compiling a small pipeline spends much of its time parsing and
+// linking the runtime modules. That's done once per target, and the
+// result is reused by every later compilation in the process. Compare
+// the first compilation for each target against the later ones, over
+// a batch of small, distinct pipelines.
+
+const int N = 20;
+
+Func make_pipeline(int i) {
+    Var x, y;
+    Func f;
+    f(x, y) = cast<float>(x * (i + 1) + y) * (1.0f / (i + 1));
+    f.vectorize(x, 8);
+    return f;
+}
+
+double seconds_since(std::chrono::high_resolution_clock::time_point t) {
+    std::chrono::duration<double> d = std::chrono::high_resolution_clock::now() - t;
+    return d.count();
+}
+
+void time_compiles(const char *label, const std::function<void(int)> &compile) {
+    auto t0 = std::chrono::high_resolution_clock::now();
+    compile(0);
+    double first = seconds_since(t0);
+
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (int i = 1; i < N; i++) {
+        compile(i);
+    }
+    double rest = seconds_since(t1) / (N - 1);
+
+    printf("%-24s first: %8.2f ms   later: %8.2f ms\n", label, first * 1e3, rest * 1e3);
+}
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+
+    Target host = get_host_target();
+    std::string tmp = Internal::get_test_tmp_dir();
+
+    time_compiles("JIT", [&](int i) {
+        Func f = make_pipeline(i);
+        f.compile_jit(target);
+    });
+
+    time_compiles("AOT", [&](int i) {
+        Func f = make_pipeline(i);
+        f.compile_to_object(tmp + "runtime_module_cache.o", {}, "runtime_module_cache", host);
+    });
+
+    time_compiles("AOT without runtime", [&](int i) {
+        Func f = make_pipeline(i);
+        f.compile_to_object(tmp + "runtime_module_cache.o", {}, "runtime_module_cache",
+                            host.with_feature(Target::NoRuntime));
+    });
+
+    printf("Success!\n");
+    return 0;
+}
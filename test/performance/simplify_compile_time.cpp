@@ -0,0 +1,93 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+
+#include <cstdio>
+#include <random>
+
+using namespace Halide;
+using namespace Halide::Internal;
+using namespace Halide::Tools;
+
+// Measure how long the simplifier takes, both on its own on lots of
+// random expressions, and as part of lowering a pipeline with lots of
+// stages. The simplifier's rewrite rules dominate both. Build the
+// compiler with -DHALIDE_PROFILE_REWRITE_RULES=1 to get a per-rule
+// breakdown of where the time goes.
+
+std::mt19937 rng(0);
+
+Expr random_expr(int depth, Type t) {
+    static const char *names[] = {"x", "y", "z"};
+    if (depth == 0 || rng() % 8 == 0) {
+        if (rng() % 3 == 0) {
+            return make_const(t, (int)(rng() % 17) - 8);
+        }
+        Expr v = Variable::make(Int(32), names[rng() % 3]);
+        return t.is_vector() ? Ramp::make(v, make_const(Int(32), (int)(rng() % 3)), t.lanes()) : v;
+    }
+    Expr a = random_expr(depth - 1, t);
+    Expr b = random_expr(depth - 1, t);
+    switch (rng() % 8) {
+    case 0:
+        return a + b;
+    case 1:
+        return a - b;
+    case 2:
+        return a * make_const(t, (int)(rng() % 5) + 1);
+    case 3:
+        return min(a, b);
+    case 4:
+        return max(a, b);
+    case 5:
+        return a / make_const(t, (int)(rng() % 7) + 1);
+    case 6:
+        return a % make_const(t, (int)(rng() % 7) + 1);
+    default:
+        return select(a < b, a, b + make_const(t, 1));
+    }
+}
+
+Func many_stages(const Buffer<float> &input, int stages) {
+    Var x("x"), y("y"), xi("xi"), yi("yi");
+    Func f = BoundaryConditions::repeat_edge(input);
+    for (int i = 0; i < stages; i++) {
+        Func g("stage_" + std::to_string(i));
+        g(x, y) = (f(x - 1, y) + f(x + 1, y) + f(x, y - 1) + f(x, y + 1)) * 0.25f + f(x / 2, y / 2) * 0.5f;
+        if (i % 3 == 2) {
+            g.compute_root().tile(x, y, xi, yi, 32, 8).vectorize(xi, 8).parallel(y);
+        } else if (i > 0) {
+            f.compute_at(g, x).vectorize(x, 8);
+        }
+        f = g;
+    }
+    return f;
+}
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+
+    std::vector<Expr> exprs;
+    for (int i = 0; i < 2000; i++) {
+        exprs.push_back(random_expr(6, i % 2 ? Int(32) : Int(32, 8)));
+    }
+    double t_simplify = benchmark(3, 1, [&]() {
+        for (const Expr &e : exprs) {
+            simplify(e);
+        }
+    });
+    printf("Simplifying %d random expressions: %f ms\n", (int)exprs.size(), t_simplify * 1e3);
+
+    Buffer<float> input(256, 256);
+    double t_lower = benchmark(3, 1, [&]() {
+        Func f = many_stages(input, 24);
+        f.compile_to_module({}, "many_stages", target);
+    });
+    printf("Lowering a pipeline with 24 stages: %f ms\n", t_lower * 1e3);
+
+    printf("Success!\n");
+    return 0;
+}
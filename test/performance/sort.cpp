@@ -173,6 +173,17 @@ int main(int argc, char **argv) {
         f.realize(merge_sorted);
     });
 
+    printf("Library sort...\n");
+    f = sorted(input, N);
+    f.bound(f.args()[0], 0, N).vectorize(f.args()[0], 8);
+    f.compile_jit();
+    printf("Running...\n");
+    Buffer<int> library_sorted(N);
+    f.realize(library_sorted);
+    double t_library = benchmark([&]() {
+        f.realize(library_sorted);
+    });
+
     Buffer<int> correct(N);
     for (int i = 0; i < N; i++) {
         correct(i) = data(i);
@@ -185,13 +196,14 @@ int main(int argc, char **argv) {
     printf("Times:\n"
            "bitonic sort: %fms \n"
            "merge sort: %fms \n"
+           "library sort: %fms \n"
            "std::sort %fms\n",
-           t_bitonic * 1e3, t_merge * 1e3, t_std * 1e3);
+           t_bitonic * 1e3, t_merge * 1e3, t_library * 1e3, t_std * 1e3);
 
     if (N <= 100) {
         for (int i = 0; i < N; i++) {
-            printf("%8d %8d %8d\n",
-                   correct(i), bitonic_sorted(i), merge_sorted(i));
+            printf("%8d %8d %8d %8d\n",
+                   correct(i), bitonic_sorted(i), merge_sorted(i), library_sorted(i));
         }
     }
 
@@ -204,6 +216,10 @@ int main(int argc, char **argv) {
             printf("merge sort failed: %d -> %d instead of %d\n", i, merge_sorted(i), correct(i));
             return -1;
         }
+        if (library_sorted(i) != correct(i)) {
+            printf("library sort failed: %d -> %d instead of %d\n", i, library_sorted(i), correct(i));
+            return -1;
+        }
     }
 
     printf("Success!\n");
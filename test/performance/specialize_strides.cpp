@@ -0,0 +1,86 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+#include <cstdio>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+// Compare a pipeline whose input must be dense (the default) with the
+// same pipeline accepting any stride, with and without the
+// specialize_strides feature. On dense buffers, the specialized
+// version should be as fast as the dense-only one: the cost of the
+// dispatch is a few comparisons per loop nest. On strided buffers it
+// should be no slower than the generic version.
+
+const int W = 2048, H = 2048;
+
+Func make_blur(ImageParam in, bool any_stride) {
+    Var x, y;
+    Func f;
+    f(x, y) = (in(x, y) + in(x + 1, y) + in(x + 2, y)) * 0.25f + in(x + 1, y + 1) * 0.25f;
+    if (any_stride) {
+        in.dim(0).set_stride(Expr());
+    }
+    f.vectorize(x, 8).parallel(y, 16);
+    return f;
+}
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+
+    Buffer<float> dense(W + 2, H + 1);
+    dense.for_each_element([&](int x, int y) { dense(x, y) = (float)((x * 7 + y * 13) % 256); });
+    Buffer<float> strided = Buffer<float>(H + 1, W + 2).transposed(0, 1);
+    strided.copy_from(dense);
+
+    ImageParam in_dense(Float(32), 2), in_generic(Float(32), 2), in_special(Float(32), 2);
+    Func dense_only = make_blur(in_dense, false);
+    Func generic = make_blur(in_generic, true);
+    Func special = make_blur(in_special, true);
+
+    Target special_target = target.with_feature(Target::SpecializeStrides);
+    dense_only.compile_jit(target);
+    generic.compile_jit(target);
+    special.compile_jit(special_target);
+
+    Buffer<float> reference(W, H), out(W, H);
+
+    in_dense.set(dense);
+    double t_dense_only = benchmark([&]() { dense_only.realize(reference, target); });
+
+    in_generic.set(dense);
+    double t_generic_dense = benchmark([&]() { generic.realize(out, target); });
+    in_special.set(dense);
+    double t_special_dense = benchmark([&]() { special.realize(out, special_target); });
+
+    in_generic.set(strided);
+    double t_generic_strided = benchmark([&]() { generic.realize(out, target); });
+    in_special.set(strided);
+    double t_special_strided = benchmark([&]() { special.realize(out, special_target); });
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            if (out(x, y) != reference(x, y)) {
+                printf("out(%d, %d) = %f instead of %f\n", x, y, out(x, y), reference(x, y));
+                return -1;
+            }
+        }
+    }
+
+    printf("                 dense input   strided input\n");
+    printf("dense only:      %8.3f ms\n", t_dense_only * 1e3);
+    printf("any stride:      %8.3f ms     %8.3f ms\n", t_generic_dense * 1e3, t_generic_strided * 1e3);
+    printf("specialized:     %8.3f ms     %8.3f ms\n", t_special_dense * 1e3, t_special_strided * 1e3);
+
+    if (t_special_dense > t_dense_only * 1.5) {
+        printf("The specialized path on a dense input should be about as fast as the dense-only pipeline.\n");
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+#include <cstdio>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+// Compare storing the elements of an RGBA tuple in separate
+// allocations (the default) against storing them interleaved in one
+// allocation with store_tuple_interleaved, for a blur whose
+// intermediate is consumed a channel at a time by every output pixel.
+
+double test(bool interleave, Buffer<float> &out, const Buffer<uint8_t> &input) {
+    Var x("x"), y("y"), c("c"), xi("xi"), yi("yi");
+
+    Func in = BoundaryConditions::repeat_edge(input);
+
+    Func rgba("rgba");
+    auto channel = [&](int ch, Expr x, Expr y) {
+        return cast<float>(in(x, y, ch)) * (1.0f / 255);
+    };
+    rgba(x, y) = Tuple(channel(0, x, y), channel(1, x, y), channel(2, x, y), channel(3, x, y));
+
+    Func blur_x("blur_x");
+    blur_x(x, y) = Tuple(rgba(x - 1, y)[0] + rgba(x, y)[0] + rgba(x + 1, y)[0],
+                         rgba(x - 1, y)[1] + rgba(x, y)[1] + rgba(x + 1, y)[1],
+                         rgba(x - 1, y)[2] + rgba(x, y)[2] + rgba(x + 1, y)[2],
+                         rgba(x - 1, y)[3] + rgba(x, y)[3] + rgba(x + 1, y)[3]);
+
+    Func blur("blur");
+    Expr alpha = blur_x(x, y - 1)[3] + blur_x(x, y)[3] + blur_x(x, y + 1)[3];
+    blur(x, y, c) = mux(c, {blur_x(x, y - 1)[0] + blur_x(x, y)[0] + blur_x(x, y + 1)[0],
+                            blur_x(x, y - 1)[1] + blur_x(x, y)[1] + blur_x(x, y + 1)[1],
+                            blur_x(x, y - 1)[2] + blur_x(x, y)[2] + blur_x(x, y + 1)[2],
+                            alpha}) *
+                    (1.0f / 9);
+
+    blur.output_buffer().dim(0).set_stride(4).dim(2).set_stride(1);
+    blur.reorder(c, x, y).bound(c, 0, 4).unroll(c).tile(x, y, xi, yi, 64, 16).vectorize(xi, 8).parallel(y);
+    blur_x.compute_at(blur, x).vectorize(x, 8);
+    rgba.compute_at(blur, x).vectorize(x, 8);
+
+    if (interleave) {
+        rgba.store_tuple_interleaved();
+        blur_x.store_tuple_interleaved();
+    }
+
+    blur.compile_jit();
+    blur.realize(out);
+    return benchmark([&]() { blur.realize(out); });
+}
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+
+    const int W = 1536, H = 1024;
+    Buffer<uint8_t> input(W, H, 4);
+    input.for_each_value([](uint8_t &v) { v = (uint8_t)rand(); });
+
+    Buffer<float> soa = Buffer<float>::make_interleaved(W, H, 4);
+    Buffer<float> aos = Buffer<float>::make_interleaved(W, H, 4);
+    double t_soa = test(false, soa, input);
+    double t_aos = test(true, aos, input);
+
+    printf("Separate allocations per tuple element: %f ms\n"
+           "Interleaved tuple elements:             %f ms\n",
+           t_soa * 1e3, t_aos * 1e3);
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            for (int c = 0; c < 4; c++) {
+                if (soa(x, y, c) != aos(x, y, c)) {
+                    printf("Mismatch at (%d, %d, %d): %f vs %f\n", x, y, c, soa(x, y, c), aos(x, y, c));
+                    return -1;
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,179 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+#include <cmath>
+#include <cstdio>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+// Run the reaction-diffusion filters from apps/HelloWasm through the
+// WebAssembly executor, with and without simd128 and threads, and
+// check that they all agree. The executor is an interpreter and copies
+// buffers in and out of the wasm heap on every call, so these numbers
+// are only useful relative to one another. The interpreter is
+// single-threaded, so the parallel loops of the threads variants run
+// serially: those show the cost of atomics and shared memory, not any
+// speedup from threads.
+
+const int W = 128, H = 128;
+
+Func make_update(ImageParam state, const Target &t, bool threads) {
+    Var x("x"), y("y"), c("c"), xi("xi"), yi("yi");
+    Func clamped = BoundaryConditions::repeat_edge(state);
+
+    Func blur_x("blur_x"), blur_y("blur_y"), blur("blur");
+    blur_x(x, y, c) = (clamped(x - 2, y, c) +
+                       clamped(x - 1, y, c) +
+                       clamped(x, y, c) +
+                       clamped(x + 1, y, c) +
+                       clamped(x + 2, y, c));
+    blur_y(x, y, c) = (clamped(x, y - 2, c) +
+                       clamped(x, y - 1, c) +
+                       clamped(x, y, c) +
+                       clamped(x, y + 1, c) +
+                       clamped(x, y + 2, c));
+    blur(x, y, c) = (blur_x(x, y, c) + blur_y(x, y, c)) / 10;
+
+    Expr R = blur(x, y, 0);
+    Expr G = blur(x, y, 1);
+    Expr B = blur(x, y, 2);
+
+    // Push the colors outwards with a sigmoid
+    Expr s = 0.5f;
+    R *= (1 - s) + s * R * (3 - 2 * R);
+    G *= (1 - s) + s * G * (3 - 2 * G);
+    B *= (1 - s) + s * B * (3 - 2 * B);
+
+    // Reaction
+    Expr dR = B * (1 - R - G);
+    Expr dG = (1 - B) * (R - G);
+    Expr dB = 1 - B + 2 * G * R - R - G;
+
+    R = clamp(R + dR * 0.14f, 0.0f, 1.0f);
+    G = clamp(G + dG * 0.05f, 0.0f, 1.0f);
+    B = clamp(B + dB * 0.065f, 0.0f, 1.0f);
+
+    Func new_state("new_state");
+    new_state(x, y, c) = mux(c, {R, G, B});
+
+    const int vec = t.natural_vector_size<float>();
+    state.dim(2).set_bounds(0, 3);
+    new_state
+        .reorder(c, x, y)
+        .bound(c, 0, 3)
+        .unroll(c)
+        .tile(x, y, xi, yi, 64, 8)
+        .vectorize(xi, vec);
+    blur.compute_at(new_state, xi).vectorize(x);
+    clamped.store_at(new_state, x).compute_at(new_state, yi);
+    if (threads) {
+        new_state.parallel(y);
+    }
+    return new_state;
+}
+
+Func make_render(ImageParam state, const Target &t, bool threads) {
+    Var x("x"), y("y"), c("c");
+    Func contour("contour");
+    Expr v = state(x, y, c) * (1.01f - state(x, y, c)) * 4;
+    v *= v;
+    v *= v;
+    contour(x, y, c) = min(v, 1.0f);
+
+    Expr c0 = contour(x, y, 0);
+    Expr c1 = contour(x, y, 1);
+    Expr c2 = contour(x, y, 2);
+
+    Expr R = cast<uint32_t>(min(c0, (c1 + c2) / 2) * 255) & 0xff;
+    Expr G = cast<uint32_t>(clamp((c1 + c0 + c2) / 2, 0.0f, 1.0f) * 255) & 0xff;
+    Expr B = cast<uint32_t>(max(c0, max(c1, c2)) * 255) & 0xff;
+
+    Func render("render");
+    render(x, y) = B | (G << 8) | (R << 16) | (cast<uint32_t>(255) << 24);
+    render.vectorize(x, t.natural_vector_size<float>());
+    if (threads) {
+        render.parallel(y, 4);
+    }
+    return render;
+}
+
+int main(int argc, char **argv) {
+    const Target base("wasm-32-wasmrt");
+    if (!Internal::WasmModule::can_jit_target(base)) {
+        printf("[SKIP] WebAssembly JIT not enabled.\n");
+        return 0;
+    }
+
+    Buffer<float> input(W, H, 3);
+    input.for_each_element([&](int x, int y, int c) {
+        input(x, y, c) = ((x * 7 + y * 13 + c * 29) % 101) / 100.0f;
+    });
+
+    struct Config {
+        const char *name;
+        Target target;
+        bool threads;
+    };
+    const Config configs[] = {
+        {"wasm", base, false},
+        {"wasm_simd128", base.with_feature(Target::WasmSimd128), false},
+        {"wasm_threads", base.with_feature(Target::WasmThreads), true},
+        {"wasm_simd128_threads", base.with_feature(Target::WasmSimd128).with_feature(Target::WasmThreads), true},
+    };
+
+    Buffer<float> reference_state(W, H, 3);
+    Buffer<uint32_t> reference_render(W, H);
+    bool first = true;
+    for (const Config &config : configs) {
+        ImageParam state(Float(32), 3, "state");
+        state.set(input);
+
+        Func update = make_update(state, config.target, config.threads);
+        Func render = make_render(state, config.target, config.threads);
+        update.compile_jit(config.target);
+        render.compile_jit(config.target);
+
+        Buffer<float> new_state(W, H, 3);
+        Buffer<uint32_t> rendered(W, H);
+        double t_update = benchmark(3, 1, [&]() { update.realize(new_state, config.target); });
+        double t_render = benchmark(3, 1, [&]() { render.realize(rendered, config.target); });
+
+        if (first) {
+            reference_state.copy_from(new_state);
+            reference_render.copy_from(rendered);
+            first = false;
+        } else {
+            for (int c = 0; c < 3; c++) {
+                for (int y = 0; y < H; y++) {
+                    for (int x = 0; x < W; x++) {
+                        if (std::abs(new_state(x, y, c) - reference_state(x, y, c)) > 1e-5f) {
+                            printf("%s: new_state(%d, %d, %d) = %f instead of %f\n",
+                                   config.name, x, y, c, new_state(x, y, c), reference_state(x, y, c));
+                            return -1;
+                        }
+                    }
+                }
+            }
+            for (int y = 0; y < H; y++) {
+                for (int x = 0; x < W; x++) {
+                    // Allow the rounding of each channel to differ by one.
+                    uint32_t a = rendered(x, y), b = reference_render(x, y);
+                    for (int shift = 0; shift < 32; shift += 8) {
+                        int da = (a >> shift) & 0xff, db = (b >> shift) & 0xff;
+                        if (std::abs(da - db) > 1) {
+                            printf("%s: render(%d, %d) = %08x instead of %08x\n",
+                                   config.name, x, y, a, b);
+                            return -1;
+                        }
+                    }
+                }
+            }
+        }
+
+        printf("%-22s update: %10.3f ms  render: %10.3f ms\n",
+               config.name, t_update * 1e3, t_render * 1e3);
+    }
+
+    printf("Success!\n");
+    return 0;
+}